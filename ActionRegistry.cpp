@@ -0,0 +1,39 @@
+#include "ActionRegistry.h"
+
+#include "HotkeyManager.h"
+
+std::vector<ActionRegistry::Action> ActionRegistry::actions_;
+constexpr int ActionRegistry::MAX_ACTIONS;
+
+bool ActionRegistry::registerAction(const int action, const std::string& name, const ActionHandler& handler)
+{
+	if (action < 0 || action >= MAX_ACTIONS || !handler || findAction(name) != HotkeyManager::NO_ACTION) return false;
+
+	if ((size_t)action >= actions_.size()) {
+		actions_.resize(action + 1);
+	}
+	else if (actions_[action].handler) {
+		return false;
+	}
+
+	actions_[action] = { name, handler };
+	return true;
+}
+
+int ActionRegistry::findAction(const std::string& name)
+{
+	for (size_t i = 0; i < actions_.size(); i++) {
+		if (actions_[i].handler && actions_[i].name == name) return (int)i;
+	}
+
+	return HotkeyManager::NO_ACTION;
+}
+
+bool ActionRegistry::execute(const int action, const uint32_t time)
+{
+	// One bounds check and one indirect call, whatever the number of actions
+	if ((unsigned)action >= (unsigned)actions_.size() || !actions_[action].handler) return false;
+
+	actions_[action].handler(time);
+	return true;
+}
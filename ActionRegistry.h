@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Runs an action, with the AppClock time of the input that triggered it
+typedef std::function<void(uint32_t time)> ActionHandler;
+
+// Every action a hotkey can trigger, by the KEY_ id the hotkey tables hold and the name the bindings in the settings use.
+// Actions are registered on the main window's thread before any hotkey is bound, and only ever run there.
+class ActionRegistry
+{
+private:
+	struct Action
+	{
+		std::string name;
+		ActionHandler handler;
+	};
+
+	static std::vector<Action> actions_; // indexed by id, ids nobody registered have no handler
+
+public:
+	static constexpr int MAX_ACTIONS = 127; // hotkey tables hold the ids as signed chars
+
+	/**
+	@brief Register an action under a fixed id.
+
+	@param action The KEY_ id of the action.
+
+	@param name The name bindings refer to the action by.
+
+	@param handler The method to run when a hotkey of the action is hit.
+
+	@return Wether the action was registered, false if the id or the name is taken or the id is out of range.
+	*/
+	static bool registerAction(int action, const std::string& name, const ActionHandler& handler);
+
+	/**
+	@param name The name of an action.
+
+	@return The id of the action, or HotkeyManager::NO_ACTION if no action has that name.
+	*/
+	static int findAction(const std::string& name);
+
+	/**
+	@brief Run an action. Should only be called from the main window's thread.
+
+	@param action The KEY_ id of the action.
+
+	@param time The AppClock time of the input that triggered it.
+
+	@return Wether the action is registered.
+	*/
+	static bool execute(int action, uint32_t time);
+};
@@ -0,0 +1,29 @@
+#include "AppClock.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <chrono>
+#endif
+
+std::atomic<bool> AppClock::isVirtual_(false);
+std::atomic<uint32_t> AppClock::virtualTime_(0);
+
+uint32_t AppClock::now()
+{
+	if (isVirtual_.load(std::memory_order_relaxed)) {
+		return virtualTime_.load(std::memory_order_relaxed);
+	}
+
+#ifdef _WIN32
+	return (uint32_t)GetTickCount();
+#else
+	return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void AppClock::setVirtualTime(const uint32_t time)
+{
+	virtualTime_.store(time, std::memory_order_relaxed);
+	isVirtual_.store(true, std::memory_order_relaxed);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// The milliseconds the timers and input time stamps are measured in.
+// Follows the system tick count, which the Windows hooks stamp their input with, unless a replay drives it.
+class AppClock
+{
+private:
+	static std::atomic<bool> isVirtual_;
+	static std::atomic<uint32_t> virtualTime_;
+
+public:
+	/**
+	@return The current time in milliseconds. Wraps around after about 49 days, compare times by subtracting them.
+	*/
+	static uint32_t now();
+
+	/**
+	@brief Stop following the system and report the given time from now on. Used to replay recordings deterministically.
+
+	@param time The time to report.
+	*/
+	static void setVirtualTime(uint32_t time);
+};
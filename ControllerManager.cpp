@@ -5,9 +5,17 @@ ControllerManager::ControllerManager()
 	isRunning_ = false;
 }
 
-void ControllerManager::setInputCallback(const std::function<void(WORD)>& callback)
+ControllerManager::~ControllerManager()
 {
-	inputCallback_ = callback;
+	stop();
+}
+
+void ControllerManager::report(const WORD button) const
+{
+	if (button == 0) return;
+
+	// Only presses are reported, releases aren't bound to anything
+	inputCallback_({ button, true, (uint32_t)GetTickCount() });
 }
 
 void ControllerManager::poll()
@@ -26,26 +34,26 @@ void ControllerManager::poll()
 
 		if (buttonsChanged)
 		{
-			WORD buttons = buttonsMap[state_.Gamepad.wButtons];
+			const auto it = buttonsMap.find(state_.Gamepad.wButtons);
 
- 			inputCallback_(buttons);
+			report(it != buttonsMap.end() ? it->second : 0);
 		}
 		else if (leftTriggerDown)
 		{
-			inputCallback_(ControllerButtons::LeftTrigger);
+			report(ControllerButtons::LeftTrigger);
 		}
 		else if (rightTriggerDown)
 		{
-			inputCallback_(ControllerButtons::RightTrigger);
+			report(ControllerButtons::RightTrigger);
 		}
 
 		previousState_ = state_;
 	}
 }
 
-void ControllerManager::start()
+bool ControllerManager::start()
 {
-	if (isRunning_) return;
+	if (isRunning_) return true;
 
 	isRunning_ = true;
 
@@ -57,6 +65,8 @@ void ControllerManager::start()
 			Sleep(1);
 		}
 	});
+
+	return true;
 }
 
 void ControllerManager::stop()
@@ -1,8 +1,8 @@
 #pragma once
 
 #include "BaseWindow.h"
+#include "InputBackend.h"
 #include <atomic>
-#include <functional>
 #include <map>
 #include <thread>
 #include <Xinput.h>
@@ -27,7 +27,8 @@ enum ControllerButtons : USHORT
 	RightTrigger = CONTROLLER_RIGHT_TRIGGER
 };
 
-class ControllerManager
+// Polls the first XInput controller and reports the buttons that get pressed
+class ControllerManager : public InputBackend
 {
 public:
 	std::map<USHORT, USHORT> buttonsMap = {
@@ -60,29 +61,25 @@ public:
 private:
 	XINPUT_STATE state_ = {};
 	XINPUT_STATE previousState_ = {};
-	std::function<void(WORD)> inputCallback_;
 	std::atomic<bool> isRunning_;
 	std::thread pollingThread_;
 
 public:
 	ControllerManager();
 
-	/**
-	 * @brief Set a callback method to be called for input events.
-	 * 
-	 * @param callback The method to be called.
-	 */
-	void setInputCallback(const std::function<void(WORD)>& callback);
+	~ControllerManager() override;
 
 	/**
 	 * @brief Start listening for controller input.
+	 * 
+	 * @return Always true, a controller that isn't connected yet is picked up once it is.
 	 */
-	void start();
+	bool start() override;
 
 	/**
 	 * @brief Stop listening for controller input.
 	 */
-	void stop();
+	void stop() override;
 
 	void initializeButtonsMap();
 
@@ -91,4 +88,11 @@ private:
 	 * @brief Retreive controller input data.
 	 */
 	void poll();
+
+	/**
+	 * @brief Report a pressed button to the input callback.
+	 * 
+	 * @param button The CONTROLLER_ button, or 0 for combinations that aren't mapped to one.
+	 */
+	void report(WORD button) const;
 };
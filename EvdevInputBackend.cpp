@@ -0,0 +1,317 @@
+#include "EvdevInputBackend.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "AppClock.h"
+#include "InputCodes.h"
+
+namespace
+{
+	// Evdev codes to the codes hotkeys are bound with, 0 for the ones we don't bind.
+	// Keys use the Windows virtual key values, Windows.h isn't available here.
+	struct CodeMap
+	{
+		unsigned short codes[KEY_CNT];
+	};
+
+	CodeMap makeCodeMap()
+	{
+		CodeMap map = {};
+
+		const char letters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+		const unsigned short letterKeys[] = {
+			KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I, KEY_J, KEY_K, KEY_L, KEY_M,
+			KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S, KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z
+		};
+		for (int i = 0; i < 26; i++) {
+			map.codes[letterKeys[i]] = (unsigned short)letters[i];
+		}
+
+		// KEY_1 to KEY_9 are in order, followed by KEY_0
+		for (int i = 0; i < 9; i++) {
+			map.codes[KEY_1 + i] = (unsigned short)('1' + i);
+		}
+		map.codes[KEY_0] = '0';
+
+		// KEY_F1 to KEY_F10 are in order, the rest of the function keys aren't next to them
+		for (int i = 0; i < 10; i++) {
+			map.codes[KEY_F1 + i] = (unsigned short)(0x70 + i); // VK_F1
+		}
+		map.codes[KEY_F11] = 0x7A;
+		map.codes[KEY_F12] = 0x7B;
+		for (int i = 0; i < 12; i++) {
+			map.codes[KEY_F13 + i] = (unsigned short)(0x7C + i); // VK_F13
+		}
+
+		const unsigned short keypadKeys[] = {
+			KEY_KP0, KEY_KP1, KEY_KP2, KEY_KP3, KEY_KP4, KEY_KP5, KEY_KP6, KEY_KP7, KEY_KP8, KEY_KP9
+		};
+		for (int i = 0; i < 10; i++) {
+			map.codes[keypadKeys[i]] = (unsigned short)(0x60 + i); // VK_NUMPAD0
+		}
+
+		const unsigned short pairs[][2] = {
+			{ KEY_BACKSPACE, 0x08 }, // VK_BACK
+			{ KEY_TAB, 0x09 }, // VK_TAB
+			{ KEY_ENTER, 0x0D }, // VK_RETURN
+			{ KEY_KPENTER, 0x0D },
+			{ KEY_PAUSE, 0x13 }, // VK_PAUSE
+			{ KEY_CAPSLOCK, 0x14 }, // VK_CAPITAL
+			{ KEY_ESC, 0x1B }, // VK_ESCAPE
+			{ KEY_SPACE, 0x20 }, // VK_SPACE
+			{ KEY_PAGEUP, 0x21 }, // VK_PRIOR
+			{ KEY_PAGEDOWN, 0x22 }, // VK_NEXT
+			{ KEY_END, 0x23 }, // VK_END
+			{ KEY_HOME, 0x24 }, // VK_HOME
+			{ KEY_LEFT, 0x25 }, // VK_LEFT
+			{ KEY_UP, 0x26 }, // VK_UP
+			{ KEY_RIGHT, 0x27 }, // VK_RIGHT
+			{ KEY_DOWN, 0x28 }, // VK_DOWN
+			{ KEY_SYSRQ, 0x2C }, // VK_SNAPSHOT
+			{ KEY_INSERT, 0x2D }, // VK_INSERT
+			{ KEY_DELETE, 0x2E }, // VK_DELETE
+			{ KEY_LEFTMETA, 0x5B }, // VK_LWIN
+			{ KEY_RIGHTMETA, 0x5C }, // VK_RWIN
+			{ KEY_COMPOSE, 0x5D }, // VK_APPS
+			{ KEY_KPASTERISK, 0x6A }, // VK_MULTIPLY
+			{ KEY_KPPLUS, 0x6B }, // VK_ADD
+			{ KEY_KPMINUS, 0x6D }, // VK_SUBTRACT
+			{ KEY_KPDOT, 0x6E }, // VK_DECIMAL
+			{ KEY_KPSLASH, 0x6F }, // VK_DIVIDE
+			{ KEY_NUMLOCK, 0x90 }, // VK_NUMLOCK
+			{ KEY_SCROLLLOCK, 0x91 }, // VK_SCROLL
+			{ KEY_LEFTSHIFT, 0xA0 }, // VK_LSHIFT
+			{ KEY_RIGHTSHIFT, 0xA1 }, // VK_RSHIFT
+			{ KEY_LEFTCTRL, 0xA2 }, // VK_LCONTROL
+			{ KEY_RIGHTCTRL, 0xA3 }, // VK_RCONTROL
+			{ KEY_LEFTALT, 0xA4 }, // VK_LMENU
+			{ KEY_RIGHTALT, 0xA5 }, // VK_RMENU
+			{ KEY_SEMICOLON, 0xBA }, // VK_OEM_1
+			{ KEY_EQUAL, 0xBB }, // VK_OEM_PLUS
+			{ KEY_COMMA, 0xBC }, // VK_OEM_COMMA
+			{ KEY_MINUS, 0xBD }, // VK_OEM_MINUS
+			{ KEY_DOT, 0xBE }, // VK_OEM_PERIOD
+			{ KEY_SLASH, 0xBF }, // VK_OEM_2
+			{ KEY_GRAVE, 0xC0 }, // VK_OEM_3
+			{ KEY_LEFTBRACE, 0xDB }, // VK_OEM_4
+			{ KEY_BACKSLASH, 0xDC }, // VK_OEM_5
+			{ KEY_RIGHTBRACE, 0xDD }, // VK_OEM_6
+			{ KEY_APOSTROPHE, 0xDE }, // VK_OEM_7
+
+			{ BTN_LEFT, 0x01 }, // VK_LBUTTON
+			{ BTN_RIGHT, 0x02 }, // VK_RBUTTON
+			{ BTN_MIDDLE, 0x04 }, // VK_MBUTTON
+			{ BTN_SIDE, 0x05 }, // VK_XBUTTON1
+			{ BTN_EXTRA, 0x06 }, // VK_XBUTTON2
+
+			// Gamepads, named by their position like XInput does
+			{ BTN_SOUTH, CONTROLLER_A },
+			{ BTN_EAST, CONTROLLER_B },
+			{ BTN_WEST, CONTROLLER_X },
+			{ BTN_NORTH, CONTROLLER_Y },
+			{ BTN_TL, CONTROLLER_LEFT_SHOULDER },
+			{ BTN_TR, CONTROLLER_RIGHT_SHOULDER },
+			{ BTN_TL2, CONTROLLER_LEFT_TRIGGER },
+			{ BTN_TR2, CONTROLLER_RIGHT_TRIGGER },
+			{ BTN_SELECT, CONTROLLER_BACK },
+			{ BTN_START, CONTROLLER_START },
+			{ BTN_THUMBL, CONTROLLER_LEFT_THUMB },
+			{ BTN_THUMBR, CONTROLLER_RIGHT_THUMB },
+			{ BTN_DPAD_UP, CONTROLLER_UP },
+			{ BTN_DPAD_DOWN, CONTROLLER_DOWN },
+			{ BTN_DPAD_LEFT, CONTROLLER_LEFT },
+			{ BTN_DPAD_RIGHT, CONTROLLER_RIGHT },
+		};
+		for (const auto& pair : pairs) {
+			map.codes[pair[0]] = pair[1];
+		}
+
+		return map;
+	}
+
+	const CodeMap codeMap = makeCodeMap();
+
+	bool hasBit(const unsigned long* bits, const int bit)
+	{
+		constexpr int bitsPerLong = sizeof(unsigned long) * 8;
+		return (bits[bit / bitsPerLong] >> (bit % bitsPerLong)) & 1;
+	}
+}
+
+EvdevInputBackend::EvdevInputBackend()
+{
+	isRunning_ = false;
+}
+
+EvdevInputBackend::~EvdevInputBackend()
+{
+	stop();
+}
+
+bool EvdevInputBackend::start()
+{
+	if (isRunning_) return true;
+
+	epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+	if (epollFd_ < 0) return false;
+
+	DIR* pDirectory = opendir("/dev/input");
+	if (pDirectory == nullptr)
+	{
+		closeDevices();
+		return false;
+	}
+
+	while (const dirent* pEntry = readdir(pDirectory))
+	{
+		if (strncmp(pEntry->d_name, "event", 5) != 0) continue;
+
+		const std::string path = std::string("/dev/input/") + pEntry->d_name;
+		const int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (fd < 0) continue;
+
+		// Skip devices without keys or buttons, like accelerometers
+		unsigned long eventTypes[EV_CNT / (sizeof(unsigned long) * 8) + 1] = {};
+		if (ioctl(fd, EVIOCGBIT(0, sizeof(eventTypes)), eventTypes) < 0 || !hasBit(eventTypes, EV_KEY))
+		{
+			close(fd);
+			continue;
+		}
+
+		// Events are stamped with the wall clock by default, the timers count in AppClock's monotonic milliseconds.
+		// Kernels too old to switch get their events stamped when they're read instead.
+		int clockId = CLOCK_MONOTONIC;
+		const bool isMonotonic = ioctl(fd, EVIOCSCLOCKID, &clockId) == 0;
+
+		devices_.push_back({ fd, isMonotonic, 0, 0 });
+	}
+
+	closedir(pDirectory);
+
+	// Registered once the list is complete, since the events point into it
+	for (Device& device : devices_)
+	{
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.ptr = &device;
+		epoll_ctl(epollFd_, EPOLL_CTL_ADD, device.fd, &event);
+	}
+
+	if (devices_.empty())
+	{
+		closeDevices();
+		return false;
+	}
+
+	isRunning_ = true;
+	readerThread_ = std::thread([this]() { read(); });
+	return true;
+}
+
+void EvdevInputBackend::stop()
+{
+	if (isRunning_)
+	{
+		isRunning_ = false;
+
+		if (readerThread_.joinable())
+		{
+			readerThread_.join();
+		}
+	}
+
+	closeDevices();
+}
+
+void EvdevInputBackend::closeDevices()
+{
+	for (const Device& device : devices_) {
+		close(device.fd);
+	}
+	devices_.clear();
+
+	if (epollFd_ >= 0) close(epollFd_);
+	epollFd_ = -1;
+}
+
+void EvdevInputBackend::read()
+{
+	epoll_event readyEvents[16];
+	input_event events[64];
+
+	while (isRunning_)
+	{
+		// Wake up regularly to notice stop() being called
+		const int readyCount = epoll_wait(epollFd_, readyEvents, 16, 100);
+
+		for (int i = 0; i < readyCount; i++)
+		{
+			Device& device = *static_cast<Device*>(readyEvents[i].data.ptr);
+			ssize_t length;
+
+			while ((length = ::read(device.fd, events, sizeof(events))) > 0)
+			{
+				for (size_t j = 0; j < (size_t)length / sizeof(input_event); j++) {
+					handleEvent(device, events[j]);
+				}
+			}
+
+			// An unplugged device keeps reporting errors, stop waiting on it
+			if (length < 0 && errno != EAGAIN && errno != EINTR) {
+				epoll_ctl(epollFd_, EPOLL_CTL_DEL, device.fd, nullptr);
+			}
+		}
+	}
+}
+
+void EvdevInputBackend::handleEvent(Device& device, const input_event& event) const
+{
+	// In AppClock milliseconds either way, it follows CLOCK_MONOTONIC on Linux
+	const uint32_t time = device.isMonotonic
+		? (uint32_t)(event.input_event_sec * 1000 + event.input_event_usec / 1000)
+		: AppClock::now();
+
+	if (event.type == EV_KEY && event.code < KEY_CNT)
+	{
+		const int code = codeMap.codes[event.code];
+
+		// 2 is an auto-repeat, which the hotkeys ignore anyway
+		if (code != 0 && event.value != 2) {
+			inputCallback_({ code, event.value == 1, time });
+		}
+	}
+	else if (event.type == EV_ABS && event.code == ABS_HAT0X)
+	{
+		handleHat(device.hatX, event.value, CONTROLLER_LEFT, CONTROLLER_RIGHT, time);
+	}
+	else if (event.type == EV_ABS && event.code == ABS_HAT0Y)
+	{
+		handleHat(device.hatY, event.value, CONTROLLER_UP, CONTROLLER_DOWN, time);
+	}
+}
+
+void EvdevInputBackend::handleHat(int& position, const int newPosition, const int negativeButton, const int positiveButton, const uint32_t time) const
+{
+	const int clamped = newPosition < 0 ? -1 : (newPosition > 0 ? 1 : 0);
+	if (clamped == position) return;
+
+	if (position != 0) {
+		inputCallback_({ position < 0 ? negativeButton : positiveButton, false, time });
+	}
+
+	if (clamped != 0) {
+		inputCallback_({ clamped < 0 ? negativeButton : positiveButton, true, time });
+	}
+
+	position = clamped;
+}
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+#ifdef __linux__
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <linux/input.h>
+
+#include "InputBackend.h"
+
+// Captures keyboards, mice and gamepads on Linux by reading /dev/input/event* with epoll.
+// Needs read access to the devices, usually by being in the input group.
+// Devices plugged in after start() aren't picked up.
+class EvdevInputBackend : public InputBackend
+{
+private:
+	struct Device
+	{
+		int fd;
+		bool isMonotonic; // wether the device stamps it's events with CLOCK_MONOTONIC, which AppClock follows
+		int hatX; // last D-pad position of gamepads that report it as an axis, -1, 0 or 1
+		int hatY;
+	};
+
+	std::vector<Device> devices_;
+	int epollFd_ = -1;
+	std::atomic<bool> isRunning_;
+	std::thread readerThread_;
+
+	/**
+	@brief The reader thread's loop. Waits for events on any device and reports them.
+	*/
+	void read();
+
+	/**
+	@brief Translate a single evdev event and report it if it's a key or button change.
+
+	@param device The device the event came from.
+
+	@param event The event to translate.
+	*/
+	void handleEvent(Device& device, const input_event& event) const;
+
+	/**
+	@brief Report a D-pad axis moving, which releases the button of the old position and presses the one of the new.
+
+	@param position The last position of the axis, updated to the new one.
+	*/
+	void handleHat(int& position, int newPosition, int negativeButton, int positiveButton, uint32_t time) const;
+
+	/**
+	@brief Close every device.
+	*/
+	void closeDevices();
+
+public:
+	EvdevInputBackend();
+
+	~EvdevInputBackend() override;
+
+	/**
+	@brief Open every readable input device that has keys or buttons and start reading them.
+
+	@return Wether at least one device could be opened.
+	*/
+	bool start() override;
+
+	void stop() override;
+};
+#endif
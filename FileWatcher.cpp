@@ -0,0 +1,181 @@
+#include "FileWatcher.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+constexpr std::chrono::milliseconds FileWatcher::settleDelay;
+
+FileWatcher::FileWatcher()
+{
+	isRunning_ = false;
+}
+
+FileWatcher::~FileWatcher()
+{
+	stop();
+}
+
+void FileWatcher::setChangeCallback(const std::function<void()>& callback)
+{
+	changeCallback_ = callback;
+}
+
+void FileWatcher::start(const std::string& fileName)
+{
+	if (isRunning_) return;
+
+	fileName_ = fileName;
+	isRunning_ = true;
+
+#ifdef _WIN32
+	hStopEvent_ = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+#endif
+
+	watcherThread_ = std::thread([this]() { watch(); });
+}
+
+void FileWatcher::stop()
+{
+	if (!isRunning_) return;
+
+	isRunning_ = false;
+
+#ifdef _WIN32
+	SetEvent(hStopEvent_);
+#endif
+
+	if (watcherThread_.joinable())
+	{
+		watcherThread_.join();
+	}
+
+#ifdef _WIN32
+	CloseHandle(hStopEvent_);
+	hStopEvent_ = nullptr;
+#endif
+}
+
+#ifdef _WIN32
+void FileWatcher::watch()
+{
+	const HANDLE hDirectory = CreateFileW(
+		L".", FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr
+	);
+
+	if (hDirectory == INVALID_HANDLE_VALUE) return;
+
+	OVERLAPPED overlapped = {};
+	overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+	const HANDLE handles[2] = { hStopEvent_, overlapped.hEvent };
+
+	// File names are ASCII, so widening them char by char is enough
+	const std::wstring wideFileName(fileName_.begin(), fileName_.end());
+	alignas(DWORD) BYTE buffer[4096];
+
+	while (isRunning_)
+	{
+		// Renames are watched too, since files are often replaced by renaming a temp file over them
+		if (!ReadDirectoryChangesW(hDirectory, buffer, sizeof(buffer), FALSE,
+			FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE,
+			nullptr, &overlapped, nullptr))
+		{
+			break;
+		}
+
+		DWORD bytes = 0;
+		if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+		{
+			// Stopped, cancel the pending read before the buffer goes out of scope
+			CancelIoEx(hDirectory, &overlapped);
+			GetOverlappedResult(hDirectory, &overlapped, &bytes, TRUE);
+			break;
+		}
+
+		if (!GetOverlappedResult(hDirectory, &overlapped, &bytes, FALSE)) break;
+		ResetEvent(overlapped.hEvent);
+
+		// No bytes means the notifications overflowed the buffer, the file may have changed
+		bool isFileChanged = bytes == 0;
+
+		for (DWORD offset = 0; bytes != 0 && !isFileChanged;)
+		{
+			const FILE_NOTIFY_INFORMATION* pInfo = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+			const size_t nameLength = pInfo->FileNameLength / sizeof(WCHAR);
+
+			isFileChanged =
+				(pInfo->Action == FILE_ACTION_ADDED || pInfo->Action == FILE_ACTION_MODIFIED || pInfo->Action == FILE_ACTION_RENAMED_NEW_NAME) &&
+				nameLength == wideFileName.size() &&
+				_wcsnicmp(pInfo->FileName, wideFileName.c_str(), nameLength) == 0;
+
+			if (pInfo->NextEntryOffset == 0) break;
+			offset += pInfo->NextEntryOffset;
+		}
+
+		// Let the writer finish, changes made meanwhile are queued for the next read
+		if (isFileChanged && WaitForSingleObject(hStopEvent_, (DWORD)settleDelay.count()) == WAIT_TIMEOUT)
+		{
+			changeCallback_();
+		}
+	}
+
+	CloseHandle(overlapped.hEvent);
+	CloseHandle(hDirectory);
+}
+#else
+void FileWatcher::watch()
+{
+	const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) return;
+
+	// Renames are watched too, since files are often replaced by renaming a temp file over them
+	if (inotify_add_watch(fd, ".", IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+	{
+		close(fd);
+		return;
+	}
+
+	alignas(inotify_event) char buffer[4096];
+
+	while (isRunning_)
+	{
+		pollfd pollFd = { fd, POLLIN, 0 };
+
+		// Wake up regularly to notice stop() being called
+		if (poll(&pollFd, 1, 100) <= 0) continue;
+
+		bool isFileChanged = false;
+		ssize_t length;
+
+		while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+		{
+			for (char* pEvent = buffer; pEvent < buffer + length;)
+			{
+				const inotify_event* pInfo = reinterpret_cast<const inotify_event*>(pEvent);
+
+				isFileChanged = isFileChanged || (pInfo->len != 0 && fileName_ == pInfo->name);
+				pEvent += sizeof(inotify_event) + pInfo->len;
+			}
+		}
+
+		if (isFileChanged)
+		{
+			// Let the writer finish, changes made meanwhile are read on the next iteration
+			std::this_thread::sleep_for(settleDelay);
+
+			if (isRunning_)
+			{
+				changeCallback_();
+			}
+		}
+	}
+
+	close(fd);
+}
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Watches a single file in the working directory for changes made by any process.
+// Uses directory change notifications on Windows and inotify on Linux.
+class FileWatcher
+{
+private:
+	std::string fileName_;
+	std::function<void()> changeCallback_;
+	std::atomic<bool> isRunning_;
+	std::thread watcherThread_;
+#ifdef _WIN32
+	void* hStopEvent_ = nullptr;
+#endif
+
+	/**
+	@brief The watcher thread's loop. Waits for changes to the file and calls the change callback.
+	*/
+	void watch();
+
+public:
+	// Time to let a burst of writes settle before the change callback is called
+	static constexpr std::chrono::milliseconds settleDelay{ 50 };
+
+	FileWatcher();
+
+	// Prevent copying of the watcher thread
+
+	FileWatcher(const FileWatcher& other) = delete;
+
+	FileWatcher& operator=(const FileWatcher& other) = delete;
+
+	~FileWatcher();
+
+	/**
+	@brief Set a callback method to be called when the file changes. It's called from the watcher thread.
+
+	@param callback The method to be called.
+	*/
+	void setChangeCallback(const std::function<void()>& callback);
+
+	/**
+	@brief Start watching a file.
+
+	@param fileName The name of the file to watch, relative to the working directory.
+	*/
+	void start(const std::string& fileName);
+
+	/**
+	@brief Stop watching the file.
+	*/
+	void stop();
+};
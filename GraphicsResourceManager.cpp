@@ -0,0 +1,210 @@
+#include "GraphicsResourceManager.h"
+#include "ResourceUtils.h"
+
+GraphicsResourceManager::~GraphicsResourceManager()
+{
+	discardAllResources();
+}
+
+HRESULT GraphicsResourceManager::createTextFormat()
+{
+	safeRelease(&pTextFormat_);
+
+	static constexpr WCHAR fontName[] = L"Sitka";
+
+	HRESULT hr = pWriteFactory_->CreateTextFormat(
+		fontName,
+		nullptr,
+		DWRITE_FONT_WEIGHT_BOLD,
+		DWRITE_FONT_STYLE_NORMAL,
+		DWRITE_FONT_STRETCH_EXTRA_EXPANDED,
+		fontSize_,
+		L"",
+		&pTextFormat_
+	);
+
+	if (SUCCEEDED(hr))
+	{
+		// Center the text horizontally and vertically.
+		hr = pTextFormat_->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
+
+		if (SUCCEEDED(hr))
+		{
+			hr = pTextFormat_->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_FAR);
+		}
+	}
+
+	return hr;
+}
+
+HRESULT GraphicsResourceManager::createBrushes()
+{
+	// timer color brush
+	HRESULT hr = pRenderTarget_->CreateSolidColorBrush(hBrushToColorf(hBrushes[colors_.timerColor]), &pBrushTimer_);
+
+	// selected timer color brush
+	if (SUCCEEDED(hr)) {
+		hr = pRenderTarget_->CreateSolidColorBrush(hBrushToColorf(hBrushes[colors_.selectedTimerColor]), &pBrushSelectedTimer_);
+	}
+
+	// last seconds color brush
+	if (SUCCEEDED(hr)) {
+		hr = pRenderTarget_->CreateSolidColorBrush(hBrushToColorf(hBrushes[colors_.lastSecondsColor]), &pBrushLastSeconds_);
+	}
+
+	backgroundColor_ = hBrushToColorf(hBrushes[colors_.backgroundColor]);
+
+	return hr;
+}
+
+D2D1_COLOR_F GraphicsResourceManager::hBrushToColorf(const HBRUSH hBrush)
+{
+	LOGBRUSH logBrush;
+
+	GetObject(hBrush, sizeof(LOGBRUSH), &logBrush);
+	const COLORREF color = logBrush.lbColor; // Extract COLORREF
+	return D2D1::ColorF(GetRValue(color) / 255.0f, GetGValue(color) / 255.0f, GetBValue(color) / 255.0f);
+}
+
+HRESULT GraphicsResourceManager::createDeviceIndependentResources(const HWND hwnd, const ColorsStruct& colors)
+{
+	HRESULT hr = S_OK;
+
+	hwnd_ = hwnd;
+	colors_ = colors;
+
+	if (pFactory_ == nullptr) {
+		hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_MULTI_THREADED, &pFactory_);
+	}
+
+	if (SUCCEEDED(hr) && pWriteFactory_ == nullptr) {
+		hr = DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(pWriteFactory_),
+			reinterpret_cast<IUnknown**>(&pWriteFactory_));
+	}
+
+	if (SUCCEEDED(hr) && pTextFormat_ == nullptr) {
+		hr = createTextFormat();
+	}
+
+	return hr;
+}
+
+HRESULT GraphicsResourceManager::createDeviceResources()
+{
+	if (pRenderTarget_ != nullptr) {
+		return S_OK;
+	}
+
+	if (pFactory_ == nullptr) {
+		return E_POINTER;
+	}
+
+	RECT rc;
+	GetClientRect(hwnd_, &rc);
+
+	const D2D1_SIZE_U size = D2D1::SizeU(rc.right, rc.bottom);
+
+	const D2D1_RENDER_TARGET_PROPERTIES rtProperties = D2D1::RenderTargetProperties(
+		D2D1_RENDER_TARGET_TYPE_DEFAULT,
+		D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_IGNORE),
+		96.0f, 96.0f,
+		D2D1_RENDER_TARGET_USAGE_NONE,
+		D2D1_FEATURE_LEVEL_DEFAULT
+	);
+
+	HRESULT hr = pFactory_->CreateHwndRenderTarget(
+		rtProperties,
+		D2D1::HwndRenderTargetProperties(hwnd_, size),
+		&pRenderTarget_
+	);
+
+	if (SUCCEEDED(hr)) {
+		hr = createBrushes();
+	}
+
+	// Don't keep half created resources around, try again on the next frame
+	if (FAILED(hr)) {
+		discardDeviceResources();
+	}
+
+	return hr;
+}
+
+void GraphicsResourceManager::discardDeviceResources()
+{
+	safeRelease(&pBrushTimer_);
+	safeRelease(&pBrushSelectedTimer_);
+	safeRelease(&pBrushLastSeconds_);
+	safeRelease(&pRenderTarget_);
+}
+
+void GraphicsResourceManager::discardAllResources()
+{
+	discardDeviceResources();
+	safeRelease(&pTextFormat_);
+	safeRelease(&pWriteFactory_);
+	safeRelease(&pFactory_);
+}
+
+HRESULT GraphicsResourceManager::beginFrame()
+{
+	const HRESULT hr = createDeviceResources();
+
+	if (SUCCEEDED(hr)) {
+		pRenderTarget_->BeginDraw();
+	}
+
+	return hr;
+}
+
+HRESULT GraphicsResourceManager::endFrame()
+{
+	HRESULT hr = pRenderTarget_->EndDraw();
+
+	if (simulateDeviceLoss_) {
+		simulateDeviceLoss_ = false;
+		hr = D2DERR_RECREATE_TARGET;
+	}
+
+	if (hr == D2DERR_RECREATE_TARGET) {
+		discardDeviceResources();
+	}
+
+	return hr;
+}
+
+HRESULT GraphicsResourceManager::resize(const UINT32 width, const UINT32 height) const
+{
+	// A lost render target is created in the window's current size on the next frame
+	if (pRenderTarget_ == nullptr) {
+		return S_OK;
+	}
+
+	return pRenderTarget_->Resize(D2D1::SizeU(width, height));
+}
+
+HRESULT GraphicsResourceManager::setFontSize(const float fontSize)
+{
+	fontSize_ = fontSize;
+
+	if (pWriteFactory_ == nullptr) {
+		return S_OK;
+	}
+
+	return createTextFormat();
+}
+
+void GraphicsResourceManager::setColors(const ColorsStruct& colors)
+{
+	colors_ = colors;
+	backgroundColor_ = hBrushToColorf(hBrushes[colors_.backgroundColor]);
+
+	// Brushes that don't exist right now will be created with the cached colors
+	if (pRenderTarget_ == nullptr) {
+		return;
+	}
+
+	pBrushTimer_->SetColor(hBrushToColorf(hBrushes[colors_.timerColor]));
+	pBrushSelectedTimer_->SetColor(hBrushToColorf(hBrushes[colors_.selectedTimerColor]));
+	pBrushLastSeconds_->SetColor(hBrushToColorf(hBrushes[colors_.lastSecondsColor]));
+}
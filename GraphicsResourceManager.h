@@ -0,0 +1,147 @@
+#pragma once
+#include <d2d1.h>
+#include <dwrite.h>
+#include "Globals.h"
+
+// Owns the Direct2D and DirectWrite resources of the main window.
+// Device independent resources (factories, text format) live for the whole run,
+// device dependent resources (render target, brushes) are recreated from cached state after a device loss.
+class GraphicsResourceManager
+{
+private:
+	// Device independent resources
+	ID2D1Factory* pFactory_ = nullptr;
+	IDWriteFactory* pWriteFactory_ = nullptr;
+	IDWriteTextFormat* pTextFormat_ = nullptr;
+
+	// Device dependent resources
+	ID2D1HwndRenderTarget* pRenderTarget_ = nullptr;
+	ID2D1SolidColorBrush* pBrushTimer_ = nullptr;
+	ID2D1SolidColorBrush* pBrushSelectedTimer_ = nullptr;
+	ID2D1SolidColorBrush* pBrushLastSeconds_ = nullptr;
+	D2D1_COLOR_F backgroundColor_ = {};
+
+	// Cached state used to restore lost resources
+	HWND hwnd_ = nullptr;
+	ColorsStruct colors_;
+	float fontSize_ = 34;
+	bool simulateDeviceLoss_ = false;
+
+	/**
+	@brief Creates the text format in the cached font size.
+
+	@return HRESULT representing the success of the operation.
+	*/
+	HRESULT createTextFormat();
+
+	/**
+	@brief Creates the timer brushes from the cached colors.
+
+	@return HRESULT representing the success of the operation.
+	*/
+	HRESULT createBrushes();
+
+	/**
+	@brief Get the COLORF value of an HBRUSH type.
+
+	@param hBrush The HBRUSH to retrieve a COLORF from.
+
+	@return D2D1_COLOR_F value of the given HBRUSH.
+	*/
+	static D2D1_COLOR_F hBrushToColorf(HBRUSH hBrush);
+
+public:
+	GraphicsResourceManager() = default;
+
+	// Prevent copying of the owned COM resources
+
+	GraphicsResourceManager(const GraphicsResourceManager& other) = delete;
+
+	GraphicsResourceManager& operator=(const GraphicsResourceManager& other) = delete;
+
+	~GraphicsResourceManager();
+
+	/**
+	@brief Creates the factories and the text format. Does nothing for resources that already exist.
+
+	@param hwnd The window the device dependent resources will be bound to.
+
+	@param colors The initial colors of the timer brushes.
+
+	@return HRESULT representing the success of the operation.
+	*/
+	HRESULT createDeviceIndependentResources(HWND hwnd, const ColorsStruct& colors);
+
+	/**
+	@brief Creates the render target and brushes if they were never created or were lost.
+
+	@return HRESULT representing the success of the operation.
+	*/
+	HRESULT createDeviceResources();
+
+	/**
+	@brief Release the render target and brushes, they will be recreated on the next frame.
+	*/
+	void discardDeviceResources();
+
+	/**
+	@brief Release every resource, including the factories.
+	*/
+	void discardAllResources();
+
+	/**
+	@brief Make sure the device resources exist and begin drawing to the render target.
+
+	@return HRESULT representing the success of the operation. Nothing should be drawn on failure.
+	*/
+	HRESULT beginFrame();
+
+	/**
+	@brief End drawing to the render target. Discards the device resources if the device was lost.
+
+	@return HRESULT returned by EndDraw (or D2DERR_RECREATE_TARGET if a device loss was simulated).
+	*/
+	HRESULT endFrame();
+
+	/**
+	@brief Resize the render target to the window's new size.
+
+	@param width The new width of the window.
+
+	@param height The new height of the window.
+
+	@return HRESULT representing the success of the operation.
+	*/
+	HRESULT resize(UINT32 width, UINT32 height) const;
+
+	/**
+	@brief Set a new font size for the timers. The size is kept for later recreations.
+
+	@param fontSize The new font size.
+
+	@return HRESULT representing the success of the operation.
+	*/
+	HRESULT setFontSize(float fontSize);
+
+	/**
+	@brief Apply new colors to the timer brushes. The colors are kept for later recreations.
+
+	@param colors The colors to apply.
+	*/
+	void setColors(const ColorsStruct& colors);
+
+	/**
+	@brief Fault injection hook, makes the next endFrame() behave as if the device was lost.
+	*/
+	void simulateDeviceLoss() { simulateDeviceLoss_ = true; }
+
+	// Getters
+	ID2D1HwndRenderTarget* renderTarget() const { return pRenderTarget_; }
+	IDWriteFactory* writeFactory() const { return pWriteFactory_; }
+	IDWriteTextFormat* textFormat() const { return pTextFormat_; }
+	ID2D1SolidColorBrush* brushTimer() const { return pBrushTimer_; }
+	ID2D1SolidColorBrush* brushSelectedTimer() const { return pBrushSelectedTimer_; }
+	ID2D1SolidColorBrush* brushLastSeconds() const { return pBrushLastSeconds_; }
+	D2D1_COLOR_F backgroundColor() const { return backgroundColor_; }
+	float fontSize() const { return fontSize_; }
+};
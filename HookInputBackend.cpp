@@ -0,0 +1,106 @@
+#include "HookInputBackend.h"
+
+#include "LatencyMonitor.h"
+
+HookInputBackend* HookInputBackend::pActive_ = nullptr;
+
+HookInputBackend::~HookInputBackend()
+{
+	stop();
+}
+
+bool HookInputBackend::start()
+{
+	if (pActive_ != nullptr) return pActive_ == this;
+
+	pActive_ = this;
+	hKeyboardHook_ = SetWindowsHookEx(WH_KEYBOARD_LL, &kbHook, nullptr, NULL);
+	hMouseHook_ = SetWindowsHookEx(WH_MOUSE_LL, &mouseHook, nullptr, NULL);
+
+	if (hKeyboardHook_ == nullptr || hMouseHook_ == nullptr)
+	{
+		stop();
+		return false;
+	}
+
+	return true;
+}
+
+void HookInputBackend::stop()
+{
+	if (pActive_ != this) return;
+
+	if (hKeyboardHook_ != nullptr) UnhookWindowsHookEx(hKeyboardHook_);
+	if (hMouseHook_ != nullptr) UnhookWindowsHookEx(hMouseHook_);
+
+	hKeyboardHook_ = nullptr;
+	hMouseHook_ = nullptr;
+	pActive_ = nullptr;
+}
+
+void HookInputBackend::report(const int code, const bool isDown, const DWORD time) const
+{
+	inputCallback_({ code, isDown, (uint32_t)time });
+}
+
+LRESULT CALLBACK HookInputBackend::mouseHook(const int nCode, const WPARAM wParam, const LPARAM lParam)
+{
+	const LatencyScope latencyScope(LATENCY_MOUSE_HOOK);
+
+	if (nCode >= 0 && pActive_ != nullptr)
+	{
+		const MSLLHOOKSTRUCT* pMsHookStruct = reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
+		int key = 0;
+
+		switch (wParam)
+		{
+		case WM_LBUTTONDOWN:
+		case WM_LBUTTONUP:
+			key = VK_LBUTTON;
+			break;
+		case WM_RBUTTONDOWN:
+		case WM_RBUTTONUP:
+			key = VK_RBUTTON;
+			break;
+		case WM_MBUTTONDOWN:
+		case WM_MBUTTONUP:
+			key = VK_MBUTTON;
+			break;
+		case WM_XBUTTONDOWN:
+		case WM_XBUTTONUP:
+			key = HIWORD(pMsHookStruct->mouseData) == 1 ? VK_XBUTTON1 : VK_XBUTTON2;
+			break;
+		default:
+			break;
+		}
+
+		// Releases are reported too, so mouse buttons can be held as part of a chord
+		if (key != 0)
+		{
+			const bool isDown = wParam == WM_LBUTTONDOWN || wParam == WM_RBUTTONDOWN || wParam == WM_MBUTTONDOWN || wParam == WM_XBUTTONDOWN;
+			pActive_->report(key, isDown, pMsHookStruct->time);
+		}
+	}
+
+	return CallNextHookEx(nullptr, nCode, wParam, lParam);
+}
+
+LRESULT CALLBACK HookInputBackend::kbHook(const int nCode, const WPARAM wParam, const LPARAM lParam)
+{
+	const LatencyScope latencyScope(LATENCY_KEYBOARD_HOOK);
+
+	if (nCode >= 0 && pActive_ != nullptr)
+	{
+		const KBDLLHOOKSTRUCT* pKbdHookStruct = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+
+		// Alt and every key hit while Alt is held come in as system keys
+		if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN) {
+			pActive_->report(pKbdHookStruct->vkCode, true, pKbdHookStruct->time);
+		}
+		else if (wParam == WM_KEYUP || wParam == WM_SYSKEYUP) {
+			pActive_->report(pKbdHookStruct->vkCode, false, pKbdHookStruct->time);
+		}
+	}
+
+	return CallNextHookEx(nullptr, nCode, wParam, lParam);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Globals.h"
+#include "InputBackend.h"
+
+// Captures the keyboard and mouse of the whole system with low level hooks.
+// The hooks are called on the thread that started the backend, which has to keep pumping messages.
+// Only one instance can be started at a time.
+class HookInputBackend : public InputBackend
+{
+private:
+	static HookInputBackend* pActive_; // the started instance, the hook procedures report to it
+	HHOOK hKeyboardHook_ = nullptr;
+	HHOOK hMouseHook_ = nullptr;
+
+	/**
+	@brief Report a key or mouse button to the input callback.
+	*/
+	void report(int code, bool isDown, DWORD time) const;
+
+	/**
+	@brief The hook procedure to listen for key strokes.
+
+	@param nCode Has no effect in this function but is part of the syntax.
+
+	@param wParam Contains the state of the hit key.
+
+	@param lParam Contains the key that was hit.
+
+	@return Forwards to the next hook.
+	*/
+	static LRESULT CALLBACK kbHook(int nCode, WPARAM wParam, LPARAM lParam);
+
+	/**
+	@brief The hook procedure to listen for mouse button presses and releases.
+
+	@param nCode Has no effect in this function but is part of the syntax.
+
+	@param wParam Contains the window message that was triggered.
+
+	@param lParam A pointer to a MSLLHOOKSTRUCT structure that contains details about the message.
+
+	@return Forwards to the next hook.
+	*/
+	static LRESULT CALLBACK mouseHook(int nCode, WPARAM wParam, LPARAM lParam);
+
+public:
+	HookInputBackend() = default;
+
+	~HookInputBackend() override;
+
+	bool start() override;
+
+	void stop() override;
+};
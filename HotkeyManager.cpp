@@ -1,39 +1,351 @@
+#include <algorithm>
+#include <iterator>
 #include "Globals.h"
 #include "HotkeyManager.h"
 
-#include "Program.h"
+#include "ActionRegistry.h"
+#include "InputQueue.h"
+#include "LatencyMonitor.h"
 
-std::unordered_map<int, int> HotkeyManager::hotkeysMap;
+namespace
+{
+	HotkeyTable makeEmptyTable()
+	{
+		HotkeyTable table;
+		std::fill(std::begin(table.keys), std::end(table.keys), (signed char)HotkeyManager::NO_ACTION);
+		std::fill(std::begin(table.controllerButtons), std::end(table.controllerButtons), (signed char)HotkeyManager::NO_ACTION);
+		std::fill(&table.actionLists[0][0], &table.actionLists[0][0] + sizeof(table.actionLists), (signed char)HotkeyManager::NO_ACTION);
+		table.debounceTime = 0;
+		return table;
+	}
+
+	const HotkeyTable emptyTable = makeEmptyTable();
+
+	// The fixed hotkey settings, and the action each one triggers
+	struct HotkeySetting
+	{
+		int SettingsStruct::* member;
+		int action;
+	};
+
+	const HotkeySetting hotkeySettings[] = {
+		{ &SettingsStruct::startKey, KEY_START },
+		{ &SettingsStruct::startNoResetKey, KEY_START_NO_RESET },
+		{ &SettingsStruct::timer1Key, KEY_TIMER1 },
+		{ &SettingsStruct::timer2Key, KEY_TIMER2 },
+		{ &SettingsStruct::conStartKey, KEY_START },
+		{ &SettingsStruct::conStartNoResetKey, KEY_START_NO_RESET },
+		{ &SettingsStruct::conTimer1Key, KEY_TIMER1 },
+		{ &SettingsStruct::conTimer2Key, KEY_TIMER2 },
+	};
+
+	/**
+	@brief Add the bindings of the settings whose action is registered.
+	*/
+	void appendBindings(std::vector<ActionBinding>& bindings, const std::vector<BindingStruct>& settingsBindings)
+	{
+		for (const BindingStruct& binding : settingsBindings)
+		{
+			const int action = ActionRegistry::findAction(binding.action);
+			if (action != HotkeyManager::NO_ACTION) bindings.push_back({ binding.keyCode, action });
+		}
+	}
+}
+
+std::atomic<const HotkeyTable*> HotkeyManager::table_(&emptyTable);
+std::mutex HotkeyManager::writeMutex_;
+std::vector<std::unique_ptr<const HotkeyTable>> HotkeyManager::tables_;
+std::vector<std::unique_ptr<const HotkeyTable>> HotkeyManager::retiredTables_;
+std::vector<std::string> HotkeyManager::profileNames_;
+size_t HotkeyManager::activeProfile_ = 0;
+std::atomic<int> HotkeyManager::readerCount_(0);
+std::bitset<HotkeyTable::KEY_COUNT> HotkeyManager::heldKeys_;
+DWORD HotkeyManager::keyDownTimes_[HotkeyTable::KEY_COUNT];
+HotkeyManager::LastPress HotkeyManager::keyPresses_[HotkeyTable::KEY_COUNT];
+HotkeyManager::LastPress HotkeyManager::controllerPresses_[HotkeyTable::CONTROLLER_COUNT];
+constexpr DWORD HotkeyManager::REPEAT_TIMEOUT;
+constexpr int HotkeyManager::NO_ACTION;
+constexpr int HotkeyTable::KEY_COUNT;
+constexpr int HotkeyTable::MODIFIER_COUNT;
+constexpr int HotkeyTable::CONTROLLER_COUNT;
+constexpr int HotkeyTable::MAX_ACTION_LISTS;
+constexpr int HotkeyTable::MAX_ACTIONS_PER_KEY;
 
 void HotkeyManager::setHotkeysMap(const SettingsStruct& settings)
 {
-	setHotkeysMap(
-		settings.startKey, settings.startNoResetKey, settings.timer1Key, settings.timer2Key,
-		settings.conStartKey, settings.conStartNoResetKey, settings.conTimer1Key, settings.conTimer2Key
-	);
+	std::vector<ActionBinding> baseBindings;
+	baseBindings.reserve((std::end(hotkeySettings) - std::begin(hotkeySettings)) + settings.bindings.size());
+
+	for (const HotkeySetting& hotkey : hotkeySettings) {
+		baseBindings.push_back({ settings.*hotkey.member, hotkey.action });
+	}
+	appendBindings(baseBindings, settings.bindings);
+
+	std::vector<std::unique_ptr<const HotkeyTable>> tables;
+	std::vector<std::string> profileNames;
+
+	if (settings.profiles.empty()) {
+		tables.push_back(compileTable(baseBindings, settings.debounceTime));
+		profileNames.emplace_back();
+	}
+
+	// Every profile is compiled up front, so switching to it is just a store
+	for (const ProfileStruct& profile : settings.profiles)
+	{
+		// The profile's bindings come first, so their hotkeys win over the base ones
+		std::vector<ActionBinding> bindings;
+		appendBindings(bindings, profile.bindings);
+		bindings.insert(bindings.end(), baseBindings.begin(), baseBindings.end());
+
+		tables.push_back(compileTable(bindings, settings.debounceTime));
+		profileNames.push_back(profile.name);
+	}
+
+	publishTables(std::move(tables), profileNames);
+}
+
+void HotkeyManager::bind(HotkeyTable& table, signed char* modifierCounts, const int keyCode, const int actionList)
+{
+	if (keyCode >= 0 && keyCode < HotkeyTable::KEY_COUNT * HotkeyTable::MODIFIER_COUNT) {
+		const int key = keyCode & HOTKEY_KEY_MASK;
+		const int modifiers = keyCode >> HOTKEY_MODIFIERS_SHIFT;
+		const signed char modifierCount = (signed char)std::bitset<HotkeyTable::MODIFIER_COUNT>(modifiers).count();
+
+		// Fill every combination of held modifiers that contains the hotkey's modifiers,
+		// unless a hotkey with more of them already owns it
+		for (int held = 0; held < HotkeyTable::MODIFIER_COUNT; held++)
+		{
+			if ((held & modifiers) != modifiers) continue;
+
+			const int index = (held << HOTKEY_MODIFIERS_SHIFT) | key;
+			if (table.keys[index] == NO_ACTION || modifierCounts[index] < modifierCount) {
+				table.keys[index] = (signed char)actionList;
+				modifierCounts[index] = modifierCount;
+			}
+		}
+	}
+	else if (keyCode >= CONTROLLER_UP && keyCode - CONTROLLER_UP < HotkeyTable::CONTROLLER_COUNT) {
+		signed char& slot = table.controllerButtons[keyCode - CONTROLLER_UP];
+		if (slot == NO_ACTION) slot = (signed char)actionList;
+	}
+}
+
+std::unique_ptr<const HotkeyTable> HotkeyManager::compileTable(const std::vector<ActionBinding>& bindings, const int debounceTime)
+{
+	// Built off the hook path, then swapped in with a single store
+	std::unique_ptr<HotkeyTable> table = std::make_unique<HotkeyTable>(emptyTable);
+	signed char modifierCounts[HotkeyTable::KEY_COUNT * HotkeyTable::MODIFIER_COUNT] = {};
+
+	// Gather the actions of every distinct hotkey into one list, in the order they were bound
+	std::vector<int> keyCodes; // indexed by action list
+	for (const ActionBinding& binding : bindings)
+	{
+		if (binding.action < 0 || binding.action >= ActionRegistry::MAX_ACTIONS) continue;
+
+		const size_t list = std::find(keyCodes.begin(), keyCodes.end(), binding.keyCode) - keyCodes.begin();
+		if (list == keyCodes.size())
+		{
+			if (list == HotkeyTable::MAX_ACTION_LISTS) continue;
+
+			keyCodes.push_back(binding.keyCode);
+		}
+
+		signed char* const pActions = table->actionLists[list];
+		signed char* const pActionsEnd = pActions + HotkeyTable::MAX_ACTIONS_PER_KEY;
+		signed char* const pSlot = std::find(pActions, pActionsEnd, (signed char)NO_ACTION);
+
+		if (pSlot != pActionsEnd && std::find(pActions, pSlot, (signed char)binding.action) == pSlot) {
+			*pSlot = (signed char)binding.action;
+		}
+	}
+
+	for (size_t list = 0; list < keyCodes.size(); list++) {
+		bind(*table, modifierCounts, keyCodes[list], (int)list);
+	}
+
+	table->debounceTime = (DWORD)std::max(debounceTime, 0);
+	return table;
+}
+
+void HotkeyManager::setHotkeysMap(const std::vector<ActionBinding>& bindings, const int debounceTime)
+{
+	std::vector<std::unique_ptr<const HotkeyTable>> tables;
+	tables.push_back(compileTable(bindings, debounceTime));
+
+	publishTables(std::move(tables), { std::string() });
+}
+
+void HotkeyManager::publishTables(std::vector<std::unique_ptr<const HotkeyTable>> tables, const std::vector<std::string>& profileNames)
+{
+	std::lock_guard<std::mutex> lock(writeMutex_);
+
+	// Keep the active profile across settings changes, as long as it's still there
+	const std::string activeName = activeProfile_ < profileNames_.size() ? profileNames_[activeProfile_] : std::string();
+	const size_t index = std::find(profileNames.begin(), profileNames.end(), activeName) - profileNames.begin();
+	activeProfile_ = index < profileNames.size() ? index : 0;
+
+	for (std::unique_ptr<const HotkeyTable>& pTable : tables_) {
+		retiredTables_.push_back(std::move(pTable));
+	}
+
+	tables_ = std::move(tables);
+	profileNames_ = profileNames;
+
+	// Sequentially consistent, ordered before reclaimTables reads the reader count
+	table_.store(tables_[activeProfile_].get());
+
+	reclaimTables();
+}
+
+void HotkeyManager::reclaimTables()
+{
+	// A reader that opens it's scope after this load reads the newly published table, never a retired one.
+	// Readers only stay for the length of a hook call, otherwise the tables wait for the next try.
+	if (readerCount_.load() == 0) {
+		retiredTables_.clear();
+	}
+}
+
+std::string HotkeyManager::nextProfile()
+{
+	std::lock_guard<std::mutex> lock(writeMutex_);
+
+	if (tables_.empty()) return std::string();
+
+	activeProfile_ = (activeProfile_ + 1) % tables_.size();
+	table_.store(tables_[activeProfile_].get());
+
+	reclaimTables();
+	return profileNames_[activeProfile_];
 }
 
-void HotkeyManager::setHotkeysMap(int startKey, int startNoResetKey, int timer1Key, int timer2Key, int conStartKey, int conStartNoResetKey, int conTimer1Key, int conTimer2Key)
+
+const signed char* HotkeyManager::findActions(const int keyCode)
 {
-	hotkeysMap.clear();
+	const HotkeyTable& table = *table_.load();
+	int list = NO_ACTION;
 
-	hotkeysMap.insert({ startKey, KEY_START });
-	hotkeysMap.insert({ startNoResetKey, KEY_START_NO_RESET });
-	hotkeysMap.insert({ timer1Key, KEY_TIMER1 });
-	hotkeysMap.insert({ timer2Key, KEY_TIMER2 });
+	// One bounds check and one array load per lookup
+	if ((unsigned)keyCode < (unsigned)(HotkeyTable::KEY_COUNT * HotkeyTable::MODIFIER_COUNT)) {
+		list = table.keys[keyCode];
+	}
+	else if ((unsigned)(keyCode - CONTROLLER_UP) < (unsigned)HotkeyTable::CONTROLLER_COUNT) {
+		list = table.controllerButtons[keyCode - CONTROLLER_UP];
+	}
 
-	hotkeysMap.insert({ conStartKey, KEY_START });
-	hotkeysMap.insert({ conStartNoResetKey, KEY_START_NO_RESET });
-	hotkeysMap.insert({ conTimer1Key, KEY_TIMER1 });
-	hotkeysMap.insert({ conTimer2Key, KEY_TIMER2 });
+	return list == NO_ACTION ? nullptr : table.actionLists[list];
 }
 
-void HotkeyManager::execute(const int keyCode)
+int HotkeyManager::foldKey(const int keyCode)
 {
-	if (hotkeysMap.count(keyCode) && pGlobalTimerWindow->window() != nullptr)
+	switch (keyCode)
 	{
-		const int action = hotkeysMap[keyCode];
-		PostMessage(pGlobalTimerWindow->window(), HOTKEY_HIT, action, 0);
+	case VK_LMENU:
+	case VK_RMENU:
+		return VK_MENU;
+	case VK_LCONTROL:
+	case VK_RCONTROL:
+		return VK_CONTROL;
+	case VK_LSHIFT:
+	case VK_RSHIFT:
+		return VK_SHIFT;
+	default:
+		return keyCode;
 	}
 }
 
+int HotkeyManager::modifierOf(const int keyCode)
+{
+	switch (keyCode)
+	{
+	case VK_CONTROL:
+	case VK_LCONTROL:
+	case VK_RCONTROL:
+		return HOTKEY_CTRL;
+	case VK_SHIFT:
+	case VK_LSHIFT:
+	case VK_RSHIFT:
+		return HOTKEY_SHIFT;
+	case VK_MENU:
+	case VK_LMENU:
+	case VK_RMENU:
+		return HOTKEY_ALT;
+	case VK_LWIN:
+	case VK_RWIN:
+		return HOTKEY_WIN;
+	default:
+		return 0;
+	}
+}
+
+int HotkeyManager::heldModifiers()
+{
+	int modifiers = 0;
+
+	if (heldKeys_[VK_LCONTROL] || heldKeys_[VK_RCONTROL]) modifiers |= HOTKEY_CTRL;
+	if (heldKeys_[VK_LSHIFT] || heldKeys_[VK_RSHIFT]) modifiers |= HOTKEY_SHIFT;
+	if (heldKeys_[VK_LMENU] || heldKeys_[VK_RMENU]) modifiers |= HOTKEY_ALT;
+	if (heldKeys_[VK_LWIN] || heldKeys_[VK_RWIN]) modifiers |= HOTKEY_WIN;
+
+	return modifiers;
+}
+
+bool HotkeyManager::isBounce(LastPress& lastPress, const DWORD time, const DWORD debounceTime)
+{
+	// Unsigned, so the tick count wrapping around doesn't matter
+	if (lastPress.isSet && time - lastPress.time < debounceTime) return true;
+
+	lastPress.time = time;
+	lastPress.isSet = true;
+	return false;
+}
+
+void HotkeyManager::keyDown(const int keyCode, const DWORD time)
+{
+	const LatencyScope latencyScope(LATENCY_HOTKEY_LOOKUP);
+
+	if ((unsigned)keyCode >= (unsigned)HotkeyTable::KEY_COUNT) return;
+
+	// Windows repeats the down of a held key, only the first one is a press
+	const bool isRepeat = heldKeys_[keyCode] && time - keyDownTimes_[keyCode] < REPEAT_TIMEOUT;
+
+	heldKeys_[keyCode] = true;
+	keyDownTimes_[keyCode] = time;
+
+	if (isRepeat) return;
+
+	const HotkeyReadScope readScope;
+	const HotkeyTable& table = *table_.load();
+	if (isBounce(keyPresses_[keyCode], time, table.debounceTime)) return;
+
+	// A modifier doesn't modify itself, so a hotkey bound to Ctrl alone still fires
+	const int hitKey = foldKey(keyCode);
+	const signed char* pActions = findActions(hitKey | (heldModifiers() & ~modifierOf(hitKey)));
+
+	// Never blocks, hook procedures that take too long are skipped by Windows
+	if (pActions != nullptr && hwndMainWindow != nullptr)
+	{
+		for (int i = 0; i < HotkeyTable::MAX_ACTIONS_PER_KEY && pActions[i] != NO_ACTION; i++) {
+			InputQueue::pushHotkey(pActions[i], time);
+		}
+	}
+}
+
+bool HotkeyManager::controllerDown(const int button, const DWORD time)
+{
+	const unsigned index = (unsigned)(button - CONTROLLER_UP);
+
+	// Codes past the known buttons are let through as they are
+	if (index >= (unsigned)HotkeyTable::CONTROLLER_COUNT) return true;
+
+	const HotkeyReadScope readScope;
+	const HotkeyTable& table = *table_.load();
+	return !isBounce(controllerPresses_[index], time, table.debounceTime);
+}
+
+void HotkeyManager::keyUp(const int keyCode)
+{
+	if ((unsigned)keyCode >= (unsigned)HotkeyTable::KEY_COUNT) return;
+
+	heldKeys_[keyCode] = false;
+}
@@ -1,35 +1,242 @@
 #pragma once
-#include <unordered_map>
+#include <atomic>
+#include <bitset>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "Globals.h"
 
+// A hotkey linked to an action. Actions can have any number of hotkeys, and hotkeys a few actions.
+struct ActionBinding
+{
+	int keyCode; // a keyboard hotkey (a virtual key with HOTKEY_ modifiers) or controller button
+	int action; // a KEY_ action
+};
+
+// Flat lookup table from inputs to the KEY_ actions they trigger, indexed directly by keyboard hotkey or controller button
+struct HotkeyTable
+{
+	static constexpr int KEY_COUNT = 256;
+	static constexpr int MODIFIER_COUNT = (HOTKEY_MODIFIERS >> HOTKEY_MODIFIERS_SHIFT) + 1; // every combination of held modifiers
+	static constexpr int CONTROLLER_COUNT = CONTROLLER_RIGHT_TRIGGER - CONTROLLER_UP + 1;
+	static constexpr int MAX_ACTION_LISTS = 127; // distinct hotkeys a table can hold
+	static constexpr int MAX_ACTIONS_PER_KEY = 4;
+
+	// Indexed by the virtual key combined with the held HOTKEY_ modifiers, holds an index into actionLists.
+	// Chords are resolved when the table is built: every combination of held modifiers holds the actions of
+	// the most specific hotkey it satisfies, so a plain F1 still fires while Shift is held, unless SHIFT+F1 has an action.
+	signed char keys[KEY_COUNT * MODIFIER_COUNT];
+	signed char controllerButtons[CONTROLLER_COUNT]; // indexed from CONTROLLER_UP, holds an index into actionLists
+
+	// The actions of every hotkey in the order they were bound, padded with NO_ACTION
+	signed char actionLists[MAX_ACTION_LISTS][MAX_ACTIONS_PER_KEY];
+
+	DWORD debounceTime; // presses of the same key or button closer together than this many milliseconds are dropped
+};
+
 class HotkeyManager
 {
+private:
+	friend class HotkeyReadScope;
+
+	// The table of the active profile. Switching profiles is a single store, the hooks never lock.
+	static std::atomic<const HotkeyTable*> table_;
+	static std::mutex writeMutex_;
+
+	// One precompiled table per profile, or a single one without profiles.
+	// Tables replaced by a settings change are retired, and freed once no HotkeyReadScope is open,
+	// since every reader that could still see them opened it's scope before they were replaced.
+	static std::vector<std::unique_ptr<const HotkeyTable>> tables_;
+	static std::vector<std::unique_ptr<const HotkeyTable>> retiredTables_;
+	static std::vector<std::string> profileNames_;
+	static size_t activeProfile_;
+	static std::atomic<int> readerCount_;
+
+	// The physical keys and mouse buttons that are down right now, by unfolded virtual key.
+	// Only touched by the thread the input backend reports keys on, the hooks' main thread on Windows.
+	static std::bitset<HotkeyTable::KEY_COUNT> heldKeys_;
+
+	// The last press of a key or button that was let through
+	struct LastPress
+	{
+		DWORD time;
+		bool isSet; // time stamps can start anywhere, a replay's start at 0, so the first press is always let through
+	};
+
+	// Edge detection state, in the milliseconds of the input's time stamps.
+	// The key arrays are only touched by the thread that reports keys, the controller array only by the one that reports controller buttons.
+	static DWORD keyDownTimes_[HotkeyTable::KEY_COUNT]; // every down, auto-repeats included
+	static LastPress keyPresses_[HotkeyTable::KEY_COUNT]; // only the downs that were let through
+	static LastPress controllerPresses_[HotkeyTable::CONTROLLER_COUNT];
+
+	// A key that stays down longer than this without repeating missed it's release (e.g. to the lock screen),
+	// the longest auto-repeat delay Windows allows is one second
+	static constexpr DWORD REPEAT_TIMEOUT = 1500;
+
+	/**
+	@brief Link a hotkey to an action in a table. Hotkeys that already have an action keep it.
+
+	@param table The table to fill.
+
+	@param modifierCounts The number of modifiers of the hotkey that owns each keyboard slot of the table.
+
+	@param keyCode The keyboard hotkey (a virtual key with HOTKEY_ modifiers) or controller button.
+
+	@param actionList The index of the hotkey's actions in the table's actionLists.
+	*/
+	static void bind(HotkeyTable& table, signed char* modifierCounts, int keyCode, int actionList);
+
+	/**
+	@brief Compile bindings into a table.
+
+	@param bindings The hotkeys and their actions. A hotkey bound to several actions triggers them in this order,
+			hotkeys past the table's limits are skipped.
+
+	@param debounceTime Presses of the same key closer together than this many milliseconds are dropped
+
+	@return The table, not published yet.
+	*/
+	static std::unique_ptr<const HotkeyTable> compileTable(const std::vector<ActionBinding>& bindings, int debounceTime);
+
+	/**
+	@brief Replace the tables of every profile and publish the one of the active profile. The old tables are retired.
+			The active profile stays active if a profile of the same name is published.
+
+	@param tables The tables, one per profile.
+
+	@param profileNames The names of the profiles, one per table.
+	*/
+	static void publishTables(std::vector<std::unique_ptr<const HotkeyTable>> tables, const std::vector<std::string>& profileNames);
+
+	/**
+	@brief Free the retired tables, unless a reader might still use them. Needs writeMutex_ to be held.
+	*/
+	static void reclaimTables();
+
+	/**
+	@brief Fold the left and right variants of Alt, Control and Shift into one key, so it doesn't matter which one was hit.
+
+	@param keyCode The virtual key reported by an input backend.
+
+	@return The virtual key that hotkeys are saved with.
+	*/
+	static int foldKey(int keyCode);
+
+	/**
+	@return The HOTKEY_ modifiers that are held right now.
+	*/
+	static int heldModifiers();
+
+	/**
+	@brief Check a press against the last one of the same input, and remember it if it's let through.
+
+	@param lastPress The input's last press that was let through.
+
+	@param time The time of the new press.
+
+	@param debounceTime The debounce window of the current table.
+
+	@return Wether the press came too soon after the last one and should be dropped.
+	*/
+	static bool isBounce(LastPress& lastPress, DWORD time, DWORD debounceTime);
+
 public:
-	static std::unordered_map<int, int> hotkeysMap;
+	static constexpr int NO_ACTION = -1;
 
 	/**
-	@brief Set the contents of the hotkeyMap
+	@brief Set the contents of the hotkeyMap, from the hotkey settings and the bindings array.
+			Every profile gets it's own table, where the profile's bindings take the hotkeys they use over.
+			Bindings to actions that aren't registered are skipped.
 
 	@param settings A reference to the SettingsStruct to receive hotkey data from
 	*/
 	static void setHotkeysMap(const SettingsStruct &settings);
 
 	/**
-	@brief Set the contents of the hotkeyMap
+	@brief Compile bindings into a new hotkey table and publish it, without profiles. The hooks see either the old or the new table, never a mix of both.
 
-	@param startKey A virtual key for the Start/Stop/Reset hotkey
+	@param bindings The hotkeys and their actions. A hotkey bound to several actions triggers them in this order,
+			hotkeys past the table's limits are skipped.
 
-	@param startKey A virtual key for switching to timer 1
+	@param debounceTime Presses of the same key closer together than this many milliseconds are dropped
+	*/
+	static void setHotkeysMap(const std::vector<ActionBinding>& bindings, int debounceTime = 0);
 
-	@param startKey A virtual key for switching to timer 2
+	/**
+	@brief Make the next profile active, after the last one the first. Should be called from the main window's thread.
+			The hooks see the new profile's table from their next key on.
+
+	@return The name of the profile that is active now, empty without profiles.
+	*/
+	static std::string nextProfile();
+
+	/**
+	@brief Lock-free, constant time lookup. Safe to call from any thread, including hook procedures.
+			Must be called inside a HotkeyReadScope, which keeps the table alive while the result is used.
+
+	@param keyCode The keyboard hotkey (a virtual key with the held HOTKEY_ modifiers) or controller button to look up.
+
+	@return The KEY_ actions linked to the key, MAX_ACTIONS_PER_KEY of them padded with NO_ACTION, or nullptr if it isn't a hotkey.
 	*/
-	static void setHotkeysMap(int startKey, int startNoResetKey, int timer1Key, int timer2Key, int conStartKey, int conStartNoResetKey, int conTimer1Key, int conTimer2Key);
+	static const signed char* findActions(int keyCode);
 
 	/**
-	@brief If the keyCode is linked to a hotkey, post a message to MainWindow activate it.
+	@param keyCode A virtual key.
 
-	@param keyCode The virtual key to execute
+	@return The HOTKEY_ modifier the key stands for, or 0 if it isn't a modifier key.
 	*/
-	static void execute(int keyCode);
+	static int modifierOf(int keyCode);
+
+	/**
+	@brief Track a key or mouse button going down, and if it's a fresh press that completes a hotkey, queue it's action for MainWindow.
+			Auto-repeats and presses within the debounce time are dropped. Called from the input backend's thread.
+
+	@param keyCode The virtual key reported by the input backend
+
+	@param time The time stamp reported by the input backend, in milliseconds
+	*/
+	static void keyDown(int keyCode, DWORD time);
+
+	/**
+	@brief Debounce a controller button press. Called from the input backend's thread.
+
+	@param button The CONTROLLER_ button reported by the input backend.
+
+	@param time The time of the press, in GetTickCount milliseconds.
+
+	@return Wether the press should be handled, false if it's a bounce of the previous press.
+	*/
+	static bool controllerDown(int button, DWORD time);
+
+	/**
+	@brief Track a key or mouse button going up. Called from the input backend's thread.
+
+	@param keyCode The virtual key reported by the input backend
+	*/
+	static void keyUp(int keyCode);
+};
+
+// Marks the scope it's declared in as reading the hotkey tables, tables replaced meanwhile aren't freed until it ends.
+// Opening and closing it costs an atomic increment and decrement, it never locks or waits.
+class HotkeyReadScope
+{
+public:
+	HotkeyReadScope()
+	{
+		// Sequentially consistent, so a reader that loads a table counted itself before the table could be retired
+		HotkeyManager::readerCount_.fetch_add(1);
+	}
+
+	~HotkeyReadScope()
+	{
+		HotkeyManager::readerCount_.fetch_sub(1, std::memory_order_release);
+	}
+
+	// Prevent copying, which would close the scope twice
+
+	HotkeyReadScope(const HotkeyReadScope& other) = delete;
+
+	HotkeyReadScope& operator=(const HotkeyReadScope& other) = delete;
 };
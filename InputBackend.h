@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+// A key or button changing state, as reported by an input backend
+struct KeyEvent
+{
+	int code; // a virtual key, or a CONTROLLER_ button (see InputCodes.h)
+	bool isDown;
+	uint32_t time; // AppClock milliseconds of when the input happened, the timers count from it
+};
+
+// A source of key and button events, like the Windows hooks, a controller or a recording.
+// Backends report every change through the input callback, from whichever thread they capture input on.
+// Every backend must report from a single thread, since the input pipeline behind the callback isn't shared between threads.
+class InputBackend
+{
+protected:
+	std::function<void(const KeyEvent&)> inputCallback_;
+
+public:
+	InputBackend() = default;
+
+	// Prevent copying of the capture state
+
+	InputBackend(const InputBackend& other) = delete;
+
+	InputBackend& operator=(const InputBackend& other) = delete;
+
+	virtual ~InputBackend() = default;
+
+	/**
+	@brief Set a callback method to be called for every key event. Must be set before starting the backend.
+
+	@param callback The method to be called.
+	*/
+	void setInputCallback(const std::function<void(const KeyEvent&)>& callback)
+	{
+		inputCallback_ = callback;
+	}
+
+	/**
+	@brief Start capturing input.
+
+	@return Wether capturing started.
+	*/
+	virtual bool start() = 0;
+
+	/**
+	@brief Stop capturing input. No events are reported once it returns.
+	*/
+	virtual void stop() = 0;
+};
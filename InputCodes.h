@@ -0,0 +1,31 @@
+#pragma once
+
+// The codes inputs are bound with, shared by every input backend.
+// Keyboard keys and mouse buttons use Windows virtual keys, the codes below are free for other devices.
+
+// Controller input Buttons
+constexpr unsigned short CONTROLLER_UP = 5000;
+constexpr unsigned short CONTROLLER_DOWN = 5001;
+constexpr unsigned short CONTROLLER_RIGHT = 5002;
+constexpr unsigned short CONTROLLER_LEFT = 5003;
+constexpr unsigned short CONTROLLER_START = 5004;
+constexpr unsigned short CONTROLLER_BACK = 5005;
+constexpr unsigned short CONTROLLER_LEFT_THUMB = 5006;
+constexpr unsigned short CONTROLLER_RIGHT_THUMB = 5007;
+constexpr unsigned short CONTROLLER_LEFT_SHOULDER = 5008;
+constexpr unsigned short CONTROLLER_RIGHT_SHOULDER = 5009;
+constexpr unsigned short CONTROLLER_A = 5010;
+constexpr unsigned short CONTROLLER_B = 5011;
+constexpr unsigned short CONTROLLER_X = 5012;
+constexpr unsigned short CONTROLLER_Y = 5013;
+constexpr unsigned short CONTROLLER_LEFT_TRIGGER = 5014;
+constexpr unsigned short CONTROLLER_RIGHT_TRIGGER = 5015;
+
+// Keyboard hotkey modifiers, combined with the virtual key of a keyboard hotkey (e.g. HOTKEY_CTRL | VK_F1)
+constexpr int HOTKEY_KEY_MASK = 0xFF;
+constexpr int HOTKEY_CTRL = 0x100;
+constexpr int HOTKEY_SHIFT = 0x200;
+constexpr int HOTKEY_ALT = 0x400;
+constexpr int HOTKEY_WIN = 0x800;
+constexpr int HOTKEY_MODIFIERS = HOTKEY_CTRL | HOTKEY_SHIFT | HOTKEY_ALT | HOTKEY_WIN;
+constexpr int HOTKEY_MODIFIERS_SHIFT = 8;
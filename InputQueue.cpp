@@ -0,0 +1,62 @@
+#include "InputQueue.h"
+
+SpscRing<InputEvent, InputQueue::capacity> InputQueue::hotkeyEvents_;
+SpscRing<InputEvent, InputQueue::capacity> InputQueue::controllerEvents_;
+std::atomic<bool> InputQueue::isWakeUpPending_(false);
+constexpr size_t InputQueue::capacity;
+
+static LONGLONG now()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+void InputQueue::wakeUp()
+{
+	if (isWakeUpPending_.exchange(true)) return;
+
+	// A full message queue drops the wake up, let the next event try again
+	if (!PostMessage(hwndMainWindow, INPUT_EVENTS, 0, 0)) {
+		isWakeUpPending_ = false;
+	}
+}
+
+bool InputQueue::pushHotkey(const int action, const uint32_t inputTime)
+{
+	if (!hotkeyEvents_.tryPush({ action, now(), inputTime })) return false;
+
+	wakeUp();
+	return true;
+}
+
+bool InputQueue::pushController(const WORD buttons, const uint32_t inputTime)
+{
+	if (!controllerEvents_.tryPush({ buttons, now(), inputTime })) return false;
+
+	wakeUp();
+	return true;
+}
+
+bool InputQueue::pop(InputEvent& event, bool& isHotkey)
+{
+	InputEvent hotkeyEvent;
+	InputEvent controllerEvent;
+	const bool hasHotkey = hotkeyEvents_.peek(hotkeyEvent);
+	const bool hasController = controllerEvents_.peek(controllerEvent);
+
+	// Keep the order the inputs arrived in across sources
+	isHotkey = hasHotkey && (!hasController || hotkeyEvent.time <= controllerEvent.time);
+
+	if (isHotkey) {
+		return hotkeyEvents_.tryPop(event);
+	}
+
+	return hasController && controllerEvents_.tryPop(event);
+}
+
+void InputQueue::beginDrain()
+{
+	// An exchange, so the events pushed before the flag was last set are visible to the pops that follow
+	isWakeUpPending_.exchange(false);
+}
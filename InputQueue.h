@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#include "Globals.h"
+#include "SpscRing.h"
+
+// An input that arrived from an input backend
+struct InputEvent
+{
+	int code; // the hotkey action for hotkey events, the buttons for controller events
+	LONGLONG time; // QueryPerformanceCounter ticks of when the input arrived
+	uint32_t inputTime; // the input's own time stamp in AppClock milliseconds, what the timers count from
+};
+
+// Hands input from the input backends' threads to the main window.
+// Every source has it's own single producer ring, so pushing never blocks or allocates,
+// and the main window drains all of them in a batch after a single INPUT_EVENTS wake up.
+class InputQueue
+{
+private:
+	static constexpr size_t capacity = 256;
+
+	static SpscRing<InputEvent, capacity> hotkeyEvents_; // produced by the thread that reports keys
+	static SpscRing<InputEvent, capacity> controllerEvents_; // produced by the thread that reports controller buttons
+	static std::atomic<bool> isWakeUpPending_;
+
+	/**
+	@brief Post INPUT_EVENTS to the main window, unless one is already on it's way.
+	*/
+	static void wakeUp();
+
+public:
+	/**
+	@brief Queue a hotkey action. Should only be called from the thread that reports keys.
+
+	@param action The KEY_ action of the hit hotkey.
+
+	@param inputTime The time stamp of the key that hit the hotkey.
+
+	@return Wether the event was queued, false if the queue is full.
+	*/
+	static bool pushHotkey(int action, uint32_t inputTime);
+
+	/**
+	@brief Queue a controller input. Should only be called from the thread that reports controller buttons.
+
+	@param buttons The buttons that had a state change.
+
+	@param inputTime The time stamp of the button press.
+
+	@return Wether the event was queued, false if the queue is full.
+	*/
+	static bool pushController(WORD buttons, uint32_t inputTime);
+
+	/**
+	@brief Take the oldest event of all sources. Should only be called from the main window's thread.
+
+	@param event Receives the event.
+
+	@param isHotkey Receives wether the event is a hotkey action or a controller input.
+
+	@return Wether there was an event.
+	*/
+	static bool pop(InputEvent& event, bool& isHotkey);
+
+	/**
+	@brief Called by the main window before draining the queues, so events pushed after it post a new wake up.
+	*/
+	static void beginDrain();
+};
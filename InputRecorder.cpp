@@ -0,0 +1,238 @@
+#include "InputRecorder.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "InputCodes.h"
+
+namespace
+{
+	const char magic[8] = { 'D', 'B', 'D', 'I', 'N', 'P', 'U', 'T' };
+	constexpr size_t headerSize = sizeof(magic) + 8; // magic, version, settings length
+	constexpr size_t recordSize = 8;
+	constexpr size_t endPayloadSize = 16;
+
+	enum RecordKind : uint8_t
+	{
+		RECORD_EVENT = 0,
+		RECORD_END = 1
+	};
+
+	void appendU8(std::string& buffer, const uint8_t value)
+	{
+		buffer += (char)value;
+	}
+
+	void appendU16(std::string& buffer, const uint16_t value)
+	{
+		appendU8(buffer, (uint8_t)value);
+		appendU8(buffer, (uint8_t)(value >> 8));
+	}
+
+	void appendU32(std::string& buffer, const uint32_t value)
+	{
+		appendU16(buffer, (uint16_t)value);
+		appendU16(buffer, (uint16_t)(value >> 16));
+	}
+
+	uint16_t readU16(const char* p)
+	{
+		return (uint16_t)((uint8_t)p[0] | (uint8_t)p[1] << 8);
+	}
+
+	uint32_t readU32(const char* p)
+	{
+		return (uint32_t)readU16(p) | (uint32_t)readU16(p + 2) << 16;
+	}
+
+	void appendRecord(std::string& buffer, const uint32_t time, const uint16_t code, const bool isDown, const RecordKind kind)
+	{
+		appendU32(buffer, time);
+		appendU16(buffer, code);
+		appendU8(buffer, isDown ? 1 : 0);
+		appendU8(buffer, kind);
+	}
+}
+
+constexpr size_t InputRecorder::capacity;
+constexpr uint32_t InputRecorder::flushInterval;
+constexpr uint32_t InputRecorder::version;
+
+SpscRing<KeyEvent, InputRecorder::capacity> InputRecorder::keyEvents_;
+SpscRing<KeyEvent, InputRecorder::capacity> InputRecorder::controllerEvents_;
+std::atomic<bool> InputRecorder::isRecording_(false);
+std::atomic<uint32_t> InputRecorder::droppedCount_(0);
+std::ofstream InputRecorder::file_;
+std::string InputRecorder::buffer_;
+std::thread InputRecorder::writerThread_;
+std::mutex InputRecorder::mutex_;
+std::condition_variable InputRecorder::condition_;
+
+bool InputRecorder::start(const std::string& fileName, const std::string& settings)
+{
+	if (isRecording()) return false;
+
+	file_.open(fileName, std::ios::binary | std::ios::trunc);
+	if (!file_) return false;
+
+	// Room for both rings, so a flush never grows the buffer
+	buffer_.clear();
+	buffer_.reserve(2 * capacity * recordSize + recordSize + endPayloadSize);
+
+	std::string header(magic, sizeof(magic));
+	appendU32(header, version);
+	appendU32(header, (uint32_t)settings.size());
+	header += settings;
+	file_.write(header.data(), header.size());
+
+	droppedCount_ = 0;
+	isRecording_ = true;
+	writerThread_ = std::thread(writeLoop);
+	return true;
+}
+
+void InputRecorder::record(const KeyEvent& event)
+{
+	if (!isRecording()) return;
+
+	SpscRing<KeyEvent, capacity>& ring = event.code >= CONTROLLER_UP ? controllerEvents_ : keyEvents_;
+	if (!ring.tryPush(event)) {
+		droppedCount_.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void InputRecorder::stop(const RecordingEnd& end)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!isRecording_) return;
+
+		isRecording_ = false;
+	}
+
+	condition_.notify_one();
+
+	if (writerThread_.joinable())
+	{
+		writerThread_.join();
+	}
+
+	// The backends are stopped by now, so nothing is pushed after the last flush
+	flush();
+
+	buffer_.clear();
+	appendRecord(buffer_, end.time, 0, false, RECORD_END);
+	appendU32(buffer_, (uint32_t)end.timer1Time);
+	appendU32(buffer_, (uint32_t)end.timer2Time);
+	appendU8(buffer_, end.timer1State);
+	appendU8(buffer_, end.timer2State);
+	appendU8(buffer_, end.activeTimer);
+	appendU8(buffer_, 0);
+	appendU32(buffer_, droppedCount_.load());
+	file_.write(buffer_.data(), buffer_.size());
+	file_.close();
+}
+
+void InputRecorder::writeLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	while (isRecording_)
+	{
+		condition_.wait_for(lock, std::chrono::milliseconds(flushInterval), []() { return !isRecording_; });
+
+		lock.unlock();
+		flush();
+		lock.lock();
+	}
+}
+
+void InputRecorder::flush()
+{
+	buffer_.clear();
+
+	KeyEvent keyEvent;
+	KeyEvent controllerEvent;
+	bool hasKey = keyEvents_.peek(keyEvent);
+	bool hasController = controllerEvents_.peek(controllerEvent);
+
+	// Keep the order the inputs arrived in across the rings, the time stamps of both share the tick count.
+	// At most what the rings hold, so a busy producer can't grow the buffer past it's reserve.
+	for (size_t count = 0; (hasKey || hasController) && count < 2 * capacity; count++)
+	{
+		const bool isKey = hasKey && (!hasController || (int32_t)(keyEvent.time - controllerEvent.time) <= 0);
+		const KeyEvent& event = isKey ? keyEvent : controllerEvent;
+
+		appendRecord(buffer_, event.time, (uint16_t)event.code, event.isDown, RECORD_EVENT);
+
+		if (isKey) {
+			keyEvents_.tryPop(keyEvent);
+			hasKey = keyEvents_.peek(keyEvent);
+		}
+		else {
+			controllerEvents_.tryPop(controllerEvent);
+			hasController = controllerEvents_.peek(controllerEvent);
+		}
+	}
+
+	if (buffer_.empty()) return;
+
+	file_.write(buffer_.data(), buffer_.size());
+	file_.flush();
+}
+
+bool InputRecorder::isRecordingFile(const char* begin, const char* end)
+{
+	return (size_t)(end - begin) >= sizeof(magic) && memcmp(begin, magic, sizeof(magic)) == 0;
+}
+
+bool InputRecorder::read(const char* begin, const char* end, Recording& recording)
+{
+	recording = Recording();
+
+	const size_t size = (size_t)(end - begin);
+	if (size < headerSize || !isRecordingFile(begin, end) || readU32(begin + sizeof(magic)) != version) return false;
+
+	const uint32_t settingsLength = readU32(begin + sizeof(magic) + 4);
+	if (settingsLength > size - headerSize) return false;
+
+	recording.settings.assign(begin + headerSize, settingsLength);
+
+	for (const char* p = begin + headerSize + settingsLength; (size_t)(end - p) >= recordSize; p += recordSize)
+	{
+		const uint32_t time = readU32(p);
+		const uint16_t code = readU16(p + 4);
+		const uint8_t flags = (uint8_t)p[6];
+		const uint8_t kind = (uint8_t)p[7];
+
+		if (kind == RECORD_EVENT && code != 0 && flags <= 1)
+		{
+			recording.events.push_back({ code, flags == 1, time });
+			continue;
+		}
+
+		// The end record closes the file
+		if (kind != RECORD_END || (size_t)(end - p) != recordSize + endPayloadSize) break;
+
+		const char* pPayload = p + recordSize;
+		recording.end.time = time;
+		recording.end.timer1Time = (int32_t)readU32(pPayload);
+		recording.end.timer2Time = (int32_t)readU32(pPayload + 4);
+		recording.end.timer1State = (uint8_t)pPayload[8];
+		recording.end.timer2State = (uint8_t)pPayload[9];
+		recording.end.activeTimer = (uint8_t)pPayload[10];
+		recording.end.droppedCount = readU32(pPayload + 12);
+		recording.hasEnd = true;
+		return true;
+	}
+
+	// Anything but whole events up to the end of the file is corrupt
+	const size_t eventsSize = size - headerSize - settingsLength;
+	if (eventsSize % recordSize != 0 || recording.events.size() != eventsSize / recordSize)
+	{
+		recording = Recording();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InputBackend.h"
+#include "SpscRing.h"
+
+// The state of the timers when a recording ended, what a replay of it has to arrive at
+struct RecordingEnd
+{
+	uint32_t time; // AppClock milliseconds of when the recording stopped
+	int32_t timer1Time;
+	int32_t timer2Time;
+	uint8_t timer1State; // a TimerState
+	uint8_t timer2State;
+	uint8_t activeTimer; // 1 or 2
+	uint32_t droppedCount; // events lost to full rings, a replay can't match if there are any
+};
+
+// A whole recording, as read back from a file
+struct Recording
+{
+	std::string settings; // the settings file contents the recording started with
+	std::vector<KeyEvent> events;
+	bool hasEnd = false; // false if the app didn't get to stop the recording
+	RecordingEnd end = {};
+};
+
+// Records every key event the input backends report into a compact binary file, so a session can be replayed and checked later.
+// The backends' threads only copy their events into preallocated rings, a writer thread drains them to the file every so often,
+// so recording never allocates, blocks or touches the disk on the hook path.
+//
+// The file is little endian: "DBDINPUT", the format version and the settings as a length prefixed string,
+// then 8 bytes per event (time, code, down flag, record kind) and an end record holding the final timer state.
+class InputRecorder
+{
+private:
+	static constexpr size_t capacity = 4096;
+	static constexpr uint32_t flushInterval = 50; // milliseconds
+
+	static SpscRing<KeyEvent, capacity> keyEvents_; // produced by the thread that reports keys
+	static SpscRing<KeyEvent, capacity> controllerEvents_; // produced by the thread that reports controller buttons
+	static std::atomic<bool> isRecording_;
+	static std::atomic<uint32_t> droppedCount_;
+
+	static std::ofstream file_;
+	static std::string buffer_; // reused for every flush, so the writer thread doesn't allocate either
+	static std::thread writerThread_;
+	static std::mutex mutex_;
+	static std::condition_variable condition_;
+
+	/**
+	@brief The writer thread's loop. Flushes the rings until the recording stops.
+	*/
+	static void writeLoop();
+
+	/**
+	@brief Drain both rings into the file, merged in the order of their time stamps.
+	*/
+	static void flush();
+
+public:
+	static constexpr uint32_t version = 1;
+
+	/**
+	@brief Start recording into a file, replacing it.
+
+	@param fileName The file to record into.
+
+	@param settings The settings file contents to replay the recording with.
+
+	@return Wether the file could be created.
+	*/
+	static bool start(const std::string& fileName, const std::string& settings);
+
+	/**
+	@brief Record a key event. Called from the input backends' threads before the event is handled, never blocks.
+
+	@param event The event to record.
+	*/
+	static void record(const KeyEvent& event);
+
+	/**
+	@brief Write the remaining events and the end record, and close the file. Does nothing if nothing is being recorded.
+
+	@param end The state of the timers at the end of the recording. The dropped count is filled in by the recorder.
+	*/
+	static void stop(const RecordingEnd& end);
+
+	/**
+	@return Wether a recording is running.
+	*/
+	static bool isRecording() { return isRecording_.load(std::memory_order_relaxed); }
+
+	/**
+	@param begin The start of the file's contents.
+
+	@param end One past the end of the file's contents.
+
+	@return Wether the contents start like a binary recording.
+	*/
+	static bool isRecordingFile(const char* begin, const char* end);
+
+	/**
+	@brief Read a binary recording.
+
+	@param begin The start of the file's contents.
+
+	@param end One past the end of the file's contents.
+
+	@param recording Receives the recording.
+
+	@return Wether the whole recording could be read. A recording cut off after a whole event still reads, without an end.
+	*/
+	static bool read(const char* begin, const char* end, Recording& recording);
+};
@@ -0,0 +1,173 @@
+#include "LatencyMonitor.h"
+
+#include "SettingsUtils.h"
+
+namespace
+{
+	// Indexed by LatencyProbe
+	const wchar_t* const probeTitles[LATENCY_PROBE_COUNT] = {
+		L"Keyboard hook",
+		L"Mouse hook",
+		L"Hotkey lookup",
+		L"Hook to timer",
+	};
+
+	const char* const probeCsvNames[LATENCY_PROBE_COUNT] = {
+		"keyboard_hook",
+		"mouse_hook",
+		"hotkey_lookup",
+		"end_to_end",
+	};
+
+	LONGLONG queryFrequency()
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		return frequency.QuadPart;
+	}
+}
+
+constexpr int LatencyHistogram::BUCKET_COUNT;
+
+std::atomic<bool> LatencyMonitor::isEnabled_(false);
+LatencyHistogram LatencyMonitor::histograms_[LATENCY_PROBE_COUNT];
+LONGLONG LatencyMonitor::frequency_ = queryFrequency();
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+void LatencyHistogram::record(const uint64_t microseconds)
+{
+	int index = 0;
+	for (uint64_t rest = microseconds; rest != 0 && index < BUCKET_COUNT - 1; rest >>= 1) {
+		index++;
+	}
+
+	buckets_[index].fetch_add(1, std::memory_order_relaxed);
+	count_.fetch_add(1, std::memory_order_relaxed);
+	totalMicroseconds_.fetch_add(microseconds, std::memory_order_relaxed);
+
+	uint64_t max = maxMicroseconds_.load(std::memory_order_relaxed);
+	while (microseconds > max && !maxMicroseconds_.compare_exchange_weak(max, microseconds, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset()
+{
+	for (std::atomic<uint32_t>& bucket : buckets_) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+
+	count_.store(0, std::memory_order_relaxed);
+	totalMicroseconds_.store(0, std::memory_order_relaxed);
+	maxMicroseconds_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(const double fraction) const
+{
+	// Sum the buckets instead of using count_, they may be a few events apart while recording
+	uint64_t total = 0;
+	for (int i = 0; i < BUCKET_COUNT; i++) {
+		total += bucket(i);
+	}
+
+	const uint64_t target = (uint64_t)(fraction * (double)total + 0.5);
+	uint64_t cumulative = 0;
+
+	for (int i = 0; i < BUCKET_COUNT - 1; i++)
+	{
+		cumulative += bucket(i);
+		if (cumulative >= target && cumulative != 0) return bucketUpperBound(i);
+	}
+
+	return maxMicroseconds();
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(const int index)
+{
+	return index == 0 ? 0 : 1ull << (index - 1);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(const int index)
+{
+	return index == BUCKET_COUNT - 1 ? UINT64_MAX : 1ull << index;
+}
+
+void LatencyMonitor::setEnabled(const bool isEnabled)
+{
+	if (isEnabled && !isEnabled_.load())
+	{
+		for (LatencyHistogram& histogram : histograms_) {
+			histogram.reset();
+		}
+	}
+
+	isEnabled_.store(isEnabled);
+}
+
+LONGLONG LatencyMonitor::now()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+void LatencyMonitor::record(const LatencyProbe probe, const LONGLONG startTicks)
+{
+	if (!isEnabled()) return;
+
+	const LONGLONG ticks = now() - startTicks;
+	if (ticks < 0) return;
+
+	histograms_[probe].record((uint64_t)ticks * 1000000 / (uint64_t)frequency_);
+}
+
+std::wstring LatencyMonitor::summary()
+{
+	std::wstring text;
+
+	for (int probe = 0; probe < LATENCY_PROBE_COUNT; probe++)
+	{
+		const LatencyHistogram& histogram = histograms_[probe];
+		const uint64_t count = histogram.count();
+
+		text += probeTitles[probe];
+
+		if (count == 0) {
+			text += L": no events\n";
+			continue;
+		}
+
+		text += L": " + std::to_wstring(count) + L" events, mean " + std::to_wstring(histogram.totalMicroseconds() / count) + L" \u00B5s"
+			+ L", 50% < " + std::to_wstring(histogram.percentile(0.5)) + L" \u00B5s"
+			+ L", 99% < " + std::to_wstring(histogram.percentile(0.99)) + L" \u00B5s"
+			+ L", max " + std::to_wstring(histogram.maxMicroseconds()) + L" \u00B5s\n";
+	}
+
+	return text;
+}
+
+bool LatencyMonitor::exportCsv(const std::string& fileName)
+{
+	std::string csv = "probe,lower_us,upper_us,count\n";
+
+	for (int probe = 0; probe < LATENCY_PROBE_COUNT; probe++)
+	{
+		for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; i++)
+		{
+			const uint32_t count = histograms_[probe].bucket(i);
+			if (count == 0) continue;
+
+			// The last bucket has no upper end
+			const uint64_t upperBound = LatencyHistogram::bucketUpperBound(i);
+
+			csv += probeCsvNames[probe];
+			csv += ',' + std::to_string(LatencyHistogram::bucketLowerBound(i));
+			csv += ',' + (upperBound == UINT64_MAX ? std::string() : std::to_string(upperBound));
+			csv += ',' + std::to_string(count) + '\n';
+		}
+	}
+
+	return writeFileAtomically(fileName, csv);
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "Globals.h"
+
+// The points of the input path that are timed
+enum LatencyProbe : byte
+{
+	LATENCY_KEYBOARD_HOOK, // a whole kbHook call
+	LATENCY_MOUSE_HOOK, // a whole mouseHook call
+	LATENCY_HOTKEY_LOOKUP, // HotkeyManager::keyDown, from the key to the queued action
+	LATENCY_END_TO_END, // from the hook queueing a hotkey action to MainWindow handling it
+	LATENCY_PROBE_COUNT
+};
+
+// Distribution of durations in power of two microsecond buckets.
+// Recording is lock-free and wait-free apart from the maximum, so it's safe from hook procedures.
+class LatencyHistogram
+{
+public:
+	// Bucket 0 holds durations under 1 microsecond, bucket i holds [2^(i-1), 2^i) microseconds, the last one everything longer
+	static constexpr int BUCKET_COUNT = 32;
+
+private:
+	std::atomic<uint32_t> buckets_[BUCKET_COUNT];
+	std::atomic<uint64_t> count_;
+	std::atomic<uint64_t> totalMicroseconds_;
+	std::atomic<uint64_t> maxMicroseconds_;
+
+public:
+	LatencyHistogram();
+
+	// Prevent copying of the counters
+
+	LatencyHistogram(const LatencyHistogram& other) = delete;
+
+	LatencyHistogram& operator=(const LatencyHistogram& other) = delete;
+
+	/**
+	@brief Add a duration to the distribution.
+
+	@param microseconds The duration to add.
+	*/
+	void record(uint64_t microseconds);
+
+	/**
+	@brief Empty the distribution. Durations recorded at the same time may be lost.
+	*/
+	void reset();
+
+	/**
+	@param fraction The share of durations at or below the result, e.g. 0.99 for the 99th percentile.
+
+	@return The upper end of the bucket the percentile falls into, in microseconds.
+	*/
+	uint64_t percentile(double fraction) const;
+
+	// Getters
+	uint32_t bucket(int index) const { return buckets_[index].load(std::memory_order_relaxed); }
+	uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+	uint64_t totalMicroseconds() const { return totalMicroseconds_.load(std::memory_order_relaxed); }
+	uint64_t maxMicroseconds() const { return maxMicroseconds_.load(std::memory_order_relaxed); }
+
+	/**
+	@return The lower end of a bucket in microseconds.
+	*/
+	static uint64_t bucketLowerBound(int index);
+
+	/**
+	@return The upper end of a bucket in microseconds, the last bucket has none and returns UINT64_MAX.
+	*/
+	static uint64_t bucketUpperBound(int index);
+};
+
+// Times the input path so we can tell how close the hooks get to Windows' LowLevelHooksTimeout.
+// Off by default, while it's off a probe costs a single relaxed load.
+class LatencyMonitor
+{
+private:
+	static std::atomic<bool> isEnabled_;
+	static LatencyHistogram histograms_[LATENCY_PROBE_COUNT];
+	static LONGLONG frequency_; // QueryPerformanceCounter ticks per second
+
+public:
+	/**
+	@return Wether the probes are recording.
+	*/
+	static bool isEnabled() { return isEnabled_.load(std::memory_order_relaxed); }
+
+	/**
+	@brief Turn the probes on or off. Turning them on starts over with empty histograms.
+	*/
+	static void setEnabled(bool isEnabled);
+
+	/**
+	@return The current QueryPerformanceCounter ticks.
+	*/
+	static LONGLONG now();
+
+	/**
+	@brief Record the time that passed since startTicks. Does nothing while the monitor is off.
+
+	@param probe The point of the input path that was timed.
+
+	@param startTicks The QueryPerformanceCounter ticks of when the timed span started.
+	*/
+	static void record(LatencyProbe probe, LONGLONG startTicks);
+
+	/**
+	@return A few lines describing every probe, for showing to the user.
+	*/
+	static std::wstring summary();
+
+	/**
+	@brief Write the histograms of every probe as CSV, one row per non empty bucket.
+
+	@param fileName The file to write.
+
+	@return Wether the file was written.
+	*/
+	static bool exportCsv(const std::string& fileName);
+};
+
+// Times the scope it's declared in into a probe
+class LatencyScope
+{
+private:
+	LatencyProbe probe_;
+	LONGLONG startTicks_;
+
+public:
+	explicit LatencyScope(const LatencyProbe probe)
+		: probe_(probe), startTicks_(LatencyMonitor::isEnabled() ? LatencyMonitor::now() : 0)
+	{
+	}
+
+	~LatencyScope()
+	{
+		if (startTicks_ != 0) LatencyMonitor::record(probe_, startTicks_);
+	}
+
+	// Prevent copying, which would record the span twice
+
+	LatencyScope(const LatencyScope& other) = delete;
+
+	LatencyScope& operator=(const LatencyScope& other) = delete;
+};
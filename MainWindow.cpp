@@ -1,144 +1,27 @@
 #include "MainWindow.h"
 #include <windowsx.h>
+#include "ActionRegistry.h"
 #include "Globals.h"
 #include "HotkeyManager.h"
+#include "InputQueue.h"
+#include "LatencyMonitor.h"
 #include "ResourceUtils.h"
+#include "SettingsCache.h"
 #include "SettingsUtils.h"
 #include "Program.h"
 
 
-MainWindow::MainWindow() = default;
-
-MainWindow::~MainWindow() {
-	discardGraphicsResources();
-}
-
-HRESULT MainWindow::createGraphicsResources()
-{
-	HRESULT hr = S_OK;
-
-	// Set up render target and brush
-	if (pRenderTarget_ == nullptr)
-	{
-		RECT rc;
-		GetClientRect(hwnd_, &rc);
-
-		const D2D1_SIZE_U size = D2D1::SizeU(rc.right, rc.bottom);
-
-		const D2D1_RENDER_TARGET_PROPERTIES rtProperties = D2D1::RenderTargetProperties(
-			D2D1_RENDER_TARGET_TYPE_DEFAULT,
-			D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_IGNORE),
-			96.0f, 96.0f,
-			D2D1_RENDER_TARGET_USAGE_NONE,
-			D2D1_FEATURE_LEVEL_DEFAULT
-		);
-
-		hr = pFactory_->CreateHwndRenderTarget(
-			rtProperties,
-			D2D1::HwndRenderTargetProperties(hwnd_, size),
-			&pRenderTarget_
-		);
-
-		if (SUCCEEDED(hr)) {
-			// Extract ColorF from HBRUSH
-			const SettingsStruct settings = getSafeSettingsStruct();
-
-			const D2D1_COLOR_F timerColor = hBrushToColorf(hBrushes[settings.colors.timerColor]);
-			const D2D1_COLOR_F selectedTimerColor = hBrushToColorf(hBrushes[settings.colors.selectedTimerColor]);
-			const D2D1_COLOR_F lastSecondsColor = hBrushToColorf(hBrushes[settings.colors.lastSecondsColor]);
-			backgroundColor_ = hBrushToColorf(hBrushes[settings.colors.backgroundColor]);
-
-			// timer color brush
-			hr = pRenderTarget_->CreateSolidColorBrush(timerColor, &pBrushTimer_);
-
-			// selected timer color brush
-			hr = pRenderTarget_->CreateSolidColorBrush(selectedTimerColor, &pBrushSelectedTimer_);
-
-			// last seconds color brush
-			hr = pRenderTarget_->CreateSolidColorBrush(lastSecondsColor, &pBrushLastSeconds_);
-		}
-	}
-
-	return hr;
-}
-
-HRESULT MainWindow::createDeviceIndependentResources()
+MainWindow::MainWindow()
 {
-	HRESULT hr = S_OK;
-	// Set up write factory
-	if (pWriteFactory_ == nullptr)
-	{
-		if (pWriteFactory_ == nullptr) {
-			hr = DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(pWriteFactory_)
-				, reinterpret_cast<IUnknown**>(&pWriteFactory_));
-		}
-
-		if (SUCCEEDED(hr) && pTextFormat_ == nullptr)
-		{
-			// Set up text format
-			static constexpr WCHAR fontName[] = L"Sitka";
-			static constexpr int fontSize = 34;
-
-			hr = pWriteFactory_->CreateTextFormat(
-				fontName,
-				nullptr,
-				DWRITE_FONT_WEIGHT_BOLD,
-				DWRITE_FONT_STYLE_NORMAL,
-				DWRITE_FONT_STRETCH_EXTRA_EXPANDED,
-				fontSize,
-				L"",
-				&pTextFormat_
-			);
-
-			if (SUCCEEDED(hr))
-			{
-				// Center the text horizontally and vertically.
-				hr = pTextFormat_->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
-
-				if (SUCCEEDED(hr))
-				{
-					hr = pTextFormat_->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_FAR);
-				}
-			}
-		}
-	}
-
-	return hr;
+	registerActions();
 }
 
-HRESULT MainWindow::changeFontSize(const float fontSize)
-{
-	safeRelease(&pTextFormat_);
-
-	static constexpr WCHAR fontName[] = L"Sitka";
-
-	HRESULT hr = pWriteFactory_->CreateTextFormat(
-		fontName,
-		nullptr,
-		DWRITE_FONT_WEIGHT_BOLD,
-		DWRITE_FONT_STYLE_NORMAL,
-		DWRITE_FONT_STRETCH_EXTRA_EXPANDED,
-		fontSize,
-		L"",
-		&pTextFormat_
-	);
-
-	if (SUCCEEDED(hr))
-	{
-		// Center the text horizontally and vertically.
-		hr = pTextFormat_->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pTextFormat_->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_FAR);
-		}
-	}
-
-	return hr;
-}
+MainWindow::~MainWindow() = default;
 
 float MainWindow::getLargestFontsizeFit() const
 {
+	IDWriteFactory* pWriteFactory = graphics_.writeFactory();
+	IDWriteTextFormat* pTextFormat = graphics_.textFormat();
 	IDWriteTextFormat* pTempTextFormat;
 	IDWriteTextLayout* pTempTextLayout;
 
@@ -151,12 +34,12 @@ float MainWindow::getLargestFontsizeFit() const
 	// Iterate through options untill the largest possible font size is found
 	while (!conditionMet)
 	{
-		HRESULT hr = pWriteFactory_->CreateTextFormat(
+		HRESULT hr = pWriteFactory->CreateTextFormat(
 			fontFamily,
 			nullptr,
-			pTextFormat_->GetFontWeight(),
-			pTextFormat_->GetFontStyle(),
-			pTextFormat_->GetFontStretch(),
+			pTextFormat->GetFontWeight(),
+			pTextFormat->GetFontStyle(),
+			pTextFormat->GetFontStretch(),
 			maxSize,
 			L"",
 			&pTempTextFormat
@@ -166,7 +49,7 @@ float MainWindow::getLargestFontsizeFit() const
 			exitApp();
 		}
 
-		hr = pWriteFactory_->CreateTextLayout(
+		hr = pWriteFactory->CreateTextLayout(
 			text,
 			(UINT32)wcslen(text),
 			pTempTextFormat,
@@ -204,23 +87,6 @@ float MainWindow::getLargestFontsizeFit() const
 	return maxSize;
 }
 
-void MainWindow::discardGraphicsResources()
-{
-	safeRelease(&pFactory_);
-	safeRelease(&pRenderTarget_);
-	safeRelease(&pBrushTimer_);
-	safeRelease(&pBrushSelectedTimer_);
-	safeRelease(&pBrushLastSeconds_);
-	safeRelease(&pWriteFactory_);
-	safeRelease(&pTextFormat_);
-}
-
-HRESULT MainWindow::adjustRendertargetSize() const
-{
-	const D2D1_SIZE_U newSize = D2D1::SizeU(winSize_[0], winSize_[1]);
-	return pRenderTarget_->Resize(newSize);
-}
-
 MousePos MainWindow::getMouseDir(const LPARAM lParam, const RECT windowPos) const {
 	const int currPos[2] = { GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
 	const int width = windowPos.right - windowPos.left;
@@ -270,21 +136,36 @@ void MainWindow::handlePainting()
 {
 	PAINTSTRUCT ps;
 	BeginPaint(hwnd_, &ps);
-	pRenderTarget_->BeginDraw();
+
+	// Device resources are (re)created here, skip the frame if the device isn't available yet
+	if (FAILED(graphics_.beginFrame()))
+	{
+		EndPaint(hwnd_, &ps);
+		return;
+	}
+
+	ID2D1HwndRenderTarget* pRenderTarget = graphics_.renderTarget();
+	IDWriteTextFormat* pTextFormat = graphics_.textFormat();
+	ID2D1SolidColorBrush* pBrushTimer = graphics_.brushTimer();
+	ID2D1SolidColorBrush* pBrushSelectedTimer = graphics_.brushSelectedTimer();
+
+	const SettingsReadScope readScope;
 
 	// workaround to visible edges issue while transparent
-	if (appSettings.optionTransparent) {
-		pRenderTarget_->Clear(D2D1::ColorF(0, 0, 0));
+	if (SettingsCache::get().optionTransparent) {
+		pRenderTarget->Clear(D2D1::ColorF(0, 0, 0));
 	}
 	else {
-		pRenderTarget_->Clear(backgroundColor_);
+		pRenderTarget->Clear(graphics_.backgroundColor());
 	}
 
 	const D2D1_RECT_F rect1 = D2D1::RectF(0, 0, winSize_[0] / 2, winSize_[1]);
 	const D2D1_RECT_F rect2 = D2D1::RectF(winSize_[0] / 2, 0, winSize_[0], winSize_[1]);
 
-	if (pWriteFactory_ != nullptr)
+	if (pTextFormat != nullptr)
 	{
+		std::lock_guard<std::mutex> lock(timersMutex_);
+
 		if (activeTimer_ != nullptr)
 		{
 			// Select color for timer 2
@@ -294,37 +175,34 @@ void MainWindow::handlePainting()
 				&& (timer2.getTimerState() == TimerState::Running || timer2.getTimerState() == TimerState::Paused)
 				&& timer1.getTimeInMillis() - timer2.getTimeInMillis() > 0)
 			{
-				pBrushTimer_2 = pBrushLastSeconds_;
+				pBrushTimer_2 = graphics_.brushLastSeconds();
 			}
 			else if (activeTimer_ == &timer2) {
-				pBrushTimer_2 = pBrushSelectedTimer_;
+				pBrushTimer_2 = pBrushSelectedTimer;
 			}
 			else {
-				pBrushTimer_2 = pBrushTimer_;
+				pBrushTimer_2 = pBrushTimer;
 			}
 
 			// draw timers
 			if (activeTimer_ == &timer1) {
-				timer1.draw(pRenderTarget_, pTextFormat_, rect1, pBrushSelectedTimer_);
+				timer1.draw(pRenderTarget, pTextFormat, rect1, pBrushSelectedTimer);
 			}
 			else {
-				timer1.draw(pRenderTarget_, pTextFormat_, rect1, pBrushTimer_);
+				timer1.draw(pRenderTarget, pTextFormat, rect1, pBrushTimer);
 			}
-			timer2.draw(pRenderTarget_, pTextFormat_, rect2, pBrushTimer_2);
+			timer2.draw(pRenderTarget, pTextFormat, rect2, pBrushTimer_2);
 		}
 		else
 		{
-			timer1.draw(pRenderTarget_, pTextFormat_, rect1, pBrushTimer_);
-			timer2.draw(pRenderTarget_, pTextFormat_, rect2, pBrushTimer_);
+			timer1.draw(pRenderTarget, pTextFormat, rect1, pBrushTimer);
+			timer2.draw(pRenderTarget, pTextFormat, rect2, pBrushTimer);
 		}
 	}
 
-	const HRESULT hr = pRenderTarget_->EndDraw();
+	// On device loss only the device dependent resources are released, they are restored on the next frame
+	graphics_.endFrame();
 
-	if (FAILED(hr) || hr == D2DERR_RECREATE_TARGET)
-	{
-		discardGraphicsResources();
-	}
 	EndPaint(hwnd_, &ps);
 }
 
@@ -441,33 +319,11 @@ void MainWindow::handleMouseMovement(const LPARAM lParam) const {
 	}
 }
 
-D2D1_COLOR_F MainWindow::hBrushToColorf(const HBRUSH hBrush) {
-	LOGBRUSH logBrush;
-
-	// timer color
-	GetObject(hBrush, sizeof(LOGBRUSH), &logBrush);
-	const COLORREF color = logBrush.lbColor; // Extract COLORREF
-	return D2D1::ColorF(GetRValue(color) / 255.0f, GetGValue(color) / 255.0f, GetBValue(color) / 255.0f);
-}
-
 void MainWindow::refreshBrushes()
 {
 	// retrieve brushes colors
-	const SettingsStruct settings = getSafeSettingsStruct();
-
-	LOGBRUSH logBrush;
-
-	// timer color
-	pBrushTimer_->SetColor(hBrushToColorf(hBrushes[settings.colors.timerColor]));
-
-	// selected timer color
-	pBrushSelectedTimer_->SetColor(hBrushToColorf(hBrushes[settings.colors.selectedTimerColor]));
-
-	// last seconds color
-	pBrushLastSeconds_->SetColor(hBrushToColorf(hBrushes[settings.colors.lastSecondsColor]));
-
-	// background color
-	backgroundColor_ = hBrushToColorf(hBrushes[settings.colors.backgroundColor]);
+	const SettingsReadScope readScope;
+	graphics_.setColors(SettingsCache::get().colors);
 }
 
 LRESULT MainWindow::handleMessage(const UINT wMsg, const WPARAM wParam, const LPARAM lParam)
@@ -481,13 +337,12 @@ LRESULT MainWindow::handleMessage(const UINT wMsg, const WPARAM wParam, const LP
 		{
 		case WM_CREATE:
 		{
-			if (FAILED(D2D1CreateFactory(D2D1_FACTORY_TYPE_MULTI_THREADED, &pFactory_))) {
+			const SettingsReadScope readScope;
+			if (FAILED(graphics_.createDeviceIndependentResources(hwnd_, SettingsCache::get().colors))) {
 				return -1;
 			}
-			createGraphicsResources();
-			createDeviceIndependentResources();
+			graphics_.createDeviceResources();
 
-			appSettings = getSafeSettingsStruct();
 			appRunning = true;
 			return 0;
 		}
@@ -535,13 +390,13 @@ LRESULT MainWindow::handleMessage(const UINT wMsg, const WPARAM wParam, const LP
 			// update winSize_ var after isResizing_
 			if (windowPos.right - windowPos.left != winSize_[0]) {
 				winSize_[0] = windowPos.right - windowPos.left;
-				adjustRendertargetSize();
-				changeFontSize(getLargestFontsizeFit());
+				graphics_.resize(winSize_[0], winSize_[1]);
+				graphics_.setFontSize(getLargestFontsizeFit());
 			}
 			if (windowPos.bottom - windowPos.top != winSize_[1]) {
 				winSize_[1] = windowPos.bottom - windowPos.top;
-				adjustRendertargetSize();
-				changeFontSize(getLargestFontsizeFit());
+				graphics_.resize(winSize_[0], winSize_[1]);
+				graphics_.setFontSize(getLargestFontsizeFit());
 			}
 			return 0;
 		}
@@ -598,15 +453,16 @@ LRESULT MainWindow::handleMessage(const UINT wMsg, const WPARAM wParam, const LP
 		case REFRESH_BRUSHES:
 			refreshBrushes();
 			break;
-		case HOTKEY_HIT:
+		case INPUT_EVENTS:
+			handleInputEvents();
+			break;
+		case SETTINGS_CHANGED:
 		{
-			const int key = (int)wParam;
-			handleHotKey(key);
+			// Posted by the settings file watcher, which hands over ownership of the struct
+			const std::unique_ptr<SettingsStruct> pSettings(reinterpret_cast<SettingsStruct*>(lParam));
+			applyChangedSettings(*pSettings);
 		}
 			break;
-		case CONTROLLER_INPUT:
-			handleControllerInput(wParam);
-			break;
 		default:
 			break;
 		}
@@ -619,50 +475,101 @@ LRESULT MainWindow::handleMessage(const UINT wMsg, const WPARAM wParam, const LP
 	return DefWindowProc(window(), wMsg, wParam, lParam);
 }
 
-void MainWindow::handleHotKey(const int code)
+void MainWindow::registerActions()
 {
-	bool isActivateTimer = appSettings.optionStartOnChange;
+	ActionRegistry::registerAction(KEY_START, "start", [this](const uint32_t time) {
+		changeTimers(time, [this, time]() { startStopResetTimer(time); });
+	});
+	ActionRegistry::registerAction(KEY_TIMER1, "timer1", [this](const uint32_t time) {
+		changeTimers(time, [this, time]() { selectTimer(&timer1, time); });
+	});
+	ActionRegistry::registerAction(KEY_TIMER2, "timer2", [this](const uint32_t time) {
+		changeTimers(time, [this, time]() { selectTimer(&timer2, time); });
+	});
+	ActionRegistry::registerAction(KEY_START_NO_RESET, "startNoReset", [this](const uint32_t time) {
+		changeTimers(time, [this, time]() {
+			startStopTimer(time);
+
+			if (SettingsCache::get().optionStartOnChange) {
+				startStopResetTimer(time);
+			}
+		});
+	});
+	ActionRegistry::registerAction(KEY_NEXT_PROFILE, "nextProfile", [](uint32_t) { HotkeyManager::nextProfile(); });
+	ActionRegistry::registerAction(KEY_UNDO, "undo", [this](const uint32_t time) { undo(time); });
+	ActionRegistry::registerAction(KEY_REDO, "redo", [this](const uint32_t time) { redo(time); });
+}
 
-	switch (code)
-	{
-	case KEY_TIMER1: // timer1 key
-		activeTimer_ = &timer1;
-		break;
-	case KEY_TIMER2: // timer2 key
-		activeTimer_ = &timer2;
-		break;
-	case KEY_START: // start key
-		isActivateTimer = true;
-		break;
-	case KEY_START_NO_RESET: // start no reset key
-	{
-		if (activeTimer_ == nullptr) return;
+void MainWindow::selectTimer(Timer* pTimer, const uint32_t time)
+{
+	activeTimer_ = pTimer;
 
-		if (activeTimer_->getTimerState() == TimerState::Running)
-			activeTimer_->stopTimer();
-		else
-			activeTimer_->startTimer();
-	}
-		break;
-	default:
-		break;
+	const SettingsReadScope readScope;
+	if (SettingsCache::get().optionStartOnChange) {
+		startStopResetTimer(time);
 	}
+}
 
-	if (isActivateTimer && activeTimer_ != nullptr)
-	{
-		if (activeTimer_->getTimerState() == TimerState::Zero) {
-			activeTimer_->startTimer();
-		}
-		else if (activeTimer_->getTimerState() == TimerState::Running) {
-			activeTimer_->stopTimer();
-		}
-		else {
-			activeTimer_->resetTimer();
-		}
+void MainWindow::startStopResetTimer(const uint32_t time)
+{
+	if (activeTimer_ == nullptr) return;
+
+	if (activeTimer_->getTimerState() == TimerState::Zero) {
+		activeTimer_->startTimer(time);
+	}
+	else if (activeTimer_->getTimerState() == TimerState::Running) {
+		activeTimer_->stopTimer(time);
+	}
+	else {
+		activeTimer_->resetTimer();
 	}
 }
 
-void MainWindow::handleControllerInput(const WORD buttons) const
+void MainWindow::startStopTimer(const uint32_t time)
+{
+	if (activeTimer_ == nullptr) return;
+
+	if (activeTimer_->getTimerState() == TimerState::Running)
+		activeTimer_->stopTimer(time);
+	else
+		activeTimer_->startTimer(time);
+}
+
+TimersSnapshot MainWindow::takeSnapshot(const uint32_t time) const
+{
+	return { timer1.snapshot(time), timer2.snapshot(time), (uint8_t)(activeTimer_ == &timer2 ? 2 : 1) };
+}
+
+void MainWindow::restoreSnapshot(const TimersSnapshot& snapshot, const uint32_t time)
+{
+	timer1.restore(snapshot.timer1, time);
+	timer2.restore(snapshot.timer2, time);
+	activeTimer_ = snapshot.activeTimer == 2 ? &timer2 : &timer1;
+}
+
+void MainWindow::undo(const uint32_t time)
+{
+	std::lock_guard<std::mutex> lock(timersMutex_);
+
+	// Swapped for the current state, which is what a redo comes back to
+	TimersSnapshot state = takeSnapshot(time);
+	if (undoHistory_.undo(state)) restoreSnapshot(state, time);
+}
+
+void MainWindow::redo(const uint32_t time)
+{
+	std::lock_guard<std::mutex> lock(timersMutex_);
+
+	TimersSnapshot state = takeSnapshot(time);
+	if (undoHistory_.redo(state)) restoreSnapshot(state, time);
+}
+
+void MainWindow::handleHotKey(const int code, const uint32_t time)
+{
+	ActionRegistry::execute(code, time);
+}
+
+void MainWindow::handleControllerInput(const WORD buttons, const uint32_t time)
 {
 	if (pSettingsWindow->window() != nullptr)
 	{
@@ -670,7 +577,42 @@ void MainWindow::handleControllerInput(const WORD buttons) const
 		return;
 	}
 
-	HotkeyManager::execute(buttons);
+	const HotkeyReadScope readScope;
+	const signed char* pActions = HotkeyManager::findActions(buttons);
+	if (pActions == nullptr) return;
+
+	for (int i = 0; i < HotkeyTable::MAX_ACTIONS_PER_KEY && pActions[i] != HotkeyManager::NO_ACTION; i++) {
+		handleHotKey(pActions[i], time);
+	}
+}
+
+void MainWindow::handleInputEvents()
+{
+	InputQueue::beginDrain();
+
+	InputEvent event;
+	bool isHotkey;
+
+	while (InputQueue::pop(event, isHotkey))
+	{
+		if (isHotkey) {
+			handleHotKey(event.code, event.inputTime);
+
+			// The event's time was taken by the hook that queued it
+			LatencyMonitor::record(LATENCY_END_TO_END, event.time);
+		}
+		else {
+			handleControllerInput((WORD)event.code, event.inputTime);
+		}
+	}
+}
+
+void MainWindow::updateTimers(const uint32_t time)
+{
+	std::lock_guard<std::mutex> lock(timersMutex_);
+
+	timer1.updateTime(time);
+	timer2.updateTime(time);
 }
 
 void MainWindow::draw() {
@@ -1,7 +1,10 @@
 #pragma once
 #include <d2d1.h>
 #include <dwrite.h>
+#include <mutex>
 #include "BaseWindow.h"
+#include "GraphicsResourceManager.h"
+#include "SnapshotRing.h"
 #include "Timer.h"
 #include "SettingsWindow.h"
 
@@ -18,106 +21,148 @@ enum MousePos : uint8_t
 	None
 };
 
+// The state of both timers and the selection, what an undo puts back
+struct TimersSnapshot
+{
+	TimerSnapshot timer1;
+	TimerSnapshot timer2;
+	uint8_t activeTimer; // 1 or 2
+
+	bool operator==(const TimersSnapshot& other) const { return timer1 == other.timer1 && timer2 == other.timer2 && activeTimer == other.activeTimer; }
+	bool operator!=(const TimersSnapshot& other) const { return !(*this == other); }
+};
+
 // The class responsible for the main window of the app
 class MainWindow : public BaseWindow<MainWindow>
 {
 private:
 	// Resources
-	ID2D1Factory* pFactory_;
-	ID2D1HwndRenderTarget* pRenderTarget_;
-	ID2D1SolidColorBrush* pBrushTimer_;
-	ID2D1SolidColorBrush* pBrushSelectedTimer_;
-	ID2D1SolidColorBrush* pBrushLastSeconds_;
-	D2D1_COLOR_F backgroundColor_;
-	
-	// Writing Resources
-	IDWriteFactory* pWriteFactory_;
-	IDWriteTextFormat* pTextFormat_;
+	GraphicsResourceManager graphics_;
 
 	// Fields
 	Timer* activeTimer_ = &timer1;
+
+	// Guards the timers and the active timer, the app loop updates and draws them while input is handled on the window's thread
+	std::mutex timersMutex_;
 	BOOL mouseDown_ = false;
 	int clickMousePos_[2] = { 0, 0 };
 	bool isResizing_ = false;
 	int dir_ = -1;
 	int spaceOffset_ = 8;
+
+	// The timer actions that can be undone, the last 32 of them
+	static constexpr size_t UNDO_DEPTH = 32;
+	SnapshotRing<TimersSnapshot, UNDO_DEPTH> undoHistory_;
 	
 	/**
-	@brief Creates the graphic resources for the main window.
-
-	@return HRESULT representing the success of the operation.
+	@return The largest font size that can fit the window in it's current proportions.
 	*/
-	HRESULT createGraphicsResources();
+	float getLargestFontsizeFit() const;
 
 	/**
-	@brief Creates the device independent resources for the main window.
+	@brief Get the MousePos enum value of the mouse's direction.
+
+	@param lParam Contains information on the mouse's state. Should be forwarded from a message handler.
+
+	@param windowPos A RECT representing the main window's current proportions.
 
-	@return HRESULT representing the success of the operation.
+	@return The MousePos enum value of the mouse's direction.
 	*/
-	HRESULT createDeviceIndependentResources();
+	MousePos getMouseDir(LPARAM lParam, RECT windowPos) const;
 
 	/**
-	@brief Set a new font size for the timers.
+	@brief The method responsible for drawing to the main window and invoking the timer to draw to it aswell.
+	*/
+	void handlePainting();
+
+	/**
+	@brief Handles mouse movements, including changing the cursor according to it's position in the window, 
+	and detecting clicks to apply resize logic.
 
-	@return HRESULT representing the success of the operation.
+	@param lParam Contains information on the mouse's state and position. 
+	This argument should be forwarded to this function by the message handler.
 	*/
-	HRESULT changeFontSize(float fontSize);
+	void handleMouseMovement(LPARAM lParam) const;
 
 	/**
-	@return The largest font size that can fit the window in it's current proportions.
+	@brief Retrieve and apply the colors from the settings cache to the timer brushes.
 	*/
-	float getLargestFontsizeFit() const;
+	void refreshBrushes();
 
 	/**
-	@brief Dispose of graphic resources.
+	@brief Register the timer actions in the ActionRegistry, under their KEY_ ids.
 	*/
-	void discardGraphicsResources();
+	void registerActions();
 
 	/**
-	@brief Adjust the render target's size after the window has been resized.
+	@brief Make a timer the one the hotkeys act on, and start, stop or reset it if the start on change option is on.
+
+	@param pTimer The timer to select.
 
-	@return HRESULT representing the success of the operation.
+	@param time The AppClock time of the input.
 	*/
-	HRESULT adjustRendertargetSize() const;
+	void selectTimer(Timer* pTimer, uint32_t time);
 
 	/**
-	@brief Get the MousePos enum value of the mouse's direction.
+	@brief Start the selected timer from zero, stop it while it's running, or reset it once it's stopped.
 
-	@param lParam Contains information on the mouse's state. Should be forwarded from a message handler.
+	@param time The AppClock time of the input.
+	*/
+	void startStopResetTimer(uint32_t time);
 
-	@param windowPos A RECT representing the main window's current proportions.
+	/**
+	@brief Start or stop the selected timer, continuing from where it stopped.
 
-	@return The MousePos enum value of the mouse's direction.
+	@param time The AppClock time of the input.
 	*/
-	MousePos getMouseDir(LPARAM lParam, RECT windowPos) const;
+	void startStopTimer(uint32_t time);
 
 	/**
-	@brief The method responsible for drawing to the main window and invoking the timer to draw to it aswell.
+	@param time The AppClock time to take the snapshot at.
+
+	@return The state of both timers and the selection at the time.
 	*/
-	void handlePainting();
+	TimersSnapshot takeSnapshot(uint32_t time) const;
 
 	/**
-	@brief Handles mouse movements, including changing the cursor according to it's position in the window, 
-	and detecting clicks to apply resize logic.
+	@brief Put both timers and the selection back in the state of a snapshot.
 
-	@param lParam Contains information on the mouse's state and position. 
-	This argument should be forwarded to this function by the message handler.
+	@param snapshot The state to put back.
+
+	@param time The current AppClock time, timers that were running count up to it.
 	*/
-	void handleMouseMovement(LPARAM lParam) const;
+	void restoreSnapshot(const TimersSnapshot& snapshot, uint32_t time);
 
 	/**
-	@brief Get the COLORF value of an HBRUSH type.
+	@brief Run a timer action, and remember the state from before it for undo if it changed anything.
 
-	@param hBrush The HBRUSH to retrieve a COLORF from.
+	@param time The AppClock time of the input.
 
-	@return D2D1_COLOR_F value of the given HBRUSH.
+	@param action The method changing the timers.
 	*/
-	static D2D1_COLOR_F hBrushToColorf(HBRUSH hBrush);
-	
+	template <class ACTION> void changeTimers(const uint32_t time, ACTION action)
+	{
+		std::lock_guard<std::mutex> lock(timersMutex_);
+
+		const TimersSnapshot before = takeSnapshot(time);
+		action();
+
+		if (takeSnapshot(time) != before) undoHistory_.push(before);
+	}
+
 	/**
-	@brief Retrieve and apply the colors from the settings file to the timer brushes.
+	@brief Take back the last timer action.
+
+	@param time The AppClock time of the input.
 	*/
-	void refreshBrushes();
+	void undo(uint32_t time);
+
+	/**
+	@brief Repeat the last timer action that was taken back.
+
+	@param time The AppClock time of the input.
+	*/
+	void redo(uint32_t time);
 
 public:
 	// Public fields
@@ -163,18 +208,45 @@ public:
 	LRESULT handleMessage(UINT wMsg, WPARAM wParam, LPARAM lParam) override;
 
 	/**
-	@brief Handle hotkey inputs from the user.
+	@return The timer the hotkeys currently act on.
+	*/
+	const Timer* getActiveTimer() const { return activeTimer_; }
+
+	/**
+	@brief Handle hotkey inputs from the user, by running the action registered under the code.
 
-	@param code The code of the hotkey that the user hit.
+	@param code The KEY_ action of the hotkey that the user hit.
+
+	@param time The AppClock time of the input, timers start and stop at it.
 	*/
-	void handleHotKey(int code);
+	void handleHotKey(int code, uint32_t time);
 
 	/**
 	@brief Handle controller button input.
 
 	@param buttons The buttons that had a state change.
+
+	@param time The AppClock time of the input.
+	*/
+	void handleControllerInput(WORD buttons, uint32_t time);
+
+	/**
+	@brief Apply every queued hotkey and controller event, in the order they arrived.
+	*/
+	void handleInputEvents();
+
+	/**
+	@brief Count both timers up to the given time. Safe to call while input is being handled on the window's thread.
+
+	@param time The current AppClock time.
 	*/
-	void handleControllerInput(WORD buttons) const;
+	void updateTimers(uint32_t time);
+
+	/**
+	@brief Fault injection hook, the next frame will behave as if the graphics device was lost.
+	*/
+	void simulateDeviceLoss() { graphics_.simulateDeviceLoss(); }
+
 	/**
 	@brief The function that is called when a WM_PAINT event is registered to the window. This method forwards the task to handlePainting().
 	*/
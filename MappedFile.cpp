@@ -0,0 +1,167 @@
+#include "MappedFile.h"
+
+#include <cstdint>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+constexpr size_t MappedFile::mapThreshold;
+
+MappedFile::~MappedFile()
+{
+	release();
+}
+
+void MappedFile::release()
+{
+	if (isMapped_)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(data_);
+#else
+		munmap(data_, size_);
+#endif
+	}
+
+	buffer_.clear();
+	buffer_.shrink_to_fit();
+	data_ = nullptr;
+	size_ = 0;
+	isMapped_ = false;
+	isWritable_ = false;
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string& fileName, const bool isCopyOnWrite)
+{
+	release();
+
+	// Sharing everything lets the file be replaced while we hold it, the view keeps the old contents
+	const HANDLE hFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (hFile == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize = {};
+	const bool isRegular = GetFileType(hFile) == FILE_TYPE_DISK && GetFileSizeEx(hFile, &fileSize);
+
+	if (isRegular && (unsigned long long)fileSize.QuadPart > SIZE_MAX)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	if (isRegular && (size_t)fileSize.QuadPart >= mapThreshold)
+	{
+		const HANDLE hMapping = CreateFileMappingA(hFile, nullptr, isCopyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+		void* pView = hMapping != nullptr ? MapViewOfFile(hMapping, isCopyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+		// The view keeps the mapping and the file alive on it's own
+		if (hMapping != nullptr) CloseHandle(hMapping);
+
+		if (pView != nullptr)
+		{
+			CloseHandle(hFile);
+
+			data_ = static_cast<char*>(pView);
+			size_ = (size_t)fileSize.QuadPart;
+			isMapped_ = true;
+			isWritable_ = isCopyOnWrite;
+			return true;
+		}
+	}
+
+	// Small or non-regular file (or the mapping failed), read it in chunks until the end
+	char chunk[4096];
+	DWORD bytesRead = 0;
+	bool isRead = true;
+
+	if (isRegular) buffer_.reserve((size_t)fileSize.QuadPart);
+
+	while ((isRead = ReadFile(hFile, chunk, sizeof(chunk), &bytesRead, nullptr) != FALSE) && bytesRead != 0)
+	{
+		buffer_.append(chunk, bytesRead);
+	}
+
+	// Pipes report their end as a broken pipe
+	isRead = isRead || GetLastError() == ERROR_BROKEN_PIPE;
+	CloseHandle(hFile);
+
+	if (!isRead)
+	{
+		release();
+		return false;
+	}
+
+	// The buffer is a copy already
+	data_ = &buffer_[0];
+	size_ = buffer_.size();
+	isWritable_ = isCopyOnWrite;
+	return true;
+}
+#else
+bool MappedFile::open(const std::string& fileName, const bool isCopyOnWrite)
+{
+	release();
+
+	const int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+
+	struct stat fileStat = {};
+	const bool isRegular = fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode);
+
+	if (isRegular && (size_t)fileStat.st_size >= mapThreshold)
+	{
+		// A private mapping of a file replaced by a rename keeps the old contents, and writes to it only copy the pages
+		const int protection = isCopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+		void* pView = mmap(nullptr, (size_t)fileStat.st_size, protection, MAP_PRIVATE, fd, 0);
+
+		if (pView != MAP_FAILED)
+		{
+			madvise(pView, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+			close(fd);
+
+			data_ = static_cast<char*>(pView);
+			size_ = (size_t)fileStat.st_size;
+			isMapped_ = true;
+			isWritable_ = isCopyOnWrite;
+			return true;
+		}
+	}
+
+	// Small or non-regular file (or the mapping failed), read it in chunks until the end
+	char chunk[4096];
+	ssize_t bytesRead;
+
+	if (isRegular) buffer_.reserve((size_t)fileStat.st_size);
+
+	while ((bytesRead = read(fd, chunk, sizeof(chunk))) != 0)
+	{
+		if (bytesRead < 0 && errno == EINTR) continue;
+
+		if (bytesRead < 0)
+		{
+			close(fd);
+			release();
+			return false;
+		}
+
+		buffer_.append(chunk, (size_t)bytesRead);
+	}
+
+	close(fd);
+
+	// The buffer is a copy already
+	data_ = &buffer_[0];
+	size_ = buffer_.size();
+	isWritable_ = isCopyOnWrite;
+	return true;
+}
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// View of a whole file's contents, read only unless opened copy-on-write.
+// Large regular files are memory mapped (file mapping on Windows, mmap on Linux) so they can be parsed in place,
+// small and non-regular files are read into a buffer, where mapping costs more than it saves.
+// A copy-on-write view can be written to, like by a parser that terminates strings in place, without touching the file.
+class MappedFile
+{
+private:
+	char* data_ = nullptr;
+	size_t size_ = 0;
+	bool isMapped_ = false;
+	bool isWritable_ = false;
+	std::string buffer_; // holds the contents when the file isn't mapped
+
+	/**
+	@brief Unmap the view or release the buffer.
+	*/
+	void release();
+
+public:
+	// Files smaller than this are read into a buffer instead of being mapped
+	static constexpr size_t mapThreshold = 64 * 1024;
+
+	MappedFile() = default;
+
+	// Prevent copying of the mapped view
+
+	MappedFile(const MappedFile& other) = delete;
+
+	MappedFile& operator=(const MappedFile& other) = delete;
+
+	~MappedFile();
+
+	/**
+	@brief Open a file and make it's contents available through data() and size().
+			Any previously opened file is released.
+
+	@param fileName The name of the file to open.
+
+	@param isCopyOnWrite Wether the view can be written to through writableData(). Only the touched pages are copied.
+
+	@return Wether the whole file could be read. The view is empty on failure.
+	*/
+	bool open(const std::string& fileName, bool isCopyOnWrite = false);
+
+	// Getters
+	const char* data() const { return data_; }
+	size_t size() const { return size_; }
+	bool isMapped() const { return isMapped_; }
+
+	// The contents, or nullptr unless the file was opened copy-on-write
+	char* writableData() { return isWritable_ ? data_ : nullptr; }
+};
@@ -2,10 +2,13 @@
 #include <d2d1.h>
 #include <string>
 #include <thread>
+#include <vector>
 #include <dwrite.h>
 #include <commctrl.h>
 #include "Globals.h"
 #include "ResourceUtils.h"
+#include "SettingsCache.h"
+#include "SettingsPersistence.h"
 #include "SettingsUtils.h"
 #include "BaseWindow.h"
 #include "Timer.h"
@@ -14,8 +17,15 @@
 #include "MainWindow.h"
 #include "Program.h"
 
+#include "AppClock.h"
 #include "ControllerManager.h"
+#include "FileWatcher.h"
+#include "HookInputBackend.h"
 #include "HotkeyManager.h"
+#include "InputQueue.h"
+#include "InputRecorder.h"
+#include "MappedFile.h"
+#include "ReplayInputBackend.h"
 
 #pragma comment(lib, "Msimg32.lib")
 #pragma comment (lib, "d2d1")
@@ -26,7 +36,6 @@
 using std::thread; using std::wstring;
 
 // Global variable assignment (defined in MainWindow.h)
-SettingsStruct appSettings;
 HBRUSH hBrushes[25];
 HWND hwndMainWindow = nullptr;
 HINSTANCE hInstanceGlobal;
@@ -37,8 +46,7 @@ void appLoop(MainWindow* win)
 	while (win->appRunning)
 	{
 		Sleep(1);
-		win->timer1.updateTime();
-		win->timer2.updateTime();
+		win->updateTimers(AppClock::now());
 		win->draw();
 	}
 }
@@ -49,70 +57,157 @@ void exitApp()
 	PostQuitMessage(0);
 }
 
-LRESULT CALLBACK mouseHook(const int nCode, const WPARAM wParam, const LPARAM lParam)
+void keyEventCallback(const KeyEvent& event)
 {
-	if (nCode >= 0)
-	{
-		const MSLLHOOKSTRUCT* pMsHookStruct = reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
-		int key = 0;
+	// Recorded before it's handled, so a replay sees exactly what the input path saw
+	InputRecorder::record(event);
 
-		switch (wParam)
-		{
-		case WM_LBUTTONDOWN:
-			key = VK_LBUTTON;
-			break;
-		case WM_RBUTTONDOWN:
-			key = VK_RBUTTON;
-			break;
-		case WM_MBUTTONDOWN:
-			key = VK_MBUTTON;
-			break;
-		case WM_XBUTTONDOWN:
-			key = HIWORD(pMsHookStruct->mouseData) == 1 ? VK_XBUTTON1 : VK_XBUTTON2;
-			break;
-		default:
-			break;
+	// Controllers only bind presses, bouncing ones are dropped before they reach the main window
+	if (event.code >= CONTROLLER_UP)
+	{
+		if (event.isDown && HotkeyManager::controllerDown(event.code, event.time)) {
+			InputQueue::pushController((WORD)event.code, event.time);
 		}
+		return;
+	}
 
-		if (key != 0)
-		{
-			HotkeyManager::execute(key);
-		}
+	if (event.isDown) {
+		HotkeyManager::keyDown(event.code, event.time);
+	}
+	else {
+		HotkeyManager::keyUp(event.code);
+	}
+}
+
+bool findArgument(const wchar_t* name, std::string& value)
+{
+	int argCount = 0;
+	LPWSTR* pArgs = CommandLineToArgvW(GetCommandLineW(), &argCount);
+	bool isFound = false;
+
+	for (int i = 1; pArgs != nullptr && i + 1 < argCount; i++)
+	{
+		if (wstring(pArgs[i]) != name) continue;
+
+		const int length = WideCharToMultiByte(CP_ACP, 0, pArgs[i + 1], -1, nullptr, 0, nullptr, nullptr);
+		value.assign(length > 0 ? length - 1 : 0, '\0');
+		WideCharToMultiByte(CP_ACP, 0, pArgs[i + 1], -1, &value[0], length, nullptr, nullptr);
+
+		isFound = true;
+		break;
 	}
 
-	return CallNextHookEx(nullptr, nCode, wParam, lParam);
+	LocalFree(pArgs);
+	return isFound;
 }
 
-LRESULT CALLBACK kbHook(const int nCode, const WPARAM wParam, const LPARAM lParam)
+std::vector<std::unique_ptr<InputBackend>> createInputBackends()
 {
-	if (
-		nCode >= 0 &&
-		wParam == WM_KEYDOWN)
+	std::vector<std::unique_ptr<InputBackend>> backends;
+
+	// "--replay <file>" plays a recording instead of listening to the devices, "--replay-fast <file>" without waiting between events
+	std::string fileName;
+	if (findArgument(L"--replay", fileName)) {
+		backends.push_back(std::make_unique<ReplayInputBackend>(fileName, true));
+	}
+	else if (findArgument(L"--replay-fast", fileName)) {
+		backends.push_back(std::make_unique<ReplayInputBackend>(fileName, false));
+	}
+	else
 	{
-		const KBDLLHOOKSTRUCT* pKbdHookStruct = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-		int hitKey = pKbdHookStruct->vkCode;
+		backends.push_back(std::make_unique<HookInputBackend>());
+		backends.push_back(std::make_unique<ControllerManager>());
+	}
 
-		// If the hit key is Alt, Control or Shift, set it to not matter if it was Right or Left.
-		if (hitKey == VK_LMENU || hitKey == VK_RMENU) {
-			hitKey = VK_MENU;
-		}
-		else if (hitKey == VK_LCONTROL || hitKey == VK_RCONTROL) {
-			hitKey = VK_CONTROL;
-		}
-		else if (hitKey == VK_LSHIFT || hitKey == VK_RSHIFT)
-		{
-			hitKey = VK_SHIFT;
-		}
-		
-		HotkeyManager::execute(hitKey);
+	return backends;
+}
+
+RecordingEnd sampleTimers(MainWindow& win, const uint32_t time)
+{
+	// Only called while the app loop isn't running, nothing else changes the timers meanwhile
+	win.updateTimers(time);
+
+	RecordingEnd end = {};
+	end.time = time;
+	end.timer1Time = win.timer1.getTimeInMillis();
+	end.timer2Time = win.timer2.getTimeInMillis();
+	end.timer1State = win.timer1.getTimerState();
+	end.timer2State = win.timer2.getTimerState();
+	end.activeTimer = win.getActiveTimer() == &win.timer2 ? 2 : 1;
+	return end;
+}
+
+int verifyRecording(MainWindow& win, const std::string& fileName)
+{
+	MappedFile file;
+	Recording recording;
+	SettingsStruct settings;
+
+	if (!file.open(fileName) || !InputRecorder::read(file.data(), file.data() + file.size(), recording)
+		|| !recording.hasEnd || !parseSettings(recording.settings, settings))
+	{
+		OutputDebugStringW(L"Replay verify: the recording couldn't be read\n");
+		return 2;
+	}
+
+	// Play with the hotkeys the recording was made with, without saving them over the user's settings
+	{
+		const SettingsReadScope readScope;
+		settings.optionClickThrough = SettingsCache::get().optionClickThrough;
+	}
+	SettingsCache::store(settings);
+	HotkeyManager::setHotkeysMap(settings);
+
+	// The clock only moves with the events, so every timer adds up the same way on every run
+	for (const KeyEvent& event : recording.events)
+	{
+		AppClock::setVirtualTime(event.time);
+		keyEventCallback(event);
+		win.handleInputEvents();
 	}
 
-	return CallNextHookEx(nullptr, nCode, wParam, lParam);
+	AppClock::setVirtualTime(recording.end.time);
+	const RecordingEnd replayed = sampleTimers(win, recording.end.time);
+	const RecordingEnd& expected = recording.end;
+
+	const bool isIdentical = expected.droppedCount == 0
+		&& replayed.timer1Time == expected.timer1Time && replayed.timer2Time == expected.timer2Time
+		&& replayed.timer1State == expected.timer1State && replayed.timer2State == expected.timer2State
+		&& replayed.activeTimer == expected.activeTimer;
+
+	const wstring result = wstring(L"Replay verify: ") + (isIdentical ? L"identical" : L"MISMATCH")
+		+ L", timer 1 " + std::to_wstring(replayed.timer1Time) + L" / " + std::to_wstring(expected.timer1Time)
+		+ L" ms, timer 2 " + std::to_wstring(replayed.timer2Time) + L" / " + std::to_wstring(expected.timer2Time)
+		+ L" ms, " + std::to_wstring(expected.droppedCount) + L" dropped events\n";
+	OutputDebugStringW(result.c_str());
+
+	return isIdentical ? 0 : 1;
 }
 
-void controllerInputCallback(const WORD buttons)
+void settingsFileChangedCallback()
 {
-	SendMessage(hwndMainWindow, CONTROLLER_INPUT ,buttons, NULL);
+	const std::string contents = readSettingsFileContents();
+
+	// Ignore the notifications caused by our own writes
+	if (SettingsPersistence::isLastWritten(contents)) return;
+
+	// The file may still be half written, the next change notification will pick it up
+	SettingsStruct settings;
+	if (!parseSettings(contents, settings)) return;
+
+	// The click through option isn't saved to the file
+	const SettingsReadScope readScope;
+	settings.optionClickThrough = SettingsCache::get().optionClickThrough;
+
+	if (diffSettings(SettingsCache::get(), settings) == SETTINGS_CHANGED_NONE) return;
+
+	SettingsPersistence::forgetLastWritten();
+
+	// The main window applies the changes on it's own thread and takes ownership of the struct
+	SettingsStruct* pSettings = new SettingsStruct(settings);
+	if (!PostMessage(hwndMainWindow, SETTINGS_CHANGED, 0, (LPARAM)pSettings)) {
+		delete pSettings;
+	}
 }
 
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdLine, int nShowCmd)
@@ -130,6 +225,9 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdLin
 			createSettingsFile();
 		}
 
+		// Load the saved settings into memory once, everything else reads the cache
+		SettingsCache::load();
+
 		// Initiate common controls lib
 		InitCommonControls();
 
@@ -156,17 +254,44 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdLin
 		pGlobalTimerWindow = &win;
 		hwndMainWindow = win.window();
 
-		// Apply saved settings
-		applySettings(appSettings);
+		// Save settings changes in the background
+		SettingsPersistence::start();
 
-		// Listen for hotkeys While Running in the background - Install a hook procedure
-		SetWindowsHookEx(WH_KEYBOARD_LL, &kbHook, nullptr, NULL);
-		SetWindowsHookEx(WH_MOUSE_LL, &mouseHook, nullptr, NULL);
+		// Apply saved settings, from a copy since applying them publishes a new snapshot
+		SettingsStruct savedSettings;
+		{
+			const SettingsReadScope readScope;
+			savedSettings = SettingsCache::get();
+		}
+		applySettings(savedSettings);
 
-		// Controller support
-		std::unique_ptr<ControllerManager> controllerManager(std::make_unique<ControllerManager>());
-		controllerManager->setInputCallback(controllerInputCallback);
-		controllerManager->start();
+		// "--replay-verify <file>" plays a recording against a virtual clock and exits with 0 if the timers end up like they did when recording
+		std::string recordingFile;
+		if (findArgument(L"--replay-verify", recordingFile))
+		{
+			const int exitCode = verifyRecording(win, recordingFile);
+			SettingsPersistence::stop();
+			return exitCode;
+		}
+
+		// "--record <file>" records every input of the session, with the settings it started with
+		if (findArgument(L"--record", recordingFile)) {
+			const SettingsReadScope readScope;
+			InputRecorder::start(recordingFile, serializeSettings(SettingsCache::get()));
+		}
+
+		// Listen for hotkeys While Running in the background - the hooks and the controller, or a recording
+		const std::vector<std::unique_ptr<InputBackend>> inputBackends = createInputBackends();
+		for (const std::unique_ptr<InputBackend>& pBackend : inputBackends)
+		{
+			pBackend->setInputCallback(keyEventCallback);
+			pBackend->start();
+		}
+
+		// Reload settings edited by other programs
+		FileWatcher settingsWatcher;
+		settingsWatcher.setChangeCallback(settingsFileChangedCallback);
+		settingsWatcher.start(SETTINGS_FILE_NAME);
 
 		// Create a thread for the app loop (ticks)
 		thread appLoopThread(appLoop, &win);
@@ -182,7 +307,12 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdLin
 		}
 
 		appLoopThread.join();
-		controllerManager->stop();
+		for (const std::unique_ptr<InputBackend>& pBackend : inputBackends) {
+			pBackend->stop();
+		}
+		InputRecorder::stop(sampleTimers(win, AppClock::now()));
+		settingsWatcher.stop();
+		SettingsPersistence::stop(); // flush pending settings
 		return 0;
 	}
 	catch (const std::exception& e)
@@ -1,4 +1,11 @@
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "InputBackend.h"
+#include "InputRecorder.h"
 #include "MainWindow.h"
 
 // Fields
@@ -15,34 +22,55 @@ extern void appLoop(MainWindow* win);
 extern void exitApp();
 
 /**
-@brief The hook procedure to listen for key strokes of the active HOTKEYS.
+@brief The input callback of every input backend. Passes key events on to the HotkeyManager and controller presses to the main window.
+
+@param event The key or button that changed.
+*/
+void keyEventCallback(const KeyEvent& event);
 
-@param nCode Has no effect in this function but is part of the syntax.
+/**
+@brief Find an option on the command line, given as "<name> <value>".
 
-@param wParam Contains the state of the hit key.
+@param name The option, e.g. L"--replay".
 
-@param lParam Contains the key that was hit.
+@param value Receives the value that follows it.
 
-@return Forwards to the next hook.
+@return Wether the option was given.
 */
-LRESULT CALLBACK kbHook(int nCode, WPARAM wParam, LPARAM lParam);
+bool findArgument(const wchar_t* name, std::string& value);
 
 /**
-@brief The hook procedure to listen for key strokes of the active HOTKEYS.
+@brief Create the input backends for the command line. The Windows hooks and the controller, or a replay of a recording.
 
-@param nCode Has no effect in this function but is part of the syntax.
+@return The backends, not started yet.
+*/
+std::vector<std::unique_ptr<InputBackend>> createInputBackends();
+
+/**
+@brief Bring the timers up to a time and take their state, for the end of a recording.
+
+@param win The main window holding the timers.
+
+@param time The AppClock time to sample at.
+
+@return The state of the timers.
+*/
+RecordingEnd sampleTimers(MainWindow& win, uint32_t time);
+
+/**
+@brief Replay a binary recording through the input path against a virtual clock, and compare the timers with the ones recorded.
+		Runs on the main thread instead of the input backends, so the outcome doesn't depend on any timing.
 
-@param wParam Contains the window message that was triggered.
+@param win The main window, before any input was handled.
 
-@param lParam A pointer to a CWPRETSTRUCT structure that contains details about the message.
+@param fileName The recording to verify.
 
-@return Forwards to the next hook.
+@return The exit code, 0 if the timers ended up identical, 1 if they didn't and 2 if the recording couldn't be read.
 */
-LRESULT CALLBACK mouseHook(int nCode, WPARAM wParam, LPARAM lParam);
+int verifyRecording(MainWindow& win, const std::string& fileName);
 
 /**
- * @brief A method to be called for controller input events.
- * 
- * @param buttons The buttons that had a state change.
+ * @brief A method to be called when the settings file was changed, possibly by another program.
+ * Parses the file and posts the changed settings to the main window. Called from the file watcher thread.
  */
-void controllerInputCallback(WORD buttons);
\ No newline at end of file
+void settingsFileChangedCallback();
\ No newline at end of file
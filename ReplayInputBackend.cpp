@@ -0,0 +1,117 @@
+#include "ReplayInputBackend.h"
+
+#include <chrono>
+#include <cstdlib>
+
+#include "AppClock.h"
+#include "InputRecorder.h"
+#include "MappedFile.h"
+
+ReplayInputBackend::ReplayInputBackend(const std::string& fileName, const bool isRealTime)
+	: fileName_(fileName), isRealTime_(isRealTime)
+{
+	isRunning_ = false;
+}
+
+ReplayInputBackend::~ReplayInputBackend()
+{
+	stop();
+}
+
+bool ReplayInputBackend::parse(const char* begin, const char* end, std::vector<KeyEvent>& events)
+{
+	events.clear();
+
+	if (InputRecorder::isRecordingFile(begin, end))
+	{
+		Recording recording;
+		const bool isRead = InputRecorder::read(begin, end, recording);
+		events = std::move(recording.events);
+		return isRead;
+	}
+
+	for (const char* pLine = begin; pLine < end;)
+	{
+		const char* pLineEnd = pLine;
+		while (pLineEnd < end && *pLineEnd != '\n') pLineEnd++;
+
+		// Copied so the numbers can't be parsed past the end of the line
+		const std::string line(pLine, pLineEnd);
+		pLine = pLineEnd + 1;
+
+		const size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#') continue;
+
+		char* pEnd = nullptr;
+		const unsigned long time = strtoul(line.c_str() + first, &pEnd, 10);
+		const char* pCode = pEnd;
+		const long code = strtol(pCode, &pEnd, 10);
+		const char* pState = pEnd;
+		const long state = strtol(pState, &pEnd, 10);
+
+		const bool isValid = pCode != line.c_str() + first && pState != pCode && pEnd != pState
+			&& code > 0 && code <= 0xFFFF && (state == 0 || state == 1)
+			&& line.find_first_not_of(" \t\r", pEnd - line.c_str()) == std::string::npos;
+
+		if (!isValid)
+		{
+			events.clear();
+			return false;
+		}
+
+		events.push_back({ (int)code, state == 1, (uint32_t)time });
+	}
+
+	return true;
+}
+
+bool ReplayInputBackend::start()
+{
+	if (isRunning_) return true;
+
+	MappedFile file;
+	if (!file.open(fileName_) || !parse(file.data(), file.data() + file.size(), events_)) return false;
+
+	isRunning_ = true;
+	replayThread_ = std::thread([this]() { replay(); });
+	return true;
+}
+
+void ReplayInputBackend::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!isRunning_) return;
+
+		isRunning_ = false;
+	}
+
+	condition_.notify_one();
+
+	if (replayThread_.joinable())
+	{
+		replayThread_.join();
+	}
+}
+
+void ReplayInputBackend::replay()
+{
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	const uint32_t timeOffset = events_.empty() ? 0 : AppClock::now() - events_.front().time;
+
+	for (const KeyEvent& event : events_)
+	{
+		if (isRealTime_)
+		{
+			// Relative to the first event, wrapped tick counts come out right and events out of order play at once
+			const std::chrono::milliseconds offset((int32_t)(event.time - events_.front().time));
+
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait_until(lock, startTime + offset, [this]() { return !isRunning_; });
+		}
+
+		if (!isRunning_) return;
+
+		inputCallback_({ event.code, event.isDown, event.time + timeOffset });
+	}
+}
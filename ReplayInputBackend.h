@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InputBackend.h"
+
+// Plays a recorded stream of key events back through the input callback, on it's own thread.
+// Recordings are either binary files written by InputRecorder, or text with one event per line:
+// "<time> <code> <1 for down, 0 for up>", with the time in milliseconds. Empty lines and lines starting with # are skipped.
+// The events are reported with their times moved to the AppClock time the replay started at, keeping the gaps between them.
+class ReplayInputBackend : public InputBackend
+{
+private:
+	std::string fileName_;
+	bool isRealTime_;
+	std::vector<KeyEvent> events_;
+	std::atomic<bool> isRunning_;
+	std::thread replayThread_;
+
+	// Lets stop() interrupt the wait for the next event
+	std::mutex mutex_;
+	std::condition_variable condition_;
+
+	/**
+	@brief The replay thread's loop. Reports every event, waiting between them when replaying in real time.
+	*/
+	void replay();
+
+public:
+	/**
+	@param fileName The recording to play.
+
+	@param isRealTime Wether to keep the original timing between events, or play them as fast as possible.
+			The events report their recorded gaps either way, so both play out the same once the clock catches up.
+	*/
+	ReplayInputBackend(const std::string& fileName, bool isRealTime);
+
+	~ReplayInputBackend() override;
+
+	/**
+	@brief Parse a recording, binary or text.
+
+	@param begin The start of the recording.
+
+	@param end One past the end of the recording.
+
+	@param events Receives the events. Left empty if the recording is malformed.
+
+	@return Wether the whole recording could be parsed.
+	*/
+	static bool parse(const char* begin, const char* end, std::vector<KeyEvent>& events);
+
+	/**
+	@brief Read the recording and start playing it.
+
+	@return Wether the recording could be read.
+	*/
+	bool start() override;
+
+	void stop() override;
+};
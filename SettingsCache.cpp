@@ -0,0 +1,49 @@
+#include "SettingsCache.h"
+
+#include "SettingsUtils.h"
+
+namespace
+{
+	const SettingsStruct defaultSettings;
+}
+
+std::atomic<const SettingsStruct*> SettingsCache::current_(&defaultSettings);
+std::mutex SettingsCache::writeMutex_;
+std::unique_ptr<const SettingsStruct> SettingsCache::snapshot_;
+std::vector<std::unique_ptr<const SettingsStruct>> SettingsCache::retiredSnapshots_;
+std::atomic<int> SettingsCache::readerCount_(0);
+
+void SettingsCache::load()
+{
+	store(getSafeSettingsStruct());
+}
+
+const SettingsStruct& SettingsCache::get()
+{
+	// Sequentially consistent, ordered after the reader's scope was counted
+	return *current_.load();
+}
+
+void SettingsCache::store(const SettingsStruct& settings)
+{
+	std::lock_guard<std::mutex> lock(writeMutex_);
+
+	if (snapshot_) {
+		retiredSnapshots_.push_back(std::move(snapshot_));
+	}
+	snapshot_ = std::make_unique<const SettingsStruct>(settings);
+
+	// Sequentially consistent, ordered before reclaimSnapshots reads the reader count
+	current_.store(snapshot_.get());
+
+	reclaimSnapshots();
+}
+
+void SettingsCache::reclaimSnapshots()
+{
+	// A reader that opens it's scope after this load reads the newly published snapshot, never a retired one.
+	// Otherwise the snapshots wait for the next store.
+	if (readerCount_.load() == 0) {
+		retiredSnapshots_.clear();
+	}
+}
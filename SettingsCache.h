@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Globals.h"
+
+// Process wide in-memory copy of the saved settings.
+// Loaded once at startup and replaced by applySettings, so the render path never has to read settings.json.
+class SettingsCache
+{
+private:
+	friend class SettingsReadScope;
+
+	static std::atomic<const SettingsStruct*> current_;
+	static std::mutex writeMutex_;
+
+	// Snapshots replaced by a newer one are retired, and freed once no SettingsReadScope is open,
+	// since every reader that could still see them opened it's scope before they were replaced.
+	static std::unique_ptr<const SettingsStruct> snapshot_;
+	static std::vector<std::unique_ptr<const SettingsStruct>> retiredSnapshots_;
+	static std::atomic<int> readerCount_;
+
+	/**
+	@brief Free the retired snapshots if no reader is in the middle of using one. Must be called with the write mutex held.
+	*/
+	static void reclaimSnapshots();
+
+public:
+	/**
+	@brief Read the settings from the settings.json file into the cache. Should be called once at startup.
+	*/
+	static void load();
+
+	/**
+	@brief Lock-free read of the current settings. Safe to call from any thread, including hook procedures.
+	Must be called inside a SettingsReadScope.
+
+	@return A reference to the current settings snapshot. The snapshot stays valid until the enclosing SettingsReadScope ends.
+	*/
+	static const SettingsStruct& get();
+
+	/**
+	@brief Publish a new settings snapshot. Readers see either the old or the new snapshot, never a mix of both.
+	Shouldn't be called inside a SettingsReadScope, the replaced snapshot couldn't be freed until the next call.
+
+	@param settings The settings to publish.
+	*/
+	static void store(const SettingsStruct& settings);
+};
+
+// Marks the scope it's declared in as reading the settings cache, snapshots replaced meanwhile aren't freed until it ends.
+// Opening and closing it costs an atomic increment and decrement, it never locks or waits.
+class SettingsReadScope
+{
+public:
+	SettingsReadScope()
+	{
+		// Sequentially consistent, so a reader that loads a snapshot counted itself before the snapshot could be retired
+		SettingsCache::readerCount_.fetch_add(1);
+	}
+
+	~SettingsReadScope()
+	{
+		SettingsCache::readerCount_.fetch_sub(1, std::memory_order_release);
+	}
+
+	// Prevent copying, which would close the scope twice
+
+	SettingsReadScope(const SettingsReadScope& other) = delete;
+
+	SettingsReadScope& operator=(const SettingsReadScope& other) = delete;
+};
@@ -0,0 +1,118 @@
+#include "SettingsPersistence.h"
+
+#include "SettingsUtils.h"
+
+std::mutex SettingsPersistence::mutex_;
+std::mutex SettingsPersistence::writeMutex_;
+std::condition_variable SettingsPersistence::condition_;
+std::thread SettingsPersistence::writerThread_;
+bool SettingsPersistence::isRunning_ = false;
+bool SettingsPersistence::hasPending_ = false;
+SettingsStruct SettingsPersistence::pending_;
+std::chrono::steady_clock::time_point SettingsPersistence::deadline_;
+std::string SettingsPersistence::lastWritten_;
+constexpr std::chrono::milliseconds SettingsPersistence::debounceWindow;
+
+void SettingsPersistence::start()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (isRunning_) return;
+
+	// Remember what's already on disk so re-saving the loaded settings doesn't rewrite the file
+	lastWritten_ = readSettingsFileContents();
+
+	isRunning_ = true;
+	writerThread_ = std::thread(run);
+}
+
+void SettingsPersistence::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!isRunning_) return;
+
+		isRunning_ = false;
+	}
+
+	condition_.notify_one();
+
+	if (writerThread_.joinable())
+	{
+		writerThread_.join();
+	}
+}
+
+void SettingsPersistence::requestSave(const SettingsStruct& settings)
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		if (!isRunning_)
+		{
+			lock.unlock();
+			write(settings);
+			return;
+		}
+
+		// Every request pushes the deadline back, so a burst of changes ends in a single write
+		pending_ = settings;
+		hasPending_ = true;
+		deadline_ = std::chrono::steady_clock::now() + debounceWindow;
+	}
+
+	condition_.notify_one();
+}
+
+bool SettingsPersistence::isLastWritten(const std::string& contents)
+{
+	std::lock_guard<std::mutex> lock(writeMutex_);
+	return contents == lastWritten_;
+}
+
+void SettingsPersistence::forgetLastWritten()
+{
+	std::lock_guard<std::mutex> lock(writeMutex_);
+	lastWritten_.clear();
+}
+
+void SettingsPersistence::run()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	while (isRunning_ || hasPending_)
+	{
+		if (!hasPending_)
+		{
+			condition_.wait(lock, [] { return hasPending_ || !isRunning_; });
+			continue;
+		}
+
+		// Flush immediately when stopping, otherwise wait for the burst to settle
+		if (isRunning_ && std::chrono::steady_clock::now() < deadline_)
+		{
+			condition_.wait_until(lock, deadline_);
+			continue;
+		}
+
+		const SettingsStruct settings = pending_;
+		hasPending_ = false;
+
+		// Don't hold up requests while the file is being written
+		lock.unlock();
+		write(settings);
+		lock.lock();
+	}
+}
+
+void SettingsPersistence::write(const SettingsStruct& settings)
+{
+	std::lock_guard<std::mutex> lock(writeMutex_);
+	const std::string contents = serializeSettings(settings);
+
+	if (contents == lastWritten_) return;
+
+	if (writeFileAtomically(SETTINGS_FILE_NAME, contents))
+	{
+		lastWritten_ = contents;
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Globals.h"
+
+// Saves settings to the settings.json file on a background thread.
+// Bursts of changes are coalesced into a single write, and writes that wouldn't change the file are skipped.
+class SettingsPersistence
+{
+private:
+	static std::mutex mutex_;
+	static std::mutex writeMutex_; // Serializes file writes and guards lastWritten_
+	static std::condition_variable condition_;
+	static std::thread writerThread_;
+	static bool isRunning_;
+	static bool hasPending_;
+	static SettingsStruct pending_;
+	static std::chrono::steady_clock::time_point deadline_;
+	static std::string lastWritten_; // The contents of settings.json as of the last read or write
+
+	/**
+	@brief The writer thread's loop. Waits for the debounce window to pass after the last request, then writes.
+	*/
+	static void run();
+
+	/**
+	@brief Serialize and write the settings, unless the file already contains the exact same content.
+
+	@param settings The settings to write.
+	*/
+	static void write(const SettingsStruct& settings);
+
+public:
+	// Changes requested within this window of each other are written to the file only once
+	static constexpr std::chrono::milliseconds debounceWindow{ 500 };
+
+	/**
+	@brief Start the background writer thread.
+	*/
+	static void start();
+
+	/**
+	@brief Stop the background writer thread, writing any pending settings first.
+	*/
+	static void stop();
+
+	/**
+	@brief Request the settings to be saved. Returns immediately, the write happens after the debounce window.
+	If the writer thread isn't running, the settings are written synchronously.
+
+	@param settings The settings to save.
+	*/
+	static void requestSave(const SettingsStruct& settings);
+
+	/**
+	@param contents The contents of the settings.json file.
+
+	@return Wether the contents are exactly what was last written (or read at startup).
+	*/
+	static bool isLastWritten(const std::string& contents);
+
+	/**
+	@brief Forget the last written contents, after the file was changed by another process.
+	The next requested save is then always written.
+	*/
+	static void forgetLastWritten();
+};
@@ -0,0 +1,152 @@
+#pragma once
+#include <cstring>
+
+#include "Globals.h"
+#include "SettingsUtils.h"
+#include "dist/json/json.h"
+
+// Valid ranges
+constexpr int KEYBOARD_KEY_MIN = 0x01;
+constexpr int KEYBOARD_KEY_MAX = HOTKEY_MODIFIERS | 0xFE; // any virtual key, with any modifiers
+constexpr int CONTROLLER_KEY_MIN = CONTROLLER_UP;
+constexpr int CONTROLLER_KEY_MAX = CONTROLLER_RIGHT_TRIGGER;
+constexpr int DEBOUNCE_TIME_MIN = 0;
+constexpr int DEBOUNCE_TIME_MAX = 500;
+constexpr int COLOR_INDEX_MIN = 0;
+constexpr int COLOR_INDEX_MAX = 24;
+
+// Describes a single setting: where it's saved in the json file, where it lives in the struct and what values it accepts
+template <class OWNER, class T> struct SettingField
+{
+	const char* key; // nullptr for settings that aren't saved to the file
+	T OWNER::* member;
+	T defaultValue;
+	T minValue;
+	T maxValue;
+	byte group; // The SETTINGS_CHANGED group the setting belongs to
+};
+
+// The json key of the nested colors object
+constexpr char COLORS_KEY[] = "colors";
+
+// The json keys of the bindings array and the members of it's objects, e.g. "bindings": [ { "action": "start", "key": 71 } ]
+constexpr char BINDINGS_KEY[] = "bindings";
+constexpr char BINDING_ACTION_KEY[] = "action";
+constexpr char BINDING_KEY_KEY[] = "key";
+
+// The json keys of the profiles array and the members of it's objects, e.g. "profiles": [ { "name": "killer", "bindings": [] } ]
+constexpr char PROFILES_KEY[] = "profiles";
+constexpr char PROFILE_NAME_KEY[] = "name";
+
+/**
+@return Wether the code can be bound to an action, a keyboard hotkey or a controller button.
+*/
+constexpr bool isValidHotkey(const int keyCode)
+{
+	return (keyCode >= KEYBOARD_KEY_MIN && keyCode <= KEYBOARD_KEY_MAX) || (keyCode >= CONTROLLER_KEY_MIN && keyCode <= CONTROLLER_KEY_MAX);
+}
+
+// The settings schema. Adding a setting only requires a member in the struct and a line here.
+
+constexpr SettingField<SettingsStruct, int> SETTINGS_INT_FIELDS[] = {
+	{ "start", &SettingsStruct::startKey, 70, KEYBOARD_KEY_MIN, KEYBOARD_KEY_MAX, SETTINGS_CHANGED_HOTKEYS },
+	{ "timer1", &SettingsStruct::timer1Key, 112, KEYBOARD_KEY_MIN, KEYBOARD_KEY_MAX, SETTINGS_CHANGED_HOTKEYS },
+	{ "timer2", &SettingsStruct::timer2Key, 113, KEYBOARD_KEY_MIN, KEYBOARD_KEY_MAX, SETTINGS_CHANGED_HOTKEYS },
+	{ "startNoReset", &SettingsStruct::startNoResetKey, 72, KEYBOARD_KEY_MIN, KEYBOARD_KEY_MAX, SETTINGS_CHANGED_HOTKEYS },
+	{ "conStart", &SettingsStruct::conStartKey, CONTROLLER_A, CONTROLLER_KEY_MIN, CONTROLLER_KEY_MAX, SETTINGS_CHANGED_HOTKEYS },
+	{ "conTimer1", &SettingsStruct::conTimer1Key, CONTROLLER_LEFT, CONTROLLER_KEY_MIN, CONTROLLER_KEY_MAX, SETTINGS_CHANGED_HOTKEYS },
+	{ "conTimer2", &SettingsStruct::conTimer2Key, CONTROLLER_RIGHT, CONTROLLER_KEY_MIN, CONTROLLER_KEY_MAX, SETTINGS_CHANGED_HOTKEYS },
+	{ "conStartNoReset", &SettingsStruct::conStartNoResetKey, CONTROLLER_B, CONTROLLER_KEY_MIN, CONTROLLER_KEY_MAX, SETTINGS_CHANGED_HOTKEYS },
+	{ "debounceTime", &SettingsStruct::debounceTime, 30, DEBOUNCE_TIME_MIN, DEBOUNCE_TIME_MAX, SETTINGS_CHANGED_HOTKEYS }, // milliseconds
+};
+
+constexpr SettingField<SettingsStruct, bool> SETTINGS_BOOL_FIELDS[] = {
+	{ "optionStartOnChange", &SettingsStruct::optionStartOnChange, false, false, true, SETTINGS_CHANGED_OPTIONS },
+	{ "optionTransparent", &SettingsStruct::optionTransparent, false, false, true, SETTINGS_CHANGED_TRANSPARENCY },
+	{ nullptr, &SettingsStruct::optionClickThrough, false, false, true, SETTINGS_CHANGED_OPTIONS }, // resets when the app is closed
+};
+
+constexpr SettingField<ColorsStruct, int> COLORS_INT_FIELDS[] = {
+	{ "timer", &ColorsStruct::timerColor, 9, COLOR_INDEX_MIN, COLOR_INDEX_MAX, SETTINGS_CHANGED_COLORS },
+	{ "selected timer", &ColorsStruct::selectedTimerColor, 6, COLOR_INDEX_MIN, COLOR_INDEX_MAX, SETTINGS_CHANGED_COLORS },
+	{ "last seconds", &ColorsStruct::lastSecondsColor, 1, COLOR_INDEX_MIN, COLOR_INDEX_MAX, SETTINGS_CHANGED_COLORS },
+	{ "background", &ColorsStruct::backgroundColor, 20, COLOR_INDEX_MIN, COLOR_INDEX_MAX, SETTINGS_CHANGED_COLORS },
+};
+
+/**
+@brief Set every field in the table to it's default value.
+
+@param owner The struct to reset.
+
+@param fields The schema table of the struct's fields.
+*/
+template <class OWNER, class T, size_t N>
+void resetFields(OWNER& owner, const SettingField<OWNER, T>(&fields)[N])
+{
+	for (const SettingField<OWNER, T>& field : fields) {
+		owner.*field.member = field.defaultValue;
+	}
+}
+
+/**
+@brief Find the saved field with the given json key.
+
+@param fields The schema table to search.
+
+@param keyBegin The start of the key.
+
+@param keyEnd One past the end of the key.
+
+@return The matching field or nullptr if the key isn't in the table.
+*/
+template <class OWNER, class T, size_t N>
+const SettingField<OWNER, T>* findField(const SettingField<OWNER, T>(&fields)[N], const char* keyBegin, const char* keyEnd)
+{
+	const size_t keyLength = keyEnd - keyBegin;
+
+	for (const SettingField<OWNER, T>& field : fields) {
+		if (field.key != nullptr && strlen(field.key) == keyLength && memcmp(field.key, keyBegin, keyLength) == 0) {
+			return &field;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+@brief Write every saved field in the table as members of the json object being written.
+
+@param writer The writer, inside the object the fields belong to.
+
+@param owner The struct to save.
+
+@param fields The schema table of the struct's fields.
+*/
+template <class OWNER, class T, size_t N>
+void writeFields(Json::EventWriter& writer, const OWNER& owner, const SettingField<OWNER, T>(&fields)[N])
+{
+	for (const SettingField<OWNER, T>& field : fields) {
+		if (field.key == nullptr) continue;
+
+		writer.key(field.key).value(owner.*field.member);
+	}
+}
+
+/**
+@brief Compare every field in the table between two structs.
+
+@return A combination of the SETTINGS_CHANGED groups of the fields that differ.
+*/
+template <class OWNER, class T, size_t N>
+byte diffFields(const OWNER& oldOwner, const OWNER& newOwner, const SettingField<OWNER, T>(&fields)[N])
+{
+	byte changes = SETTINGS_CHANGED_NONE;
+
+	for (const SettingField<OWNER, T>& field : fields) {
+		if (oldOwner.*field.member != newOwner.*field.member) {
+			changes |= field.group;
+		}
+	}
+
+	return changes;
+}
@@ -0,0 +1,223 @@
+#include "SettingsSink.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace
+{
+	/**
+	@return Wether the json key between begin and end is the given key.
+	*/
+	template <size_t N>
+	bool isKey(const char* begin, const char* end, const char(&key)[N])
+	{
+		return (size_t)(end - begin) == N - 1 && memcmp(begin, key, N - 1) == 0;
+	}
+
+	/**
+	@brief Store a value into a field if it's in the field's range, otherwise store the field's default.
+			Clears the pending field.
+	*/
+	template <class OWNER, class T>
+	void storeField(OWNER& owner, const SettingField<OWNER, T>*& pField, const bool isValid, const T value)
+	{
+		if (pField == nullptr) return;
+
+		const bool isInRange = isValid && value >= pField->minValue && value <= pField->maxValue;
+		owner.*pField->member = isInRange ? value : pField->defaultValue;
+		pField = nullptr;
+	}
+}
+
+void SettingsSink::readValue(const bool isInt, const int intValue, const bool isBool, const bool boolValue)
+{
+	storeField(settings_, pendingInt_, isInt, intValue);
+	storeField(settings_, pendingBool_, isBool, boolValue);
+	storeField(settings_.colors, pendingColor_, isInt, intValue);
+
+	// Colors that aren't an object are all reset
+	if (isColorsPending_) {
+		settings_.colors = ColorsStruct();
+		isColorsPending_ = false;
+	}
+
+	// Bindings and profiles that aren't an array are all dropped
+	if (pPendingBindings_ != nullptr) {
+		pPendingBindings_->clear();
+		pPendingBindings_ = nullptr;
+	}
+
+	if (isProfilesPending_) {
+		settings_.profiles.clear();
+		isProfilesPending_ = false;
+	}
+
+	if (pendingBindingMember_ == BINDING_KEY) {
+		binding_.keyCode = isInt ? intValue : 0;
+	}
+	pendingBindingMember_ = BINDING_NONE;
+	isProfileNamePending_ = false;
+}
+
+bool SettingsSink::onNull()
+{
+	readValue(false, 0, false, false);
+	return true;
+}
+
+bool SettingsSink::onBool(const bool value)
+{
+	readValue(false, 0, true, value);
+	return true;
+}
+
+bool SettingsSink::onInt(const Json::LargestInt value)
+{
+	const bool isInt = value >= INT_MIN && value <= INT_MAX;
+	readValue(isInt, isInt ? static_cast<int>(value) : 0, false, false);
+	return true;
+}
+
+bool SettingsSink::onUInt(Json::LargestUInt)
+{
+	// Only reported for values that don't fit a LargestInt
+	readValue(false, 0, false, false);
+	return true;
+}
+
+bool SettingsSink::onDouble(const double value)
+{
+	// Whole numbers written as doubles (70.0) are accepted, like Json::Value::isInt does
+	const bool isInt = value >= INT_MIN && value <= INT_MAX && std::trunc(value) == value;
+	readValue(isInt, isInt ? static_cast<int>(value) : 0, false, false);
+	return true;
+}
+
+bool SettingsSink::onString(const char* begin, const char* end)
+{
+	if (pendingBindingMember_ == BINDING_ACTION) {
+		binding_.action.assign(begin, end);
+	}
+	else if (isProfileNamePending_) {
+		profile_.name.assign(begin, end);
+	}
+
+	readValue(false, 0, false, false);
+	return true;
+}
+
+bool SettingsSink::onObjectBegin()
+{
+	if (depth_ == 0) {
+		isRootObject_ = true;
+	}
+	else if (isColorsPending_) {
+		// The last colors object wins, keys it doesn't have keep their defaults
+		settings_.colors = ColorsStruct();
+		isColorsPending_ = false;
+		isInColors_ = true;
+	}
+	else if (pBindings_ != nullptr && depth_ == bindingsDepth_) {
+		binding_ = BindingStruct();
+		binding_.keyCode = 0;
+		isInBinding_ = true;
+	}
+	else if (isInProfiles_ && depth_ == 2) {
+		profile_ = ProfileStruct();
+		isInProfile_ = true;
+	}
+
+	readValue(false, 0, false, false);
+	++depth_;
+	return true;
+}
+
+bool SettingsSink::onKey(const char* begin, const char* end)
+{
+	if (depth_ == 1 && isRootObject_) {
+		pendingInt_ = findField(SETTINGS_INT_FIELDS, begin, end);
+		pendingBool_ = findField(SETTINGS_BOOL_FIELDS, begin, end);
+		isColorsPending_ = isKey(begin, end, COLORS_KEY);
+		pPendingBindings_ = isKey(begin, end, BINDINGS_KEY) ? &settings_.bindings : nullptr;
+		isProfilesPending_ = isKey(begin, end, PROFILES_KEY);
+	}
+	else if (depth_ == 2 && isInColors_) {
+		pendingColor_ = findField(COLORS_INT_FIELDS, begin, end);
+	}
+	else if (depth_ == 3 && isInProfile_ && pBindings_ == nullptr) {
+		isProfileNamePending_ = isKey(begin, end, PROFILE_NAME_KEY);
+		pPendingBindings_ = isKey(begin, end, BINDINGS_KEY) ? &profile_.bindings : nullptr;
+	}
+	else if (depth_ == bindingsDepth_ + 1 && isInBinding_) {
+		pendingBindingMember_ = isKey(begin, end, BINDING_ACTION_KEY) ? BINDING_ACTION
+			: isKey(begin, end, BINDING_KEY_KEY) ? BINDING_KEY : BINDING_NONE;
+	}
+
+	return true;
+}
+
+bool SettingsSink::onObjectEnd()
+{
+	--depth_;
+
+	if (depth_ == 1) {
+		isInColors_ = false;
+	}
+	else if (depth_ == bindingsDepth_ && isInBinding_) {
+		isInBinding_ = false;
+
+		if (!binding_.action.empty() && isValidHotkey(binding_.keyCode)) {
+			pBindings_->push_back(binding_);
+		}
+	}
+	else if (depth_ == 2 && isInProfile_) {
+		isInProfile_ = false;
+
+		const bool isNameTaken = std::any_of(settings_.profiles.begin(), settings_.profiles.end(),
+			[this](const ProfileStruct& profile) { return profile.name == profile_.name; });
+
+		if (!profile_.name.empty() && !isNameTaken) {
+			settings_.profiles.push_back(profile_);
+		}
+	}
+
+	return true;
+}
+
+bool SettingsSink::onArrayBegin()
+{
+	std::vector<BindingStruct>* const pBindings = pPendingBindings_;
+	const bool isProfiles = isProfilesPending_;
+	pPendingBindings_ = nullptr;
+	isProfilesPending_ = false;
+
+	readValue(false, 0, false, false);
+	++depth_;
+
+	// The last bindings and profiles arrays win
+	if (pBindings != nullptr) {
+		pBindings->clear();
+		pBindings_ = pBindings;
+		bindingsDepth_ = depth_;
+	}
+	else if (isProfiles) {
+		settings_.profiles.clear();
+		isInProfiles_ = true;
+	}
+
+	return true;
+}
+
+bool SettingsSink::onArrayEnd()
+{
+	--depth_;
+
+	if (pBindings_ != nullptr && depth_ == bindingsDepth_ - 1) {
+		pBindings_ = nullptr;
+	}
+	else if (depth_ == 1) {
+		isInProfiles_ = false;
+	}
+
+	return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "Globals.h"
+#include "SettingsSchema.h"
+#include "dist/json/json.h"
+
+// Receives the tokens of settings.json from Json::parseEvents and writes them straight into a SettingsStruct.
+// Follows the same rules as the schema: missing, mistyped or out of range values keep their field's default,
+// duplicate keys take the last value and a root that isn't an object leaves every field at its default.
+// Bindings that aren't objects or lack a valid action or key are dropped, the rest of the array is kept.
+// The same goes for profiles without a name, or with the name of an earlier profile.
+class SettingsSink : public Json::ParseEventHandler
+{
+private:
+	SettingsStruct& settings_;
+
+	int depth_ = 0; // How many objects and arrays are currently open
+	bool isRootObject_ = false;
+	bool isInColors_ = false;
+
+	// The field whose value is the next token, set by onKey
+	const SettingField<SettingsStruct, int>* pendingInt_ = nullptr;
+	const SettingField<SettingsStruct, bool>* pendingBool_ = nullptr;
+	const SettingField<ColorsStruct, int>* pendingColor_ = nullptr;
+	bool isColorsPending_ = false;
+
+	// The bindings array being read, the root's or a profile's, and the binding object in it
+	enum BindingMember : byte { BINDING_NONE, BINDING_ACTION, BINDING_KEY };
+	std::vector<BindingStruct>* pPendingBindings_ = nullptr; // set by a bindings key, until it's value starts
+	std::vector<BindingStruct>* pBindings_ = nullptr;
+	int bindingsDepth_ = 0; // the depth inside the bindings array
+	bool isInBinding_ = false;
+	BindingStruct binding_;
+	BindingMember pendingBindingMember_ = BINDING_NONE;
+
+	// The profiles array and the profile object being read
+	bool isProfilesPending_ = false;
+	bool isInProfiles_ = false;
+	bool isInProfile_ = false;
+	bool isProfileNamePending_ = false;
+	ProfileStruct profile_;
+
+	/**
+	@brief Store a value into the pending field, or the field's default if the value doesn't fit it.
+
+	@param isInt Whether the value is an integer that fits an int.
+
+	@param intValue The value as an int.
+
+	@param isBool Whether the value is a boolean.
+
+	@param boolValue The value as a bool.
+	*/
+	void readValue(bool isInt, int intValue, bool isBool, bool boolValue);
+
+public:
+	/**
+	@param settings The struct to fill. Should hold the default settings before parsing.
+	*/
+	explicit SettingsSink(SettingsStruct& settings) : settings_(settings) {}
+
+	bool onNull() override;
+	bool onBool(bool value) override;
+	bool onInt(Json::LargestInt value) override;
+	bool onUInt(Json::LargestUInt value) override;
+	bool onDouble(double value) override;
+	bool onString(const char* begin, const char* end) override;
+	bool onObjectBegin() override;
+	bool onKey(const char* begin, const char* end) override;
+	bool onObjectEnd() override;
+	bool onArrayBegin() override;
+	bool onArrayEnd() override;
+};
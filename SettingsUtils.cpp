@@ -2,141 +2,178 @@
 #include "SettingsUtils.h"
 
 #include "HotkeyManager.h"
+#include "MappedFile.h"
+#include "SettingsCache.h"
+#include "SettingsPersistence.h"
+#include "SettingsSchema.h"
+#include "SettingsSink.h"
 #include "dist/json/json.h"
 
+#ifndef _WIN32
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
+ColorsStruct::ColorsStruct()
+{
+	resetFields(*this, COLORS_INT_FIELDS);
+}
+
+SettingsStruct::SettingsStruct()
+{
+	resetFields(*this, SETTINGS_INT_FIELDS);
+	resetFields(*this, SETTINGS_BOOL_FIELDS);
+}
+
 SettingsStruct getSafeSettingsStruct()
 {
-	ifstream file(SETTINGS_FILE_NAME);
-	Json::Value actualJson;
-	Json::Reader reader;
 	SettingsStruct settings;
 
-	reader.parse(file, actualJson);
-
-	// hotkeys
-	if (actualJson["start"].isInt() && actualJson["timer1"].isInt() && actualJson["timer2"].isInt() &&
-		actualJson["conStart"].isInt() && actualJson["conTimer1"].isInt() && actualJson["conTimer2"].isInt()
-		&& actualJson["startNoReset"].isInt() && actualJson["conStartNoReset"].isInt())
-	{
-		settings.startKey = actualJson["start"].asInt();
-		settings.timer1Key = actualJson["timer1"].asInt();
-		settings.timer2Key = actualJson["timer2"].asInt();
-		settings.startNoResetKey = actualJson["startNoReset"].asInt();
-
-		settings.conStartKey = actualJson["conStart"].asInt();
-		settings.conTimer1Key = actualJson["conTimer1"].asInt();
-		settings.conTimer2Key = actualJson["conTimer2"].asInt();
-		settings.conStartNoResetKey = actualJson["conStartNoReset"].asInt();
+	// Parsed straight from the file's view, the contents are never copied
+	MappedFile file;
+	if (file.open(SETTINGS_FILE_NAME)) {
+		parseSettings(file.data(), file.data() + file.size(), settings);
 	}
 
-	// options
-	if (actualJson["optionTransparent"].isBool() && actualJson["optionStartOnChange"].isBool()) {
-		settings.optionTransparent = actualJson["optionTransparent"].asBool();
-		settings.optionStartOnChange = actualJson["optionStartOnChange"].asBool();
-	}
+	return settings;
+}
 
-	settings.optionClickThrough = false;
+string readSettingsFileContents()
+{
+	MappedFile file;
+	if (!file.open(SETTINGS_FILE_NAME)) return string();
 
-	// colors
-	Json::Value colors = actualJson["colors"];
-	if (colors["timer"].isInt() && colors["selected timer"].isInt()
-		&& colors["last seconds"].isInt() && colors["background"].isInt())
-	{
-		settings.colors.timerColor = colors["timer"].asInt();
-		settings.colors.selectedTimerColor = colors["selected timer"].asInt();
-		settings.colors.lastSecondsColor = colors["last seconds"].asInt();
-		settings.colors.backgroundColor = colors["background"].asInt();
-
-		if (settings.colors.timerColor > 24 || settings.colors.selectedTimerColor > 24 ||
-			settings.colors.lastSecondsColor > 24 || settings.colors.backgroundColor > 24)
-		{
-			settings.colors.timerColor = 9;
-			settings.colors.selectedTimerColor = 6;
-			settings.colors.lastSecondsColor = 1;
-			settings.colors.backgroundColor = 20;
-		}
+	return string(file.data(), file.size());
+}
+
+bool parseSettings(const string& json, SettingsStruct& result)
+{
+	return parseSettings(json.data(), json.data() + json.size(), result);
+}
+
+bool parseSettings(const char* begin, const char* end, SettingsStruct& result)
+{
+	// Streamed straight into the struct, no Json::Value tree is built
+	SettingsStruct settings;
+	SettingsSink sink(settings);
+
+	if (!Json::parseEvents(begin, end, sink, nullptr)) {
+		return false;
 	}
 
-	return settings;
+	result = settings;
+	return true;
 }
 
-void setSettingsStruct(const SettingsStruct& settings)
+/**
+@brief Write a bindings array as a member of the json object being written.
+*/
+static void writeBindings(Json::EventWriter& writer, const std::vector<BindingStruct>& bindings)
 {
-	ifstream file(SETTINGS_FILE_NAME);
+	writer.key(BINDINGS_KEY).arrayBegin();
+	for (const BindingStruct& binding : bindings) {
+		writer.objectBegin().key(BINDING_ACTION_KEY).value(binding.action).key(BINDING_KEY_KEY).value(binding.keyCode).objectEnd();
+	}
+	writer.arrayEnd();
+}
 
-	// Retrieve existing settings
-	Json::Reader reader;
-	Json::Value settingsJson;
-	reader.parse(file, settingsJson);
+string serializeSettings(const SettingsStruct& settings)
+{
+	// Written straight to text in the schema's order, no Json::Value tree is built
+	Json::EventWriter writer("   ");
 
-	// Change json obj
-	settingsJson["start"] = settings.startKey;
-	settingsJson["timer1"] = settings.timer1Key;
-	settingsJson["timer2"] = settings.timer2Key;
-	settingsJson["startNoReset"] = settings.startNoResetKey;
+	writer.objectBegin();
+	writeFields(writer, settings, SETTINGS_INT_FIELDS);
+	writeFields(writer, settings, SETTINGS_BOOL_FIELDS);
 
-	settingsJson["conStart"] = settings.conStartKey;
-	settingsJson["conTimer1"] = settings.conTimer1Key;
-	settingsJson["conTimer2"] = settings.conTimer2Key;
-	settingsJson["conStartNoReset"] = settings.conStartNoResetKey;
+	writer.key(COLORS_KEY).objectBegin();
+	writeFields(writer, settings.colors, COLORS_INT_FIELDS);
+	writer.objectEnd();
 
-	settingsJson["optionTransparent"] = settings.optionTransparent;
-	settingsJson["optionStartOnChange"] = settings.optionStartOnChange;
+	writeBindings(writer, settings.bindings);
 
-	settingsJson["colors"]["timer"] = settings.colors.timerColor;
-	settingsJson["colors"]["selected timer"] = settings.colors.selectedTimerColor;
-	settingsJson["colors"]["last seconds"] = settings.colors.lastSecondsColor;
-	settingsJson["colors"]["background"] = settings.colors.backgroundColor;
+	writer.key(PROFILES_KEY).arrayBegin();
+	for (const ProfileStruct& profile : settings.profiles)
+	{
+		writer.objectBegin().key(PROFILE_NAME_KEY).value(profile.name);
+		writeBindings(writer, profile.bindings);
+		writer.objectEnd();
+	}
+	writer.arrayEnd();
 
-	// Write to file
-	Json::StreamWriterBuilder builder;
-	builder["commentStyle"] = "None";
-	builder["indentation"] = "   ";
+	writer.objectEnd();
 
-	std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-	std::ofstream outputFileStream(SETTINGS_FILE_NAME);
-	writer->write(settingsJson, &outputFileStream);
+	return writer.str();
 }
 
-void createSettingsFile()
+#ifdef _WIN32
+bool writeFileAtomically(const string& fileName, const string& contents)
 {
-	ofstream file(SETTINGS_FILE_NAME);
+	const string tempFileName = fileName + ".tmp";
 
-	ColorsStruct defaultColors;
+	const HANDLE hFile = CreateFileA(tempFileName.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return false;
+	}
 
-	SettingsStruct defaultSettings;
-	defaultSettings.colors = defaultColors;
+	DWORD written = 0;
+	const bool isWritten = WriteFile(hFile, contents.data(), (DWORD)contents.size(), &written, nullptr)
+		&& written == contents.size()
+		&& FlushFileBuffers(hFile); // make sure the data is on disk before it replaces the old file
+	CloseHandle(hFile);
 
-	Json::Value settingsJson;
-	
-	settingsJson["start"] = defaultSettings.startKey;
-	settingsJson["timer1"] = defaultSettings.timer1Key;
-	settingsJson["timer2"] = defaultSettings.timer2Key;
-	settingsJson["startNoReset"] = defaultSettings.startNoResetKey;
+	// Swap the complete file in, a crash at any point leaves either the old or the new file intact
+	if (!isWritten || !MoveFileExA(tempFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		DeleteFileA(tempFileName.c_str());
+		return false;
+	}
 
-	settingsJson["conStart"] = defaultSettings.conStartKey;
-	settingsJson["conTimer1"] = defaultSettings.conTimer1Key;
-	settingsJson["conTimer2"] = defaultSettings.conTimer2Key;
-	settingsJson["conStartNoReset"] = defaultSettings.conStartNoResetKey;
+	return true;
+}
+#else
+bool writeFileAtomically(const string& fileName, const string& contents)
+{
+	const string tempFileName = fileName + ".tmp";
 
-	settingsJson["optionTransparent"] = defaultSettings.optionTransparent;
-	settingsJson["optionStartOnChange"] = defaultSettings.optionStartOnChange;
+	const int file = ::open(tempFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (file < 0) {
+		return false;
+	}
 
-	settingsJson["colors"]["timer"] = defaultSettings.colors.timerColor;
-	settingsJson["colors"]["selected timer"] = defaultSettings.colors.selectedTimerColor;
-	settingsJson["colors"]["last seconds"] = defaultSettings.colors.lastSecondsColor;
-	settingsJson["colors"]["background"] = defaultSettings.colors.backgroundColor;
+	size_t written = 0;
+	while (written < contents.size())
+	{
+		const ssize_t result = ::write(file, contents.data() + written, contents.size() - written);
+		if (result <= 0) break;
+		written += (size_t)result;
+	}
+	const bool isWritten = written == contents.size()
+		&& ::fsync(file) == 0; // make sure the data is on disk before it replaces the old file
+	::close(file);
+
+	// rename replaces the old file in one step, like MoveFileEx
+	if (!isWritten || std::rename(tempFileName.c_str(), fileName.c_str()) != 0) {
+		std::remove(tempFileName.c_str());
+		return false;
+	}
 
-	// Write to file
-	Json::StreamWriterBuilder builder;
+	return true;
+}
+#endif
 
-	builder["commentStyle"] = "None";
-	builder["indentation"] = "   ";
-	std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-	std::ofstream outputFileStream(SETTINGS_FILE_NAME);
-	writer->write(settingsJson, &outputFileStream);
+void setSettingsStruct(const SettingsStruct& settings)
+{
+	writeFileAtomically(SETTINGS_FILE_NAME, serializeSettings(settings));
+}
+
+void createSettingsFile()
+{
+	const SettingsStruct defaultSettings;
+
+	setSettingsStruct(defaultSettings);
 }
 
 bool settingsFileExists() {
@@ -146,19 +183,25 @@ bool settingsFileExists() {
 	return f.good();
 }
 
+static void applyTransparency(const bool isTransparent) {
+	if (isTransparent) { // add transparent effect
+		SetLayeredWindowAttributes(hwndMainWindow, 0, 0, LWA_COLORKEY);
+	}
+	else { // remove transparent effect
+		SetLayeredWindowAttributes(hwndMainWindow, 0, 255, LWA_ALPHA);
+	}
+}
+
 void applySettings(const SettingsStruct& settings) {
-	setSettingsStruct(settings); // write to json file (settings.json)
-	appSettings = settings; // save global settings variable
+	SettingsPersistence::requestSave(settings); // write to json file (settings.json) in the background
+	SettingsCache::store(settings); // publish the new settings to the in-memory cache
+	const SettingsReadScope readScope;
+	const SettingsStruct& appSettings = SettingsCache::get();
 	HotkeyManager::setHotkeysMap(appSettings); // initialize hotkeys map
 
 	if (hwndMainWindow != nullptr) {
 		// transparency
-		if (appSettings.optionTransparent) { // add transparent effect
-			SetLayeredWindowAttributes(hwndMainWindow, 0, 0, LWA_COLORKEY);
-		}
-		else { // remove transparent effect
-			SetLayeredWindowAttributes(hwndMainWindow, 0, 255, LWA_ALPHA);
-		}
+		applyTransparency(appSettings.optionTransparent);
 
 		// click through
 		if (appSettings.optionClickThrough) { // make click through
@@ -173,3 +216,38 @@ void applySettings(const SettingsStruct& settings) {
 		}
 	}
 }
+
+byte diffSettings(const SettingsStruct& oldSettings, const SettingsStruct& newSettings) {
+	return diffFields(oldSettings, newSettings, SETTINGS_INT_FIELDS)
+		| diffFields(oldSettings, newSettings, SETTINGS_BOOL_FIELDS)
+		| diffFields(oldSettings.colors, newSettings.colors, COLORS_INT_FIELDS)
+		| (oldSettings.bindings != newSettings.bindings || oldSettings.profiles != newSettings.profiles ? SETTINGS_CHANGED_HOTKEYS : SETTINGS_CHANGED_NONE);
+}
+
+void applyChangedSettings(const SettingsStruct& settings) {
+	byte changes;
+	{
+		const SettingsReadScope readScope;
+		changes = diffSettings(SettingsCache::get(), settings);
+	}
+
+	if (changes == SETTINGS_CHANGED_NONE) return;
+
+	// Options that are only read when needed take effect through the cache alone
+	SettingsCache::store(settings);
+
+	if (changes & SETTINGS_CHANGED_HOTKEYS) {
+		HotkeyManager::setHotkeysMap(settings);
+	}
+
+	if (hwndMainWindow != nullptr) {
+		// recolour the existing brushes
+		if (changes & SETTINGS_CHANGED_COLORS) {
+			SendMessage(hwndMainWindow, REFRESH_BRUSHES, 0, 0);
+		}
+
+		if (changes & SETTINGS_CHANGED_TRANSPARENCY) {
+			applyTransparency(settings.optionTransparent);
+		}
+	}
+}
@@ -2,6 +2,13 @@
 
 #include "Globals.h"
 
+// Groups of settings reported by diffSettings
+constexpr byte SETTINGS_CHANGED_NONE = 0;
+constexpr byte SETTINGS_CHANGED_HOTKEYS = 1;
+constexpr byte SETTINGS_CHANGED_COLORS = 2;
+constexpr byte SETTINGS_CHANGED_TRANSPARENCY = 4;
+constexpr byte SETTINGS_CHANGED_OPTIONS = 8;
+
 /**
 @brief Safely retrieves the SettingsStruct from the settings.json file.
 		Handles errors in the settings.json file and resets it if need be.
@@ -11,7 +18,58 @@
 SettingsStruct getSafeSettingsStruct();
 
 /**
-@brief Writes the settings from the given SettingsStruct to the settings.json file.
+@return The raw contents of the settings.json file (empty if it can't be read).
+*/
+std::string readSettingsFileContents();
+
+/**
+@brief Parses settings from json text. Each setting is validated on it's own, a missing, mistyped or out of range value is set to it's default value.
+
+@param json The json text to parse.
+
+@param result Receives the parsed settings. Left untouched if the text isn't valid json.
+
+@return Wether the text was valid json.
+*/
+bool parseSettings(const std::string& json, SettingsStruct& result);
+
+/**
+@brief Parses settings from a range of json text, like a mapped file. The range doesn't need to be null terminated.
+Each setting is validated on it's own, a missing, mistyped or out of range value is set to it's default value.
+
+@param begin The start of the json text.
+
+@param end One past the end of the json text.
+
+@param result Receives the parsed settings. Left untouched if the text isn't valid json.
+
+@return Wether the text was valid json.
+*/
+bool parseSettings(const char* begin, const char* end, SettingsStruct& result);
+
+/**
+@brief Serializes the given SettingsStruct to the json format of the settings.json file.
+
+@param settings The settings struct to serialize.
+
+@return The json text representing the settings.
+*/
+std::string serializeSettings(const SettingsStruct& settings);
+
+/**
+@brief Writes contents to a temporary file and renames it over the given file,
+		so the file is never left partially written.
+
+@param fileName The file to replace.
+
+@param contents The new contents of the file.
+
+@return Wether the file was replaced.
+*/
+bool writeFileAtomically(const std::string& fileName, const std::string& contents);
+
+/**
+@brief Writes the settings from the given SettingsStruct to the settings.json file (synchronously).
 
 @param settings The settings struct to save to the file.
 */
@@ -28,8 +86,27 @@ void createSettingsFile();
 bool settingsFileExists();
 
 /**
-@brief Save settings to local variable and json file (also apply temporary settings).
+@brief Save settings to the settings cache and json file (also apply temporary settings).
 
 @param settings The settings to be applied.
 */
 void applySettings(const SettingsStruct& settings);
+
+/**
+@brief Compare two SettingsStructs.
+
+@param oldSettings The settings to compare against.
+
+@param newSettings The settings that might have changed.
+
+@return A combination of SETTINGS_CHANGED flags, one for every group of settings that differs.
+*/
+byte diffSettings(const SettingsStruct& oldSettings, const SettingsStruct& newSettings);
+
+/**
+@brief Apply only the parts of the settings that differ from the current ones, without saving them to the json file.
+		Should be called from the main window's thread.
+
+@param settings The new settings.
+*/
+void applyChangedSettings(const SettingsStruct& settings);
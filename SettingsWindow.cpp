@@ -1,10 +1,13 @@
 #include "SettingsWindow.h"
 #include "ResourceUtils.h"
 #include "CommCtrlUtils.h"
+#include "SettingsCache.h"
 #include "SettingsUtils.h"
 #include "BaseWindow.h"
 #include "Program.h"
 #include "ControllerManager.h"
+#include "HotkeyManager.h"
+#include "LatencyMonitor.h"
 #include <CommCtrl.h>
 #include <windowsx.h>
 #include <exception>
@@ -12,7 +15,10 @@
 void SettingsWindow::initializeWindow()
 {
 	// retrieve settings
-	tempSettings_ = getSafeSettingsStruct();
+	{
+		const SettingsReadScope readScope;
+		tempSettings_ = SettingsCache::get();
+	}
 
 	// Set up text
 	initializeTextControls();
@@ -171,6 +177,9 @@ void SettingsWindow::initializeButtonControls()
 	HWND hwndOkButton = createControl(WC_BUTTON, L"OK", SIZE_SETTINGS_WIDTH - 160, SIZE_SETTINGS_HEIGHT - 80, 50, 25, CID_OK);
 	HWND hwndCancelButton = createControl(WC_BUTTON, L"CANCEL", SIZE_SETTINGS_WIDTH - 100, SIZE_SETTINGS_HEIGHT - 80, 70, 25, CID_CANCEL);
 
+	// Input latency view
+	HWND hwndLatencyButton = createControl(WC_BUTTON, L"Latency", 120, SIZE_SETTINGS_HEIGHT - 80, 70, 25, CID_LATENCY);
+
 	// Apply font
 	setControlsFont(hwnd_);
 	
@@ -180,9 +189,9 @@ void SettingsWindow::initializeButtonControls()
 	}
 
 	// Apply currently set options
-	SendMessage(hCbStartOnChange, BM_SETCHECK, appSettings.optionStartOnChange, 0);
-	SendMessage(hCbTransparentBg, BM_SETCHECK, appSettings.optionTransparent, 0);
-	SendMessage(hCbClickthrough, BM_SETCHECK, appSettings.optionClickThrough, 0);
+	SendMessage(hCbStartOnChange, BM_SETCHECK, tempSettings_.optionStartOnChange, 0);
+	SendMessage(hCbTransparentBg, BM_SETCHECK, tempSettings_.optionTransparent, 0);
+	SendMessage(hCbClickthrough, BM_SETCHECK, tempSettings_.optionClickThrough, 0);
 }
 
 HWND SettingsWindow::createControl(
@@ -244,10 +253,16 @@ void SettingsWindow::handleControlCommand(const LPARAM lParam)
 	{
 		SetFocus(hwnd_);
 		hActiveControl_ = hwndCtrl;
+		pendingModifierKey_ = 0;
 		SetWindowText(hActiveControl_, L"...");
 		break;
 	}
 
+	// Latency
+	case CID_LATENCY:
+		showLatency();
+		break;
+
 	// Start on change checkbox
 	case CID_STARTONCHANGE_CB:
 		tempSettings_.optionStartOnChange = (Button_GetCheck(hwndCtrl) == BST_CHECKED);
@@ -354,12 +369,12 @@ void SettingsWindow::applyTempHotkey(const UINT key) {
 
 	if (controlId == CID_CON_START || controlId == CID_CON_TIMER1 || controlId == CID_CON_TIMER2 || controlId == CID_CON_START_NO_RESET) 
 	{
-		if (key == VK_ESCAPE)
+		if ((key & HOTKEY_KEY_MASK) == VK_ESCAPE)
 		{
 			applyTempConHotkey(ControllerButtons::Start);
 
 		}
-		else if (key == VK_LBUTTON)
+		else if ((key & HOTKEY_KEY_MASK) == VK_LBUTTON)
 		{
 			applyTempConHotkey(ControllerButtons::RightTrigger);
 		}
@@ -384,33 +399,103 @@ void SettingsWindow::applyTempHotkey(const UINT key) {
 		break;
 	}
 
-	SetWindowText(hActiveControl_, keyboardMap_[key]);
+	pendingModifierKey_ = 0;
+	SetWindowText(hActiveControl_, hotkeyText(key).c_str());
 	hActiveControl_ = nullptr;
 }
 
+void SettingsWindow::showLatency() const
+{
+	// Measuring is opt-in, so the hooks don't pay for it otherwise
+	if (!LatencyMonitor::isEnabled())
+	{
+		const int answer = MessageBox(hwnd_,
+			L"Measure how long the input hooks take until the app is closed?\nClick Latency again to see the results.",
+			L"Latency", MB_YESNO | MB_ICONQUESTION);
+
+		if (answer == IDYES) {
+			LatencyMonitor::setEnabled(true);
+		}
+		return;
+	}
+
+	const std::wstring text = LatencyMonitor::summary() + L"\nExport the histograms to " LATENCY_FILE_NAME L"?";
+
+	if (MessageBox(hwnd_, text.c_str(), L"Latency", MB_YESNO | MB_ICONINFORMATION) != IDYES) return;
+
+	if (!LatencyMonitor::exportCsv(LATENCY_FILE_NAME)) {
+		MessageBox(hwnd_, L"Failed to write " LATENCY_FILE_NAME L"!", L"Error", MB_OK);
+	}
+}
+
+int SettingsWindow::heldModifiers()
+{
+	int modifiers = 0;
+
+	// The key state as of the message being handled, not as of now
+	if (GetKeyState(VK_CONTROL) < 0) modifiers |= HOTKEY_CTRL;
+	if (GetKeyState(VK_SHIFT) < 0) modifiers |= HOTKEY_SHIFT;
+	if (GetKeyState(VK_MENU) < 0) modifiers |= HOTKEY_ALT;
+	if (GetKeyState(VK_LWIN) < 0 || GetKeyState(VK_RWIN) < 0) modifiers |= HOTKEY_WIN;
+
+	return modifiers;
+}
+
+void SettingsWindow::captureKeyDown(const UINT key)
+{
+	const int controlId = GetDlgCtrlID(hActiveControl_);
+	const bool isConControl = controlId == CID_CON_START || controlId == CID_CON_TIMER1 || controlId == CID_CON_TIMER2 || controlId == CID_CON_START_NO_RESET;
+
+	// Wait for the rest of the chord, the modifier is bound on it's own if it's released first
+	if (HotkeyManager::modifierOf(key) != 0 && !isConControl) {
+		pendingModifierKey_ = key;
+		SetWindowText(hActiveControl_, (hotkeyText(heldModifiers()) + L"...").c_str());
+		return;
+	}
+
+	applyTempHotkey(key | heldModifiers());
+}
+
+void SettingsWindow::captureKeyUp(const UINT key)
+{
+	if (key != pendingModifierKey_) return;
+
+	// A modifier doesn't modify itself
+	applyTempHotkey(key | (heldModifiers() & ~HotkeyManager::modifierOf(key)));
+}
+
+std::wstring SettingsWindow::hotkeyText(const int hotkey) const
+{
+	std::wstring text;
+
+	if (hotkey & HOTKEY_CTRL) text += L"CTRL+";
+	if (hotkey & HOTKEY_SHIFT) text += L"Shift+";
+	if (hotkey & HOTKEY_ALT) text += L"ALT+";
+	if (hotkey & HOTKEY_WIN) text += L"Win+";
+
+	const auto it = keyboardMap_.find(hotkey & HOTKEY_KEY_MASK);
+	if (it != keyboardMap_.end()) {
+		text += it->second;
+	}
+
+	return text;
+}
+
 void SettingsWindow::applyHotkeySavedKey(const HWND hCtrl) {
 	const int controlId = GetDlgCtrlID(hCtrl); // retrieve control ID
 
 	switch (controlId) {
 	case CID_START:
-		if (keyboardMap_.count(tempSettings_.startKey)) {
-			SetWindowText(hCtrl, keyboardMap_[tempSettings_.startKey]);
-		}
+		SetWindowText(hCtrl, hotkeyText(tempSettings_.startKey).c_str());
 		break;
 	case CID_TIMER1:
-		if (keyboardMap_.count(tempSettings_.timer1Key)) {
-			SetWindowText(hCtrl, keyboardMap_[tempSettings_.timer1Key]);
-		}
+		SetWindowText(hCtrl, hotkeyText(tempSettings_.timer1Key).c_str());
 		break;
 	case CID_TIMER2:
-		if (keyboardMap_.count(tempSettings_.timer2Key)) {
-			SetWindowText(hCtrl, keyboardMap_[tempSettings_.timer2Key]);
-		}
+		SetWindowText(hCtrl, hotkeyText(tempSettings_.timer2Key).c_str());
 		break;
 	case CID_START_NO_RESET:
-		if (keyboardMap_.count(tempSettings_.startNoResetKey)) {
-			SetWindowText(hCtrl, keyboardMap_[tempSettings_.startNoResetKey]);
-		}
+		SetWindowText(hCtrl, hotkeyText(tempSettings_.startNoResetKey).c_str());
 		break;
 	case CID_CON_START:
 		if (controllerMap_.count(tempSettings_.conStartKey)) {
@@ -466,36 +551,40 @@ LRESULT SettingsWindow::handleMessage(const UINT wMsg, const WPARAM wParam, cons
 			if (hActiveControl_)
 			{
 				const UINT key = HIWORD(wParam) == 1 ? VK_XBUTTON1 : VK_XBUTTON2;
-				applyTempHotkey(key);
+				applyTempHotkey(key | heldModifiers());
 			}
 			break;
 		case WM_MBUTTONDOWN:
 			if (hActiveControl_)
 			{
-				applyTempHotkey(VK_MBUTTON);
+				applyTempHotkey(VK_MBUTTON | heldModifiers());
 			}
 			break;
 		case WM_RBUTTONDOWN:
 			if (hActiveControl_)
 			{
-				applyTempHotkey(VK_RBUTTON);
+				applyTempHotkey(VK_RBUTTON | heldModifiers());
 			}
 			break;
 		case WM_LBUTTONDOWN:
 			if (hActiveControl_) {
-				applyTempHotkey(VK_LBUTTON);
+				applyTempHotkey(VK_LBUTTON | heldModifiers());
 			}
 			break;
 		case WM_KEYDOWN:
+		case WM_SYSKEYDOWN: // ALT and keys hit while ALT is held
 			if (hActiveControl_) {
 				const UINT key = (UINT)wParam;
-				applyTempHotkey(key);
+				captureKeyDown(key);
+				return 0; // Keeps ALT+F4 and F10 from reaching the system menu while capturing
 			}
 			break;
-		case WM_SYSKEYDOWN: // Specifically ALT key
-			if (hActiveControl_ && (UINT)wParam == VK_MENU) {
+		case WM_KEYUP:
+		case WM_SYSKEYUP:
+			if (hActiveControl_) {
 				const UINT key = (UINT)wParam;
-				applyTempHotkey(key);
+				captureKeyUp(key);
+				return 0;
 			}
 			break;
 		case CONTROLLER_INPUT:
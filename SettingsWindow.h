@@ -2,6 +2,7 @@
 #include "ColorPickerWindow.h"
 #include "Globals.h"
 #include <map>
+#include <string>
 
 // The class responsible for the settings window
 class SettingsWindow : public BaseWindow<SettingsWindow>
@@ -12,6 +13,7 @@ private:
 	HBITMAP mouseBitmap_ = nullptr;
 	HBITMAP controllerBitmap_ = nullptr;
 	HWND hActiveControl_ = nullptr;
+	UINT pendingModifierKey_ = 0; // A modifier hit while capturing a hotkey, bound on it's own if it's released before another key is hit
 
 	byte rows_ = 17;
 	byte cols_ = 11;
@@ -99,6 +101,37 @@ private:
 	*/
 	void applyTempHotkey(UINT key);
 
+	/**
+	@brief Show the input latency measurements and offer to export them, or offer to start measuring.
+	*/
+	void showLatency() const;
+
+	/**
+	@return The HOTKEY_ modifiers that were held when the message being handled was sent.
+	*/
+	static int heldModifiers();
+
+	/**
+	@brief Capture a key going down while a hotkey control is selected. Modifiers wait for the rest of the chord.
+
+	@param key The virtual key that the user hit.
+	*/
+	void captureKeyDown(UINT key);
+
+	/**
+	@brief Capture a key going up while a hotkey control is selected, which binds a lone modifier.
+
+	@param key The virtual key that the user released.
+	*/
+	void captureKeyUp(UINT key);
+
+	/**
+	@param hotkey A keyboard hotkey, a virtual key with HOTKEY_ modifiers.
+
+	@return The text to display for the hotkey, like "CTRL+F1".
+	*/
+	std::wstring hotkeyText(int hotkey) const;
+
 	/**
 	@brief Set the text of the given control to it's saved value in the tempSettings_ struct.
 
@@ -0,0 +1,78 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+// Bounded undo and redo history of snapshots, in a fixed array.
+// Pushing, undoing and redoing never allocate, once the ring is full a push overwrites the oldest snapshot.
+template <class T, size_t N> class SnapshotRing
+{
+	static_assert(N != 0, "A SnapshotRing needs room for at least one snapshot");
+
+private:
+	T items_[N];
+
+	// The undo snapshots are the undoCount_ slots below top_, the redo snapshots the redoCount_ slots from it on.
+	// Together they never take more than the N slots.
+	size_t top_ = 0;
+	size_t undoCount_ = 0;
+	size_t redoCount_ = 0;
+
+public:
+	SnapshotRing() = default;
+
+	// Prevent copying of the history
+
+	SnapshotRing(const SnapshotRing& other) = delete;
+
+	SnapshotRing& operator=(const SnapshotRing& other) = delete;
+
+	/**
+	@brief Remember the state from before a change. Drops the redo history, which the change made obsolete.
+
+	@param before The state before the change.
+	*/
+	void push(const T& before)
+	{
+		items_[top_ % N] = before;
+		top_++;
+		undoCount_ = std::min(undoCount_ + 1, N);
+		redoCount_ = 0;
+	}
+
+	/**
+	@brief Step back to the last remembered state, and remember the current one for redo.
+
+	@param state The current state, receives the state to go back to.
+
+	@return Wether there was a state to go back to.
+	*/
+	bool undo(T& state)
+	{
+		if (undoCount_ == 0) return false;
+
+		top_--;
+		std::swap(items_[top_ % N], state);
+		undoCount_--;
+		redoCount_++;
+		return true;
+	}
+
+	/**
+	@brief Step forward to the state the last undo went back from, and remember the current one for undo.
+
+	@param state The current state, receives the state to go forward to.
+
+	@return Wether there was a state to go forward to.
+	*/
+	bool redo(T& state)
+	{
+		if (redoCount_ == 0) return false;
+
+		std::swap(items_[top_ % N], state);
+		top_++;
+		redoCount_--;
+		undoCount_++;
+		return true;
+	}
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Bounded queue for exactly one producer thread and one consumer thread.
+// Pushing and popping never block or allocate, a full ring rejects new items instead of waiting.
+template <class T, size_t N> class SpscRing
+{
+	static_assert(N != 0 && (N & (N - 1)) == 0, "The capacity of a SpscRing must be a power of two");
+
+private:
+	T items_[N];
+
+	// The indexes only ever grow, their difference is the number of queued items.
+	// Each one is written by a single side and lives on it's own cache line.
+	alignas(64) std::atomic<size_t> head_; // next item to pop, written by the consumer
+	alignas(64) std::atomic<size_t> tail_; // next free slot, written by the producer
+
+public:
+	SpscRing()
+	{
+		head_ = 0;
+		tail_ = 0;
+	}
+
+	// Prevent copying of the queued items
+
+	SpscRing(const SpscRing& other) = delete;
+
+	SpscRing& operator=(const SpscRing& other) = delete;
+
+	/**
+	@brief Queue an item. Should only be called from the producer thread.
+
+	@param item The item to queue.
+
+	@return Wether the item was queued, false if the ring is full.
+	*/
+	bool tryPush(const T& item)
+	{
+		const size_t tail = tail_.load(std::memory_order_relaxed);
+
+		if (tail - head_.load(std::memory_order_acquire) == N) return false;
+
+		items_[tail & (N - 1)] = item;
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	@brief Read the oldest item without removing it. Should only be called from the consumer thread.
+
+	@param item Receives the oldest item.
+
+	@return Wether there was an item, false if the ring is empty.
+	*/
+	bool peek(T& item) const
+	{
+		const size_t head = head_.load(std::memory_order_relaxed);
+
+		if (head == tail_.load(std::memory_order_acquire)) return false;
+
+		item = items_[head & (N - 1)];
+		return true;
+	}
+
+	/**
+	@brief Remove the oldest item. Should only be called from the consumer thread.
+
+	@param item Receives the removed item.
+
+	@return Wether there was an item, false if the ring is empty.
+	*/
+	bool tryPop(T& item)
+	{
+		if (!peek(item)) return false;
+
+		head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		return true;
+	}
+};
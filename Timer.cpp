@@ -3,25 +3,10 @@
 
 using std::wstring;
 
-int Timer::subtractTimes(const SYSTEMTIME t1, const SYSTEMTIME t2)
-{
-	const int t1Millis = (t1.wMinute * 60 * 1000) + (t1.wSecond * 1000) + t1.wMilliseconds;
-	int t2Millis = (t2.wMinute * 60 * 1000) + (t2.wSecond * 1000) + t2.wMilliseconds;
-
-	if (t1Millis > t2Millis) {
-		t2Millis += (60 * 60 * 1000);
-	}
-
-	const int millis = t2Millis - t1Millis;
-
-	return millis;
-}
-
 Timer::Timer():
 	timerState_(TimerState::Zero),
 	time_(0),
-	lastUpdateTime_(),
-	updatingTime_() { }
+	lastUpdateTime_(0) { }
 
 TimerState Timer::getTimerState() const
 {
@@ -105,15 +90,17 @@ int Timer::getTimeInMillis() const
 	return time_;
 }
 
-void Timer::startTimer()
+void Timer::startTimer(const uint32_t time)
 {
+	// Before the state, so an update from the app loop never counts from a stale time
+	lastUpdateTime_ = time;
 	timerState_ = TimerState::Running;
-	GetSystemTime(&lastUpdateTime_);
-	GetSystemTime(&updatingTime_);
 }
 
-void Timer::stopTimer()
+void Timer::stopTimer(const uint32_t time)
 {
+	// Count the time since the last update, which would be lost otherwise
+	updateTime(time);
 	timerState_ = TimerState::Paused;
 }
 
@@ -124,16 +111,32 @@ void Timer::resetTimer()
 	runningTime_ = 0;
 }
 
-void Timer::updateTime()
+void Timer::updateTime(const uint32_t time)
 {
 	if (timerState_ == TimerState::Running)
 	{
-		GetSystemTime(&updatingTime_);
-		time_ += subtractTimes(lastUpdateTime_, updatingTime_);
-		GetSystemTime(&lastUpdateTime_);
+		// Signed, so an update from before the last one takes it's time back off
+		time_ += (int32_t)(time - lastUpdateTime_);
+		lastUpdateTime_ = time;
 	}
 }
 
+TimerSnapshot Timer::snapshot(const uint32_t time) const
+{
+	const int32_t unsavedTime = timerState_ == TimerState::Running ? (int32_t)(time - lastUpdateTime_) : 0;
+	return { time_ + unsavedTime, time, timerState_ };
+}
+
+void Timer::restore(const TimerSnapshot& snapshot, const uint32_t time)
+{
+	time_ = snapshot.time;
+	runningTime_ = 0;
+	lastUpdateTime_ = snapshot.updateTime;
+	timerState_ = snapshot.state;
+
+	updateTime(time);
+}
+
 void Timer::draw(
 	ID2D1HwndRenderTarget* pRenderTarget, 
 	IDWriteTextFormat* pTextFormat, 
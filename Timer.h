@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include "enums.h"
 #include <d2d1.h>
@@ -12,25 +13,24 @@ enum TimerState : std::uint8_t
 	Zero = 2
 };
 
+// The state of a timer at a point in time, enough to put it back exactly
+struct TimerSnapshot
+{
+	int32_t time; // milliseconds, counted up to updateTime
+	uint32_t updateTime; // the AppClock time the snapshot was taken at
+	TimerState state;
+
+	bool operator==(const TimerSnapshot& other) const { return time == other.time && updateTime == other.updateTime && state == other.state; }
+	bool operator!=(const TimerSnapshot& other) const { return !(*this == other); }
+};
+
 class Timer
 {
 private:
 	TimerState timerState_;
 	int time_ = 0; // in milliseconds
 	int runningTime_ = 0; // in milliseconds
-	SYSTEMTIME lastUpdateTime_;
-	SYSTEMTIME updatingTime_;
-
-	/**
-	@brief Calculates the difference between two SYSTEMTIMEs.
-
-	@param t1 The first SYSTEMTIME.
-
-	@param t2 The second SYSTEMTIME.
-
-	@return The difference between the two SYSTEMTIMEs as an integer.
-	*/
-	static int subtractTimes(SYSTEMTIME t1, SYSTEMTIME t2);
+	uint32_t lastUpdateTime_; // AppClock milliseconds
 
 public:
 	Timer();
@@ -56,13 +56,17 @@ public:
 
 	/**
 	@brief Start the timer.
+
+	@param time The AppClock time to start counting from, the time stamp of the input that started it.
 	*/
-	void startTimer();
+	void startTimer(uint32_t time);
 
 	/**
-	@brief Stpo the timer.
+	@brief Stop the timer, counting up to the given time.
+
+	@param time The AppClock time to stop at, the time stamp of the input that stopped it.
 	*/
-	void stopTimer();
+	void stopTimer(uint32_t time);
 
 	/**
 	@brief Reset the timer.
@@ -71,8 +75,29 @@ public:
 
 	/**
 	@brief Update the timer's saved time (Increment it).
+			The time may be a little behind the last update, when an input is handled after it's stamp.
+			The differences add up to the exact time between start and stop either way.
+
+	@param time The current AppClock time.
+	*/
+	void updateTime(uint32_t time);
+
+	/**
+	@param time The AppClock time to take the snapshot at, a running timer counts up to it.
+
+	@return The timer's state at the time.
+	*/
+	TimerSnapshot snapshot(uint32_t time) const;
+
+	/**
+	@brief Put the timer back in the state of a snapshot. A timer that was running counts the time since the snapshot as well,
+			as if it had kept running.
+
+	@param snapshot The state to put back.
+
+	@param time The current AppClock time.
 	*/
-	void updateTime();
+	void restore(const TimerSnapshot& snapshot, uint32_t time);
 
 	/**
 	@brief draws the wstring format of the timer's time to a render target.
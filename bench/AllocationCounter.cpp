@@ -0,0 +1,167 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	std::atomic<uint64_t> allocationCount(0);
+	std::atomic<uint64_t> allocatedBytes(0);
+	std::atomic<uint64_t> peakAllocatedBytes(0);
+
+	void* allocate(const std::size_t size)
+	{
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+		void* const p = std::malloc(size != 0 ? size : 1);
+		if (p == nullptr) throw std::bad_alloc();
+		return p;
+	}
+}
+
+void* operator new(const std::size_t size) { return allocate(size); }
+void* operator new[](const std::size_t size) { return allocate(size); }
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size != 0 ? size : 1);
+}
+void* operator new[](const std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+#ifdef __GLIBC__
+// The bytes are counted below operator new, jsoncpp allocates it's strings with malloc
+extern "C"
+{
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* p, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void* p);
+}
+
+namespace
+{
+	void addBytes(const void* p)
+	{
+		if (p == nullptr) return;
+
+		const uint64_t size = malloc_usable_size(const_cast<void*>(p));
+		const uint64_t bytes = allocatedBytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+		uint64_t peak = peakAllocatedBytes.load(std::memory_order_relaxed);
+		while (bytes > peak && !peakAllocatedBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {}
+	}
+
+	void removeBytes(void* p)
+	{
+		if (p == nullptr) return;
+
+		allocatedBytes.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+	}
+}
+
+extern "C"
+{
+	void* malloc(size_t size)
+	{
+		void* const p = __libc_malloc(size);
+		addBytes(p);
+		return p;
+	}
+
+	void* calloc(size_t count, size_t size)
+	{
+		void* const p = __libc_calloc(count, size);
+		addBytes(p);
+		return p;
+	}
+
+	void* realloc(void* p, size_t size)
+	{
+		const uint64_t oldSize = p != nullptr ? malloc_usable_size(p) : 0;
+		void* const pNew = __libc_realloc(p, size);
+
+		// A failed realloc leaves the old block alone, one to size 0 frees it
+		if (pNew != nullptr || size == 0)
+		{
+			allocatedBytes.fetch_sub(oldSize, std::memory_order_relaxed);
+			addBytes(pNew);
+		}
+		return pNew;
+	}
+
+	void* memalign(size_t alignment, size_t size)
+	{
+		void* const p = __libc_memalign(alignment, size);
+		addBytes(p);
+		return p;
+	}
+
+	void* aligned_alloc(size_t alignment, size_t size)
+	{
+		return memalign(alignment, size);
+	}
+
+	int posix_memalign(void** pp, size_t alignment, size_t size)
+	{
+		if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+
+		void* const p = memalign(alignment, size);
+		if (p == nullptr) return ENOMEM;
+
+		*pp = p;
+		return 0;
+	}
+
+	void free(void* p)
+	{
+		removeBytes(p);
+		__libc_free(p);
+	}
+}
+#endif
+
+uint64_t AllocationCounter::count()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+void AllocationCounter::report(benchmark::State& state, const uint64_t countBefore)
+{
+	state.counters["allocations"] = benchmark::Counter((double)(count() - countBefore), benchmark::Counter::kAvgIterations);
+}
+
+uint64_t AllocationCounter::resetPeak()
+{
+	const uint64_t bytes = allocatedBytes.load(std::memory_order_relaxed);
+	peakAllocatedBytes.store(bytes, std::memory_order_relaxed);
+	return bytes;
+}
+
+uint64_t AllocationCounter::peakBytes()
+{
+	return peakAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+void AllocationCounter::reportPeak(benchmark::State& state, const uint64_t bytesBefore)
+{
+#ifdef __GLIBC__
+	state.counters["peak_bytes"] = benchmark::Counter((double)(peakBytes() - bytesBefore), benchmark::Counter::kDefaults,
+		benchmark::Counter::kIs1024);
+#else
+	(void)state;
+	(void)bytesBefore;
+#endif
+}
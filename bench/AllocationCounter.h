@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+
+namespace benchmark
+{
+	class State;
+}
+
+// Counts the calls to operator new of the whole process, and with glibc the heap bytes it holds at most.
+// Linked into every benchmark, so they can report how many allocations an iteration makes and how much memory it peaks at.
+class AllocationCounter
+{
+public:
+	/**
+	@return The number of allocations made since the process started.
+	*/
+	static uint64_t count();
+
+	/**
+	@brief Report the allocations made since a count as an "allocations" counter, averaged over the benchmark's iterations.
+
+	@param state The state of the running benchmark.
+
+	@param countBefore The count taken before the benchmark's loop.
+	*/
+	static void report(benchmark::State& state, uint64_t countBefore);
+
+	/**
+	@brief Start measuring a new peak from the bytes allocated right now.
+
+	@return The bytes allocated right now, what peakBytes() is measured against.
+	*/
+	static uint64_t resetPeak();
+
+	/**
+	@return The most bytes allocated at once since the last resetPeak().
+	*/
+	static uint64_t peakBytes();
+
+	/**
+	@brief Report how far the allocated bytes grew over a resetPeak() as a "peak_bytes" counter. Left out without glibc,
+			where the heap bytes aren't counted.
+
+	@param state The state of the running benchmark.
+
+	@param bytesBefore What resetPeak() returned.
+	*/
+	static void reportPeak(benchmark::State& state, uint64_t bytesBefore);
+};
@@ -0,0 +1,77 @@
+// Parsing and freeing whole documents with Json::ValueArena, against the heap of the same build
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+#include "JsonDocuments.h"
+#include "json/json.h"
+
+namespace
+{
+	bool parse(Json::CharReader& reader, const std::string& text, Json::Value& root)
+	{
+		return reader.parse(text.data(), text.data() + text.size(), &root, nullptr);
+	}
+
+	// Each iteration parses the document and destroys the tree again, which is where the arena saves the most
+	void BM_ParseHeap(benchmark::State& state)
+	{
+		const DocumentSize size = (DocumentSize)state.range(0);
+		const std::string& text = jsonDocument(size);
+
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			Json::Value root;
+			if (!parse(*pReader, text, root)) {
+				state.SkipWithError("the document didn't parse");
+			}
+			benchmark::DoNotOptimize(root);
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)text.size());
+		state.SetLabel(documentSizeName(size));
+	}
+
+	void BM_ParseArena(benchmark::State& state)
+	{
+		const DocumentSize size = (DocumentSize)state.range(0);
+		const std::string& text = jsonDocument(size);
+
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		size_t blockCount = 0;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			Json::ValueArena arena;
+			{
+				// The tree has to be destroyed before the arena that holds it
+				Json::Value root;
+				{
+					Json::ValueArena::Scope scope(arena);
+					if (!parse(*pReader, text, root)) {
+						state.SkipWithError("the document didn't parse");
+					}
+				}
+				benchmark::DoNotOptimize(root);
+			}
+			blockCount = arena.blockCount();
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.counters["arenaBlocks"] = (double)blockCount;
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)text.size());
+		state.SetLabel(documentSizeName(size));
+	}
+}
+
+BENCHMARK(BM_ParseHeap)->DenseRange(DOCUMENT_SMALL, DOCUMENT_LARGE)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseArena)->DenseRange(DOCUMENT_SMALL, DOCUMENT_LARGE)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,128 @@
+// How much memory parsing a json file peaks at: a Json::Document parsing a copy-on-write view of the file in place,
+// against the reader building the same tree from a read only view, and a document that copies the text
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+#include "JsonDocuments.h"
+#include "MappedFile.h"
+#include "json/json.h"
+
+namespace
+{
+	/**
+	@brief Write a document to a file, once per size. The medium and large ones are mapped, the small one is buffered.
+
+	@param size The size of the document.
+
+	@return The name of the file.
+	*/
+	std::string documentFile(const DocumentSize size)
+	{
+		const std::string fileName = std::string("document_bench_") + documentSizeName(size) + ".json";
+		const std::string& text = jsonDocument(size);
+
+		std::ifstream existingFile(fileName, std::ios::binary | std::ios::ate);
+		if (!existingFile || (size_t)existingFile.tellg() != text.size())
+		{
+			std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+			file.write(text.data(), (std::streamsize)text.size());
+		}
+
+		return fileName;
+	}
+
+	/**
+	@brief Report the peak and the allocations of the benchmark's iterations.
+	*/
+	void report(benchmark::State& state, const uint64_t allocationsBefore, const uint64_t bytesBefore, const int64_t fileSize)
+	{
+		AllocationCounter::report(state, allocationsBefore);
+		AllocationCounter::reportPeak(state, bytesBefore);
+		state.SetBytesProcessed((int64_t)state.iterations() * fileSize);
+		state.SetLabel(documentSizeName((DocumentSize)state.range(0)));
+	}
+
+	void BM_ReaderReadOnly(benchmark::State& state)
+	{
+		const std::string fileName = documentFile((DocumentSize)state.range(0));
+
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		int64_t fileSize = 0;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		const uint64_t bytesBefore = AllocationCounter::resetPeak();
+		for (auto _ : state)
+		{
+			MappedFile file;
+			Json::Value root;
+			if (!file.open(fileName) || !pReader->parse(file.data(), file.data() + file.size(), &root, nullptr)) {
+				state.SkipWithError("the file didn't parse");
+			}
+			benchmark::DoNotOptimize(root);
+			fileSize = (int64_t)file.size();
+		}
+
+		report(state, allocationsBefore, bytesBefore, fileSize);
+	}
+
+	// What a document costs without a writable view to parse in
+	void BM_DocumentCopy(benchmark::State& state)
+	{
+		const std::string fileName = documentFile((DocumentSize)state.range(0));
+
+		int64_t fileSize = 0;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		const uint64_t bytesBefore = AllocationCounter::resetPeak();
+		for (auto _ : state)
+		{
+			MappedFile file;
+			Json::Document document;
+			if (!file.open(fileName) || !document.parse(Json::String(file.data(), file.size()), nullptr)) {
+				state.SkipWithError("the file didn't parse");
+			}
+			benchmark::DoNotOptimize(document.root());
+			fileSize = (int64_t)file.size();
+		}
+
+		report(state, allocationsBefore, bytesBefore, fileSize);
+	}
+
+	// The document keeps the view alive, only the pages holding a borrowed string's end are copied
+	void BM_DocumentCopyOnWrite(benchmark::State& state)
+	{
+		const std::string fileName = documentFile((DocumentSize)state.range(0));
+
+		int64_t fileSize = 0;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		const uint64_t bytesBefore = AllocationCounter::resetPeak();
+		for (auto _ : state)
+		{
+			const std::shared_ptr<MappedFile> pFile = std::make_shared<MappedFile>();
+			Json::Document document;
+			if (!pFile->open(fileName, true)
+				|| !document.parse(pFile->writableData(), pFile->writableData() + pFile->size(), pFile, nullptr))
+			{
+				state.SkipWithError("the file didn't parse");
+			}
+			benchmark::DoNotOptimize(document.root());
+			fileSize = (int64_t)pFile->size();
+		}
+
+		report(state, allocationsBefore, bytesBefore, fileSize);
+
+		// Writing to the view must never reach the file
+		MappedFile file;
+		if (!file.open(fileName) || std::string(file.data(), file.size()) != jsonDocument((DocumentSize)state.range(0))) {
+			state.SkipWithError("parsing changed the file");
+		}
+	}
+}
+
+BENCHMARK(BM_ReaderReadOnly)->DenseRange(DOCUMENT_SMALL, DOCUMENT_LARGE)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DocumentCopy)->DenseRange(DOCUMENT_SMALL, DOCUMENT_LARGE)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DocumentCopyOnWrite)->DenseRange(DOCUMENT_SMALL, DOCUMENT_LARGE)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,142 @@
+// Json::EventWriter against building a Json::Value and writing it with StreamWriterBuilder, for the same output
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+#include "json/json.h"
+
+namespace
+{
+	// A record of an exported history, members in key order so both writers order them the same
+	struct Record
+	{
+		bool active;
+		int id;
+		std::string name;
+		double score;
+		int64_t time;
+	};
+
+	std::vector<Record> makeRecords(const int64_t count)
+	{
+		std::vector<Record> records;
+		uint32_t state = 0x5EED;
+		for (int64_t i = 0; i < count; i++)
+		{
+			state = state * 1664525u + 1013904223u;
+			records.push_back({ (state & 1) != 0, (int)i, "Player " + std::to_string(state % 100000),
+				(double)(state % 1000000) / 100.0, (int64_t)i * 1000 + (state % 1000) });
+		}
+		return records;
+	}
+
+	void writeEvents(Json::EventWriter& writer, const std::vector<Record>& records)
+	{
+		writer.clear();
+		writer.objectBegin();
+		writer.key("records").arrayBegin();
+		for (const Record& record : records)
+		{
+			writer.objectBegin();
+			writer.key("active").value(record.active);
+			writer.key("id").value(record.id);
+			writer.key("name").value(record.name);
+			writer.key("score").value(record.score);
+			writer.key("time").value((Json::Int64)record.time);
+			writer.objectEnd();
+		}
+		writer.arrayEnd();
+		writer.key("version").value(1);
+		writer.objectEnd();
+	}
+
+	std::string writeTree(const Json::StreamWriterBuilder& builder, const std::vector<Record>& records)
+	{
+		Json::Value root(Json::objectValue);
+		Json::Value& array = root["records"] = Json::Value(Json::arrayValue);
+		for (const Record& record : records)
+		{
+			Json::Value& value = array.append(Json::Value(Json::objectValue));
+			value["active"] = record.active;
+			value["id"] = record.id;
+			value["name"] = record.name;
+			value["score"] = record.score;
+			value["time"] = (Json::Int64)record.time;
+		}
+		root["version"] = 1;
+		return Json::writeString(builder, root);
+	}
+
+	Json::Value parse(const std::string& text)
+	{
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		Json::Value root;
+		pReader->parse(text.data(), text.data() + text.size(), &root, nullptr);
+		return root;
+	}
+
+	const char* indentationName(const int64_t isIndented)
+	{
+		return isIndented != 0 ? "indented" : "compact";
+	}
+
+	// Arguments: the number of records, and wether the output is indented
+	void BM_EventWriter(benchmark::State& state)
+	{
+		const std::vector<Record> records = makeRecords(state.range(0));
+		Json::EventWriter writer(state.range(1) != 0 ? "\t" : "");
+
+		// Indented arrays are laid out differently, so compare what the outputs hold
+		Json::StreamWriterBuilder builder;
+		builder["indentation"] = state.range(1) != 0 ? "\t" : "";
+		writeEvents(writer, records);
+		if (!(parse(writer.str()) == parse(writeTree(builder, records)))) {
+			state.SkipWithError("the writers' outputs differ");
+		}
+
+		size_t writtenSize = 0;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			// One writer for every document, like the settings save
+			writeEvents(writer, records);
+			writtenSize = writer.size();
+			benchmark::DoNotOptimize(writer.data());
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)writtenSize);
+		state.SetLabel(indentationName(state.range(1)));
+	}
+
+	void BM_StreamWriterBuilder(benchmark::State& state)
+	{
+		const std::vector<Record> records = makeRecords(state.range(0));
+
+		Json::StreamWriterBuilder builder;
+		builder["indentation"] = state.range(1) != 0 ? "\t" : "";
+
+		size_t writtenSize = 0;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			const std::string text = writeTree(builder, records);
+			writtenSize = text.size();
+			benchmark::DoNotOptimize(text.data());
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)writtenSize);
+		state.SetLabel(indentationName(state.range(1)));
+	}
+}
+
+// About the size of a settings file, and of small and large history exports
+BENCHMARK(BM_EventWriter)->ArgsProduct({ { 4, 1000, 100000 }, { 0, 1 } })->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_StreamWriterBuilder)->ArgsProduct({ { 4, 1000, 100000 }, { 0, 1 } })->Unit(benchmark::kMicrosecond);
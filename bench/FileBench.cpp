@@ -0,0 +1,131 @@
+// Reading and parsing json files from 1 KB to 100 MB, through MappedFile against copying them out of an ifstream
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+#include "JsonDocuments.h"
+#include "MappedFile.h"
+#include "json/json.h"
+
+namespace
+{
+	constexpr int64_t KB = 1024;
+	constexpr int64_t MB = 1024 * KB;
+
+	/**
+	@brief Write a json file of about the given size, once per size. It stays in the page cache, so the benchmarks compare
+			the ways of getting at the contents rather than the disk.
+
+	@param size The size of the file, in bytes.
+
+	@return The name of the file.
+	*/
+	std::string jsonFile(int64_t size)
+	{
+		const std::string fileName = "file_bench_" + std::to_string(size) + ".json";
+
+		std::ifstream existingFile(fileName, std::ios::binary | std::ios::ate);
+		if (existingFile && (int64_t)existingFile.tellg() >= size) {
+			return fileName;
+		}
+
+		// An array of settings sized documents, as many as it takes
+		const std::string& record = jsonDocument(DOCUMENT_SMALL);
+		std::string text = "[";
+		while ((int64_t)text.size() < size)
+		{
+			if (text.size() > 1) {
+				text += ',';
+			}
+			text += record;
+		}
+		text += ']';
+
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		file.write(text.data(), (std::streamsize)text.size());
+
+		return fileName;
+	}
+
+	bool parse(const benchmark::State& state, const char* begin, const char* end)
+	{
+		if (!state.range(1)) {
+			// Touch every page, a view that's never read costs nothing
+			size_t sum = 0;
+			for (const char* pChar = begin; pChar < end; pChar += 4096) {
+				sum += *pChar;
+			}
+			benchmark::DoNotOptimize(sum);
+
+			return true;
+		}
+
+		Json::ParseEventHandler handler;
+		return Json::parseEvents(begin, end, handler, nullptr);
+	}
+
+	// Around MappedFile::mapThreshold and up to far larger than any settings file, then only reading the contents or also
+	// parsing them, which takes far longer than the read and hides the difference
+	void fileSizes(benchmark::internal::Benchmark* pBenchmark)
+	{
+		pBenchmark->ArgsProduct({ { 1 * KB, 16 * KB, 64 * KB, 1 * MB, 10 * MB, 100 * MB }, { 0, 1 } });
+	}
+
+	const char* stepName(const benchmark::State& state)
+	{
+		return state.range(1) ? "parse" : "read";
+	}
+
+	// How readSettingsFileContents read the file before MappedFile
+	void BM_ReadStream(benchmark::State& state)
+	{
+		const std::string fileName = jsonFile(state.range(0));
+
+		int64_t bytes = 0;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			const std::ifstream file(fileName, std::ios::binary);
+			std::ostringstream contents;
+			contents << file.rdbuf();
+
+			const std::string text = contents.str();
+			if (!parse(state, text.data(), text.data() + text.size())) {
+				state.SkipWithError("the file didn't parse");
+			}
+			bytes += (int64_t)text.size();
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed(bytes);
+		state.SetLabel(stepName(state));
+	}
+
+	void BM_ReadMapped(benchmark::State& state)
+	{
+		const std::string fileName = jsonFile(state.range(0));
+
+		int64_t bytes = 0;
+		bool isMapped = false;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			MappedFile file;
+			if (!file.open(fileName) || !parse(state, file.data(), file.data() + file.size())) {
+				state.SkipWithError("the file didn't parse");
+			}
+			bytes += (int64_t)file.size();
+			isMapped = file.isMapped();
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed(bytes);
+		state.SetLabel(std::string(stepName(state)) + (isMapped ? " mapped" : " buffered"));
+	}
+}
+
+BENCHMARK(BM_ReadStream)->Apply(fileSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ReadMapped)->Apply(fileSizes)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,256 @@
+// The input path, from a key reaching the hook to the main window applying the queued action
+#include <atomic>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+#include "HotkeyManager.h"
+#include "InputQueue.h"
+#include "LatencyMonitor.h"
+#include "SettingsUtils.h"
+
+namespace
+{
+	char mainWindow; // only compared against nullptr, messages go to the stand-in PostMessage
+
+	void bindHotkeys()
+	{
+		HotkeyManager::setHotkeysMap({ { VK_F1, KEY_TIMER1 }, { HOTKEY_CTRL | VK_F2, KEY_TIMER2 } });
+		hwndMainWindow = reinterpret_cast<HWND>(&mainWindow);
+	}
+
+	// The hotkey lookup before the flat tables: a hash map from the key to a single action
+	class MapHotkeys
+	{
+	private:
+		std::unordered_map<int, int> hotkeysMap_;
+
+	public:
+		explicit MapHotkeys(const SettingsStruct& settings)
+		{
+			hotkeysMap_.insert({ settings.startKey, KEY_START });
+			hotkeysMap_.insert({ settings.startNoResetKey, KEY_START_NO_RESET });
+			hotkeysMap_.insert({ settings.timer1Key, KEY_TIMER1 });
+			hotkeysMap_.insert({ settings.timer2Key, KEY_TIMER2 });
+
+			hotkeysMap_.insert({ settings.conStartKey, KEY_START });
+			hotkeysMap_.insert({ settings.conStartNoResetKey, KEY_START_NO_RESET });
+			hotkeysMap_.insert({ settings.conTimer1Key, KEY_TIMER1 });
+			hotkeysMap_.insert({ settings.conTimer2Key, KEY_TIMER2 });
+		}
+
+		int findAction(const int keyCode) const
+		{
+			const auto it = hotkeysMap_.find(keyCode);
+			return it != hotkeysMap_.end() ? it->second : HotkeyManager::NO_ACTION;
+		}
+
+		// What the hook did with every key down
+		void execute(const int keyCode) const
+		{
+			const int action = findAction(keyCode);
+			if (action != HotkeyManager::NO_ACTION && hwndMainWindow != nullptr) {
+				InputQueue::pushHotkey(action, 0);
+			}
+		}
+	};
+
+	/**
+	@return Keys typed while playing, mostly unbound letters with the default hotkeys and modifiers in between.
+			Generated with a fixed seed, so every run presses the same keys.
+	*/
+	const std::vector<int>& keystrokes()
+	{
+		static std::vector<int> keys;
+
+		if (keys.empty())
+		{
+			const SettingsStruct settings;
+			const int hotkeys[] = { settings.startKey, settings.startNoResetKey, settings.timer1Key, settings.timer2Key, VK_LSHIFT, VK_SPACE };
+
+			std::mt19937 random(42);
+			for (int i = 0; i < 4096; i++) {
+				keys.push_back(random() % 4 == 0 ? hotkeys[random() % 6] : 'A' + (int)(random() % 26));
+			}
+		}
+
+		return keys;
+	}
+
+	// What the main window does with a drained event, the latency from the push is the only thing it needs
+	LONGLONG applyEvent(const InputEvent& event)
+	{
+		return LatencyMonitor::now() - event.time;
+	}
+
+	// The hook and the main window on the same thread, so only the cost of queueing and draining is timed
+	void BM_KeyToApply(benchmark::State& state)
+	{
+		bindHotkeys();
+
+		DWORD time = 0;
+		InputEvent event;
+		bool isHotkey;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			HotkeyManager::keyDown(VK_F1, ++time);
+			HotkeyManager::keyUp(VK_F1);
+
+			InputQueue::beginDrain();
+			while (InputQueue::pop(event, isHotkey)) {
+				benchmark::DoNotOptimize(applyEvent(event));
+			}
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+	}
+
+	// The lookup alone
+	void BM_LookupMap(benchmark::State& state)
+	{
+		const MapHotkeys hotkeys((SettingsStruct()));
+
+		const std::vector<int>& keys = keystrokes();
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(hotkeys.findAction(keys[i]));
+			i = (i + 1) % keys.size();
+		}
+	}
+
+	void BM_LookupTable(benchmark::State& state)
+	{
+		HotkeyManager::setHotkeysMap(SettingsStruct());
+
+		const std::vector<int>& keys = keystrokes();
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(HotkeyManager::findActions(keys[i]));
+			i = (i + 1) % keys.size();
+		}
+	}
+
+	// Per keystroke, without a main window so nothing is queued and only the hook's own work is timed
+	void BM_HookMap(benchmark::State& state)
+	{
+		const MapHotkeys hotkeys((SettingsStruct()));
+		hwndMainWindow = nullptr;
+
+		const std::vector<int>& keys = keystrokes();
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			hotkeys.execute(keys[i]);
+			i = (i + 1) % keys.size();
+		}
+	}
+
+	void BM_HookTable(benchmark::State& state)
+	{
+		HotkeyManager::setHotkeysMap(SettingsStruct());
+		hwndMainWindow = nullptr;
+
+		const std::vector<int>& keys = keystrokes();
+		size_t i = 0;
+		DWORD time = 0;
+		for (auto _ : state)
+		{
+			HotkeyManager::keyDown(keys[i], time += 100);
+			HotkeyManager::keyUp(keys[i]);
+			i = (i + 1) % keys.size();
+		}
+	}
+
+	// A probe with the monitor off (0) and on (1)
+	void BM_LatencyScope(benchmark::State& state)
+	{
+		LatencyMonitor::setEnabled(state.range(0) != 0);
+
+		for (auto _ : state) {
+			const LatencyScope latencyScope(LATENCY_HOTKEY_LOOKUP);
+		}
+
+		LatencyMonitor::setEnabled(false);
+		state.SetLabel(state.range(0) ? "monitored" : "off");
+	}
+
+	// The whole hook with the monitor off and on, keyDown holds a probe
+	void BM_HookTableMonitored(benchmark::State& state)
+	{
+		LatencyMonitor::setEnabled(state.range(0) != 0);
+		BM_HookTable(state);
+		LatencyMonitor::setEnabled(false);
+
+		state.SetLabel(state.range(0) ? "monitored" : "off");
+	}
+
+	// The hook on it's own thread, one key at a time. The main window polls instead of waiting for INPUT_EVENTS,
+	// so the latency is the queue's and the thread switch's, without the message loop's.
+	void BM_EnqueueToApply(benchmark::State& state)
+	{
+		bindHotkeys();
+
+		std::atomic<int> requestedKeys(0);
+		std::atomic<bool> isRunning(true);
+		std::thread hookThread([&]()
+			{
+				int pressedKeys = 0;
+				DWORD time = 0;
+				while (isRunning.load())
+				{
+					if (pressedKeys == requestedKeys.load()) {
+						std::this_thread::yield();
+						continue;
+					}
+
+					HotkeyManager::keyDown(VK_F1, ++time);
+					HotkeyManager::keyUp(VK_F1);
+					pressedKeys++;
+				}
+			});
+
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+
+		LatencyHistogram latencies;
+		LONGLONG totalTicks = 0; // the histogram's total is in whole microseconds
+		InputEvent event;
+		bool isHotkey;
+		for (auto _ : state)
+		{
+			requestedKeys++;
+
+			InputQueue::beginDrain();
+			while (!InputQueue::pop(event, isHotkey)) {
+				std::this_thread::yield();
+			}
+			const LONGLONG ticks = applyEvent(event);
+			latencies.record((uint64_t)(ticks * 1000000 / frequency.QuadPart));
+			totalTicks += ticks;
+		}
+
+		isRunning = false;
+		hookThread.join();
+
+		state.counters["p50_us"] = (double)latencies.percentile(0.5);
+		state.counters["p99_us"] = (double)latencies.percentile(0.99);
+		state.counters["max_us"] = (double)latencies.maxMicroseconds();
+		state.counters["mean_us"] = (double)totalTicks * 1000000.0 / (double)frequency.QuadPart / (double)state.iterations();
+	}
+}
+
+BENCHMARK(BM_LookupMap);
+BENCHMARK(BM_LookupTable);
+BENCHMARK(BM_HookMap);
+BENCHMARK(BM_HookTable);
+BENCHMARK(BM_LatencyScope)->Arg(0)->Arg(1);
+BENCHMARK(BM_HookTableMonitored)->Arg(0)->Arg(1);
+BENCHMARK(BM_KeyToApply);
+BENCHMARK(BM_EnqueueToApply)->UseRealTime();
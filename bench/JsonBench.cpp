@@ -0,0 +1,108 @@
+// Parse, write, member lookup and deep copy of the bundled jsoncpp, on small to large documents
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+#include "JsonDocuments.h"
+#include "json/json.h"
+
+namespace
+{
+	Json::Value parseDocument(const std::string& text)
+	{
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		Json::Value root;
+		pReader->parse(text.data(), text.data() + text.size(), &root, nullptr);
+		return root;
+	}
+
+	void BM_Parse(benchmark::State& state)
+	{
+		const DocumentSize size = (DocumentSize)state.range(0);
+		const std::string& text = jsonDocument(size);
+
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			Json::Value root;
+			if (!pReader->parse(text.data(), text.data() + text.size(), &root, nullptr)) {
+				state.SkipWithError("the document didn't parse");
+			}
+			benchmark::DoNotOptimize(root);
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)text.size());
+		state.SetLabel(documentSizeName(size));
+	}
+
+	void BM_Write(benchmark::State& state)
+	{
+		const DocumentSize size = (DocumentSize)state.range(0);
+		const Json::Value root = parseDocument(jsonDocument(size));
+
+		Json::StreamWriterBuilder builder;
+		builder["indentation"] = "";
+
+		size_t writtenSize = 0;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			const std::string text = Json::writeString(builder, root);
+			writtenSize = text.size();
+			benchmark::DoNotOptimize(text.data());
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)writtenSize);
+		state.SetLabel(documentSizeName(size));
+	}
+
+	void BM_MemberLookup(benchmark::State& state)
+	{
+		const DocumentSize size = (DocumentSize)state.range(0);
+		const Json::Value root = parseDocument(jsonDocument(size));
+		const Json::Value& index = root["index"];
+		const std::vector<std::string> keys = index.getMemberNames();
+
+		for (auto _ : state)
+		{
+			for (const std::string& key : keys) {
+				benchmark::DoNotOptimize(index.find(key.data(), key.data() + key.size()));
+			}
+		}
+
+		state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)keys.size());
+		state.SetLabel(documentSizeName(size));
+	}
+
+	void BM_DeepCopy(benchmark::State& state)
+	{
+		const DocumentSize size = (DocumentSize)state.range(0);
+		const Json::Value root = parseDocument(jsonDocument(size));
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			Json::Value copy(root);
+			benchmark::DoNotOptimize(copy);
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)jsonDocument(size).size());
+		state.SetLabel(documentSizeName(size));
+	}
+}
+
+BENCHMARK(BM_Parse)->DenseRange(DOCUMENT_SMALL, DOCUMENT_LARGE)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Write)->DenseRange(DOCUMENT_SMALL, DOCUMENT_LARGE)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MemberLookup)->DenseRange(DOCUMENT_SMALL, DOCUMENT_LARGE)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DeepCopy)->DenseRange(DOCUMENT_SMALL, DOCUMENT_LARGE)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,81 @@
+#include "JsonDocuments.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+namespace
+{
+	// Indexed by DocumentSize
+	const int recordCounts[DOCUMENT_SIZE_COUNT] = { 5, 500, 50000 };
+	const char* const sizeNames[DOCUMENT_SIZE_COUNT] = { "small", "medium", "large" };
+
+	// Small linear congruential generator, the same numbers on every platform
+	class Random
+	{
+	private:
+		uint32_t state_;
+
+	public:
+		explicit Random(const uint32_t seed) : state_(seed) {}
+
+		uint32_t next()
+		{
+			state_ = state_ * 1664525u + 1013904223u;
+			return state_ >> 8;
+		}
+	};
+
+	void appendRecord(std::string& text, const int id, Random& random)
+	{
+		const char* const roles[] = { "killer", "survivor", "spectator" };
+		char buffer[256];
+
+		std::snprintf(buffer, sizeof(buffer),
+			"{\"id\":%d,\"name\":\"Player %u\",\"score\":%u.%04u,\"active\":%s,\"tags\":[\"%s\",\"%s\"],"
+			"\"position\":{\"x\":%d.5,\"y\":-%u.25},\"note\":\"escaped \\\"quotes\\\" and \\u00e9\",\"parent\":null}",
+			id, random.next() % 100000, random.next() % 10000, random.next() % 10000, random.next() % 2 ? "true" : "false",
+			roles[random.next() % 3], roles[random.next() % 3], (int)(random.next() % 2000) - 1000, random.next() % 1000);
+		text += buffer;
+	}
+
+	std::string generate(const DocumentSize size)
+	{
+		Random random(0x5EED + (uint32_t)size);
+		const int recordCount = recordCounts[size];
+		std::string text = "{\"records\":[";
+
+		for (int i = 0; i < recordCount; i++)
+		{
+			if (i != 0) text += ',';
+			appendRecord(text, i, random);
+		}
+
+		text += "],\"index\":{";
+		for (int i = 0; i < recordCount; i++)
+		{
+			if (i != 0) text += ',';
+			// Unique keys in no particular order
+			text += "\"record" + std::to_string(random.next() % 1000) + '_' + std::to_string(i) + "\":" + std::to_string(i);
+		}
+		text += "}}";
+
+		return text;
+	}
+}
+
+const std::string& jsonDocument(const DocumentSize size)
+{
+	static std::unique_ptr<std::string> documents[DOCUMENT_SIZE_COUNT];
+
+	if (!documents[size]) {
+		documents[size].reset(new std::string(generate(size)));
+	}
+
+	return *documents[size];
+}
+
+const char* documentSizeName(const DocumentSize size)
+{
+	return sizeNames[size];
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+
+// The sizes of the documents the json benchmarks run on
+enum DocumentSize : int
+{
+	DOCUMENT_SMALL, // about 1 KB, the size of a settings file
+	DOCUMENT_MEDIUM, // about 100 KB
+	DOCUMENT_LARGE, // about 10 MB
+	DOCUMENT_SIZE_COUNT
+};
+
+/**
+@brief Get a generated json document of the given size. Generated with a fixed seed, so every run parses the same text.
+The root object holds a "records" array of small objects mixing every json type, and an "index" object with a member per record.
+
+@param size The size of the document.
+
+@return The document's text, generated on the first call for each size.
+*/
+const std::string& jsonDocument(DocumentSize size);
+
+/**
+@return The name of a document size, for the benchmarks' labels.
+*/
+const char* documentSizeName(DocumentSize size);
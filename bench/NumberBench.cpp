@@ -0,0 +1,123 @@
+// Number formatting of the writer, against the %.17g snprintf it replaced
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+#include "json/json.h"
+
+namespace
+{
+	const size_t NUMBER_COUNT = 4096;
+
+	// Finite doubles of every magnitude, and doubles like the times of a history
+	std::vector<double> makeDoubles(const bool isTimes)
+	{
+		std::vector<double> values;
+		uint64_t state = 0x9E3779B97F4A7C15u;
+		while (values.size() < NUMBER_COUNT)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+
+			double value;
+			if (isTimes) {
+				value = (double)(state % 600000) / 1000.0;
+			}
+			else
+			{
+				std::memcpy(&value, &state, sizeof(value));
+				if (!std::isfinite(value)) continue;
+			}
+			values.push_back(value);
+		}
+		return values;
+	}
+
+	void BM_FormatDouble(benchmark::State& state)
+	{
+		const std::vector<double> values = makeDoubles(state.range(0) != 0);
+
+		for (auto _ : state)
+		{
+			for (const double value : values) {
+				benchmark::DoNotOptimize(Json::valueToString(value));
+			}
+		}
+
+		state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)values.size());
+		state.SetLabel(state.range(0) != 0 ? "times" : "any");
+	}
+
+	// What valueToString did before, without it's locale fix up
+	void BM_FormatDoubleSnprintf(benchmark::State& state)
+	{
+		const std::vector<double> values = makeDoubles(state.range(0) != 0);
+
+		char buffer[36];
+		for (auto _ : state)
+		{
+			for (const double value : values)
+			{
+				std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+				benchmark::DoNotOptimize(std::string(buffer));
+			}
+		}
+
+		state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)values.size());
+		state.SetLabel(state.range(0) != 0 ? "times" : "any");
+	}
+
+	void BM_FormatInt(benchmark::State& state)
+	{
+		std::vector<Json::LargestInt> values;
+		for (size_t i = 0; i < NUMBER_COUNT; i++) {
+			values.push_back((Json::LargestInt)(i * 2654435761u) - 1000000000);
+		}
+
+		for (auto _ : state)
+		{
+			for (const Json::LargestInt value : values) {
+				benchmark::DoNotOptimize(Json::valueToString(value));
+			}
+		}
+
+		state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)values.size());
+	}
+
+	// A whole numeric export, where the writer appends the numbers straight into it's output
+	void BM_WriteNumberArray(benchmark::State& state)
+	{
+		Json::Value numbers(Json::arrayValue);
+		for (const double value : makeDoubles(true)) {
+			numbers.append(value);
+			numbers.append((Json::Int64)(value * 1000));
+		}
+
+		Json::StreamWriterBuilder builder;
+		builder["indentation"] = "";
+
+		size_t writtenSize = 0;
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			const std::string text = Json::writeString(builder, numbers);
+			writtenSize = text.size();
+			benchmark::DoNotOptimize(text.data());
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)writtenSize);
+	}
+}
+
+BENCHMARK(BM_FormatDouble)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FormatDoubleSnprintf)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FormatInt)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_WriteNumberArray)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,102 @@
+// Member lookup, insertion and parsing of small and large objects.
+// Built once with the std::map storage and once with JSONCPP_USING_FLAT_OBJECTS, compare objects_bench_map with objects_bench_flat.
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+#include "json/json.h"
+
+namespace
+{
+#if JSONCPP_USING_FLAT_OBJECTS
+	const char* const STORAGE_NAME = "flat";
+#else
+	const char* const STORAGE_NAME = "map";
+#endif
+
+	// Keys like the ones of a settings file, in a fixed shuffled order
+	std::vector<std::string> memberNames(const int64_t count)
+	{
+		std::vector<std::string> names;
+		for (int64_t i = 0; i < count; i++) {
+			names.push_back("setting" + std::to_string(i * 7919 % 100003));
+		}
+		std::shuffle(names.begin(), names.end(), std::mt19937(42));
+		return names;
+	}
+
+	Json::Value makeObject(const std::vector<std::string>& names)
+	{
+		Json::Value object(Json::objectValue);
+		int i = 0;
+		for (const std::string& name : names) {
+			object[name] = i++;
+		}
+		return object;
+	}
+
+	void BM_Lookup(benchmark::State& state)
+	{
+		const std::vector<std::string> names = memberNames(state.range(0));
+		const Json::Value object = makeObject(names);
+
+		for (auto _ : state)
+		{
+			for (const std::string& name : names) {
+				benchmark::DoNotOptimize(object.find(name.data(), name.data() + name.size()));
+			}
+		}
+
+		state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)names.size());
+		state.SetLabel(STORAGE_NAME);
+	}
+
+	void BM_Insert(benchmark::State& state)
+	{
+		const std::vector<std::string> names = memberNames(state.range(0));
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			Json::Value object = makeObject(names);
+			benchmark::DoNotOptimize(object);
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)names.size());
+		state.SetLabel(STORAGE_NAME);
+	}
+
+	void BM_Parse(benchmark::State& state)
+	{
+		Json::StreamWriterBuilder writerBuilder;
+		const std::string text = Json::writeString(writerBuilder, makeObject(memberNames(state.range(0))));
+
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			Json::Value root;
+			if (!pReader->parse(text.data(), text.data() + text.size(), &root, nullptr)) {
+				state.SkipWithError("the document didn't parse");
+			}
+			benchmark::DoNotOptimize(root);
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)text.size());
+		state.SetLabel(STORAGE_NAME);
+	}
+}
+
+// Settings sized objects, and objects like the index of an exported history
+BENCHMARK(BM_Lookup)->Arg(8)->Arg(64)->Arg(10000);
+BENCHMARK(BM_Insert)->Arg(8)->Arg(64)->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Parse)->Arg(8)->Arg(64)->Arg(10000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,84 @@
+// Json::parseArrayParallel on a large history array, from one thread up to two per core
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "JsonDocuments.h"
+#include "json/json.h"
+
+namespace
+{
+	// The records of the large generated document, as the root array of an exported history
+	const std::string& historyDocument()
+	{
+		static std::unique_ptr<std::string> document;
+
+		if (!document)
+		{
+			const std::string& text = jsonDocument(DOCUMENT_LARGE);
+			Json::CharReaderBuilder builder;
+			const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+			Json::Value root;
+			pReader->parse(text.data(), text.data() + text.size(), &root, nullptr);
+
+			Json::StreamWriterBuilder writerBuilder;
+			writerBuilder["indentation"] = "";
+			document.reset(new std::string(Json::writeString(writerBuilder, root["records"])));
+		}
+
+		return *document;
+	}
+
+	void threadCounts(benchmark::internal::Benchmark* pBenchmark)
+	{
+		const int maxThreads = 2 * (int)std::max(1u, std::thread::hardware_concurrency());
+		for (int threads = 1; threads < maxThreads; threads *= 2) {
+			pBenchmark->Arg(threads);
+		}
+		pBenchmark->Arg(maxThreads);
+	}
+
+	void BM_ParseOneReader(benchmark::State& state)
+	{
+		const std::string& text = historyDocument();
+
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		for (auto _ : state)
+		{
+			Json::Value root;
+			if (!pReader->parse(text.data(), text.data() + text.size(), &root, nullptr)) {
+				state.SkipWithError("the document didn't parse");
+			}
+			benchmark::DoNotOptimize(root);
+		}
+
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)text.size());
+	}
+
+	void BM_ParseArrayParallel(benchmark::State& state)
+	{
+		const std::string& text = historyDocument();
+		const Json::CharReaderBuilder builder;
+
+		for (auto _ : state)
+		{
+			Json::Value root;
+			if (!Json::parseArrayParallel(builder, text.data(), text.data() + text.size(), (unsigned int)state.range(0), &root, nullptr)) {
+				state.SkipWithError("the document didn't parse");
+			}
+			benchmark::DoNotOptimize(root);
+		}
+
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)text.size());
+	}
+}
+
+// Wall time, the work is spread over threads the benchmark doesn't know about
+BENCHMARK(BM_ParseOneReader)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ParseArrayParallel)->Apply(threadCounts)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,135 @@
+// Parse throughput over corpora that stress different scans of the readers.
+// Built once with the vectorized scanning and once with JSONCPP_NO_SIMD, compare scan_bench with scan_bench_scalar.
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "JsonDocuments.h"
+#include "json/json.h"
+
+namespace
+{
+#if defined(JSONCPP_NO_SIMD)
+	const char* const SCANNING_NAME = "scalar";
+#else
+	const char* const SCANNING_NAME = "simd";
+#endif
+
+	enum Corpus : int
+	{
+		CORPUS_COMPACT, // the large generated document as it is
+		CORPUS_PRETTY, // the same document indented, mostly whitespace
+		CORPUS_STRINGS, // long strings with few escapes
+		CORPUS_NUMBERS, // long integers and doubles
+		CORPUS_COUNT
+	};
+
+	const char* const corpusNames[CORPUS_COUNT] = { "compact", "pretty", "strings", "numbers" };
+
+	// Size of the generated string and number corpora, about that of an exported history
+	const size_t CORPUS_SIZE = 4 * 1024 * 1024;
+
+	Json::Value parseDocument(const std::string& text)
+	{
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		Json::Value root;
+		pReader->parse(text.data(), text.data() + text.size(), &root, nullptr);
+		return root;
+	}
+
+	std::string generate(const Corpus corpus)
+	{
+		switch (corpus)
+		{
+		case CORPUS_COMPACT:
+			return jsonDocument(DOCUMENT_LARGE);
+		case CORPUS_PRETTY:
+		{
+			Json::StreamWriterBuilder builder;
+			builder["indentation"] = "        ";
+			return Json::writeString(builder, parseDocument(jsonDocument(DOCUMENT_LARGE)));
+		}
+		case CORPUS_STRINGS:
+		{
+			std::string text = "[";
+			for (uint32_t i = 0; text.size() < CORPUS_SIZE; i++)
+			{
+				if (i != 0) text += ',';
+				text += '"' + std::string(40 + i * 37 % 200, (char)('a' + i % 26));
+				if (i % 4 == 0) text += "\\\"quoted\\\"";
+				text += '"';
+			}
+			return text + ']';
+		}
+		default:
+		{
+			std::string text = "[";
+			for (uint32_t i = 0; text.size() < CORPUS_SIZE; i++)
+			{
+				if (i != 0) text += ',';
+				const uint64_t value = (uint64_t)i * 2654435761u * 2654435761u;
+				text += std::to_string(value);
+				if (i % 2 == 0) text += "." + std::to_string(value % 100000000);
+			}
+			return text + ']';
+		}
+		}
+	}
+
+	const std::string& corpusText(const Corpus corpus)
+	{
+		static std::unique_ptr<std::string> corpora[CORPUS_COUNT];
+
+		if (!corpora[corpus]) {
+			corpora[corpus].reset(new std::string(generate(corpus)));
+		}
+
+		return *corpora[corpus];
+	}
+
+	void BM_Parse(benchmark::State& state)
+	{
+		const Corpus corpus = (Corpus)state.range(0);
+		const std::string& text = corpusText(corpus);
+
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		for (auto _ : state)
+		{
+			Json::Value root;
+			if (!pReader->parse(text.data(), text.data() + text.size(), &root, nullptr)) {
+				state.SkipWithError("the corpus didn't parse");
+			}
+			benchmark::DoNotOptimize(root);
+		}
+
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)text.size());
+		state.SetLabel(std::string(corpusNames[corpus]) + ' ' + SCANNING_NAME);
+	}
+
+	// The event reader builds no tree, so the scanning is a larger share of its time
+	void BM_ParseEvents(benchmark::State& state)
+	{
+		const Corpus corpus = (Corpus)state.range(0);
+		const std::string& text = corpusText(corpus);
+
+		Json::ParseEventHandler handler;
+		for (auto _ : state)
+		{
+			if (!Json::parseEvents(text.data(), text.data() + text.size(), handler, nullptr)) {
+				state.SkipWithError("the corpus didn't parse");
+			}
+		}
+
+		state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)text.size());
+		state.SetLabel(std::string(corpusNames[corpus]) + ' ' + SCANNING_NAME);
+	}
+}
+
+BENCHMARK(BM_Parse)->DenseRange(CORPUS_COMPACT, CORPUS_NUMBERS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ParseEvents)->DenseRange(CORPUS_COMPACT, CORPUS_NUMBERS)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,173 @@
+// Reading the settings on the render path: from the in-memory cache, against parsing settings.json like before the cache
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+#include "SettingsCache.h"
+#include "SettingsSchema.h"
+#include "SettingsUtils.h"
+#include "json/json.h"
+
+namespace
+{
+	// Settings with a few extra bindings and profiles, saved to the working directory's settings.json
+	SettingsStruct makeSettings()
+	{
+		SettingsStruct settings;
+		settings.bindings = { { "start", 0x74 }, { "undo", 0x75 }, { "redo", 0x76 } };
+		settings.profiles = { { "Killer", { { "timer1", 0x31 } } }, { "Survivor", { { "timer2", 0x32 } } } };
+		return settings;
+	}
+
+	void saveSettingsFile()
+	{
+		static bool isSaved = false;
+
+		if (!isSaved) {
+			isSaved = writeFileAtomically(SETTINGS_FILE_NAME, serializeSettings(makeSettings()));
+		}
+	}
+
+	// What createGraphicsResources and refreshBrushes did before the cache, on every call
+	int readColorsLikeBefore()
+	{
+		std::ifstream file(SETTINGS_FILE_NAME);
+		Json::Value actualJson;
+		Json::Reader reader;
+
+		reader.parse(file, actualJson);
+
+		const Json::Value colors = actualJson["colors"];
+		return colors["timer"].asInt() + colors["selected timer"].asInt() + colors["last seconds"].asInt() + colors["background"].asInt();
+	}
+
+	std::vector<BindingStruct> readBindings(const Json::Value& bindingsJson)
+	{
+		std::vector<BindingStruct> bindings;
+		for (const Json::Value& bindingJson : bindingsJson) {
+			bindings.push_back({ bindingJson[BINDING_ACTION_KEY].asString(), bindingJson[BINDING_KEY_KEY].asInt() });
+		}
+
+		return bindings;
+	}
+
+	// The same load through a Json::Value tree, how settings were read before parseSettings streamed them
+	bool parseSettingsDom(const std::string& json, SettingsStruct& result)
+	{
+		static const std::unique_ptr<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+		Json::Value actualJson;
+
+		if (!reader->parse(json.data(), json.data() + json.size(), &actualJson, nullptr)) {
+			return false;
+		}
+
+		for (const auto& field : SETTINGS_INT_FIELDS) {
+			result.*field.member = actualJson[field.key].asInt();
+		}
+		for (const auto& field : SETTINGS_BOOL_FIELDS)
+		{
+			if (field.key != nullptr) {
+				result.*field.member = actualJson[field.key].asBool();
+			}
+		}
+		for (const auto& field : COLORS_INT_FIELDS) {
+			result.colors.*field.member = actualJson[COLORS_KEY][field.key].asInt();
+		}
+
+		result.bindings = readBindings(actualJson[BINDINGS_KEY]);
+		result.profiles.clear();
+		for (const Json::Value& profileJson : actualJson[PROFILES_KEY]) {
+			result.profiles.push_back({ profileJson[PROFILE_NAME_KEY].asString(), readBindings(profileJson[BINDINGS_KEY]) });
+		}
+
+		return true;
+	}
+
+	void BM_CachedRead(benchmark::State& state)
+	{
+		SettingsCache::store(makeSettings());
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			const SettingsReadScope readScope;
+			const ColorsStruct& colors = SettingsCache::get().colors;
+			benchmark::DoNotOptimize(colors.timerColor + colors.selectedTimerColor + colors.lastSecondsColor + colors.backgroundColor);
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+	}
+
+	void BM_ParseFileLikeBefore(benchmark::State& state)
+	{
+		saveSettingsFile();
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(readColorsLikeBefore());
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+	}
+
+	// The whole file load as it is now, what the cache does once at startup
+	void BM_GetSafeSettingsStruct(benchmark::State& state)
+	{
+		saveSettingsFile();
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			const SettingsStruct settings = getSafeSettingsStruct();
+			benchmark::DoNotOptimize(settings.colors.timerColor);
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+	}
+
+	// Loading settings already in memory, so only the parse is timed
+	void BM_ParseSettingsDom(benchmark::State& state)
+	{
+		const std::string json = serializeSettings(makeSettings());
+
+		SettingsStruct domSettings;
+		SettingsStruct saxSettings;
+		if (!parseSettingsDom(json, domSettings) || !parseSettings(json, saxSettings) || diffSettings(domSettings, saxSettings) != SETTINGS_CHANGED_NONE) {
+			state.SkipWithError("the loads' settings differ");
+		}
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			SettingsStruct settings;
+			benchmark::DoNotOptimize(parseSettingsDom(json, settings));
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed(state.iterations() * json.size());
+	}
+
+	void BM_ParseSettingsSax(benchmark::State& state)
+	{
+		const std::string json = serializeSettings(makeSettings());
+
+		const uint64_t allocationsBefore = AllocationCounter::count();
+		for (auto _ : state)
+		{
+			SettingsStruct settings;
+			benchmark::DoNotOptimize(parseSettings(json, settings));
+		}
+
+		AllocationCounter::report(state, allocationsBefore);
+		state.SetBytesProcessed(state.iterations() * json.size());
+	}
+}
+
+BENCHMARK(BM_CachedRead);
+BENCHMARK(BM_ParseFileLikeBefore)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetSafeSettingsStruct)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseSettingsDom)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseSettingsSax)->Unit(benchmark::kMicrosecond);
@@ -109,6 +109,20 @@ license you like.
 // If non-zero, the library zeroes any memory that it has allocated before
 // it frees its memory.
 
+#ifndef JSONCPP_USING_ARENA_MEMORY
+#define JSONCPP_USING_ARENA_MEMORY 0
+#endif
+// If non-zero, the objects, arrays and strings of a Value can be allocated
+// from a Json::ValueArena. Every such allocation carries a small header that
+// records where it came from.
+
+#ifndef JSONCPP_USING_FLAT_OBJECTS
+#define JSONCPP_USING_FLAT_OBJECTS 0
+#endif
+// If non-zero, the members of objects and arrays are kept in a contiguous
+// vector sorted by key instead of a std::map. Inserting or removing a member
+// then invalidates references and iterators into the same object or array.
+
 #endif // JSON_VERSION_H_INCLUDED
 
 // //////////////////////////////////////////////////////////////////////
@@ -208,6 +222,115 @@ bool operator!=(const SecureAllocator<T>&, const SecureAllocator<U>&) {
   return false;
 }
 
+#if JSONCPP_USING_ARENA_MEMORY
+#if JSONCPP_USING_SECURE_MEMORY
+#error "JSONCPP_USING_ARENA_MEMORY and JSONCPP_USING_SECURE_MEMORY are exclusive"
+#endif
+
+/** \brief Monotonic memory resource for Value trees.
+ *
+ * While a ValueArena::Scope is alive, every object, array and string payload
+ * created by a Value on that thread is carved out of a few large blocks owned
+ * by the arena. Releasing that memory does nothing; all blocks are freed at
+ * once when the arena is destroyed, so the arena must outlive every Value
+ * built inside its scope. Outside of any scope memory comes from the heap.
+ *
+ * \code
+ * Json::ValueArena arena;
+ * Json::Value root;
+ * {
+ *   Json::ValueArena::Scope scope(arena);
+ *   reader->parse(begin, end, &root, &errs);
+ * }
+ * // ... use root, then destroy it before the arena
+ * \endcode
+ */
+class ValueArena {
+public:
+  /// Blocks are at least this big, larger requests get a block of their own.
+  static constexpr std::size_t defaultBlockSize = 64 * 1024;
+
+  explicit ValueArena(std::size_t blockSize = defaultBlockSize);
+  ~ValueArena();
+
+  ValueArena(const ValueArena&) = delete;
+  ValueArena& operator=(const ValueArena&) = delete;
+
+  /// Allocate size bytes, aligned for any fundamental type.
+  void* allocate(std::size_t size);
+
+  /// Number of blocks requested from the heap so far.
+  std::size_t blockCount() const { return blockCount_; }
+  /// Number of bytes handed out so far, including headers and padding.
+  std::size_t bytesAllocated() const { return bytesAllocated_; }
+
+  /// Routes the Value allocations of the current thread to an arena.
+  /// Scopes can be nested, the previous arena is restored on destruction.
+  class Scope {
+  public:
+    explicit Scope(ValueArena& arena);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    ValueArena* previous_;
+  };
+
+  /// Allocate memory for a Value from the current thread's arena, or the heap.
+  static void* allocateValueMemory(std::size_t size);
+  /// Release memory from allocateValueMemory(). Arena memory is left alone.
+  static void releaseValueMemory(void* p);
+
+private:
+  struct Block {
+    Block* previous_;
+  };
+
+  Block* head_{nullptr};
+  char* current_{nullptr};
+  char* end_{nullptr};
+  std::size_t blockSize_;
+  std::size_t blockCount_{0};
+  std::size_t bytesAllocated_{0};
+};
+
+/** \brief Standard allocator that allocates through ValueArena.
+ */
+template <typename T> class ArenaAllocator {
+public:
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  pointer allocate(size_type n) {
+    return static_cast<pointer>(ValueArena::allocateValueMemory(n * sizeof(T)));
+  }
+
+  void deallocate(pointer p, size_type) { ValueArena::releaseValueMemory(p); }
+
+  // Boilerplate
+  ArenaAllocator() {}
+  template <typename U> ArenaAllocator(const ArenaAllocator<U>&) {}
+  template <typename U> struct rebind { using other = ArenaAllocator<U>; };
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+  return false;
+}
+#endif // JSONCPP_USING_ARENA_MEMORY
+
 } // namespace Json
 
 #pragma pack(pop)
@@ -359,6 +482,12 @@ using Allocator =
     typename std::conditional<JSONCPP_USING_SECURE_MEMORY, SecureAllocator<T>,
                               std::allocator<T>>::type;
 using String = std::basic_string<char, std::char_traits<char>, Allocator<char>>;
+/// Allocator of the containers inside a Value.
+#if JSONCPP_USING_ARENA_MEMORY
+template <typename T> using ValueAllocator = ArenaAllocator<T>;
+#else
+template <typename T> using ValueAllocator = std::allocator<T>;
+#endif
 using IStringStream =
     std::basic_istringstream<String::value_type, String::traits_type,
                              String::allocator_type>;
@@ -565,6 +694,7 @@ public:
 #endif
 #endif
 
+#include <algorithm>
 #include <array>
 #include <exception>
 #include <map>
@@ -683,6 +813,111 @@ private:
   const char* c_str_;
 };
 
+#if JSONCPP_USING_FLAT_OBJECTS
+/** \brief Sorted vector with the part of the std::map interface used by Value.
+ *
+ * Lookups are binary searches over contiguous memory. Appending keys in
+ * ascending order, as readers do for arrays, is amortized constant time.
+ * Unlike std::map, inserting or erasing invalidates every iterator and
+ * reference into the container.
+ */
+template <typename Key, typename T, typename Alloc> class FlatMap {
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using container_type = std::vector<value_type, Alloc>;
+  using size_type = typename container_type::size_type;
+  using iterator = typename container_type::iterator;
+  using const_iterator = typename container_type::const_iterator;
+
+  iterator begin() { return values_.begin(); }
+  const_iterator begin() const { return values_.begin(); }
+  iterator end() { return values_.end(); }
+  const_iterator end() const { return values_.end(); }
+
+  size_type size() const { return values_.size(); }
+  bool empty() const { return values_.empty(); }
+  void clear() { values_.clear(); }
+
+  iterator lower_bound(const Key& key) {
+    return std::lower_bound(values_.begin(), values_.end(), key, KeyLess());
+  }
+  const_iterator lower_bound(const Key& key) const {
+    return std::lower_bound(values_.begin(), values_.end(), key, KeyLess());
+  }
+
+  iterator find(const Key& key) {
+    auto it = lower_bound(key);
+    return it != end() && !(key < it->first) ? it : end();
+  }
+  const_iterator find(const Key& key) const {
+    auto it = lower_bound(key);
+    return it != end() && !(key < it->first) ? it : end();
+  }
+
+  /// Insert value unless its key exists. The hint is used when it is the
+  /// key's sorted position.
+  iterator insert(const_iterator hint, const value_type& value) {
+    const bool hintIsPosition =
+        (hint == values_.cbegin() || (hint - 1)->first < value.first) &&
+        (hint == values_.cend() || value.first < hint->first);
+    if (hintIsPosition)
+      return values_.insert(hint, value);
+    auto it = lower_bound(value.first);
+    if (it != end() && !(value.first < it->first))
+      return it;
+    return values_.insert(it, value);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type value(std::forward<Args>(args)...);
+    // Fast path for appending, which is how arrays grow
+    if (values_.empty() || values_.back().first < value.first) {
+      values_.push_back(std::move(value));
+      return {values_.end() - 1, true};
+    }
+    auto it = lower_bound(value.first);
+    if (it != end() && !(value.first < it->first))
+      return {it, false};
+    return {values_.insert(it, std::move(value)), true};
+  }
+
+  iterator erase(const_iterator position) { return values_.erase(position); }
+  size_type erase(const Key& key) {
+    auto it = find(key);
+    if (it == end())
+      return 0;
+    values_.erase(it);
+    return 1;
+  }
+
+  T& operator[](const Key& key) {
+    auto it = lower_bound(key);
+    if (it == end() || key < it->first)
+      it = values_.insert(it, value_type(key, T()));
+    return it->second;
+  }
+
+  bool operator==(const FlatMap& other) const {
+    return values_ == other.values_;
+  }
+  bool operator<(const FlatMap& other) const {
+    return values_ < other.values_;
+  }
+
+private:
+  struct KeyLess {
+    bool operator()(const value_type& value, const Key& key) const {
+      return value.first < key;
+    }
+  };
+
+  container_type values_;
+};
+#endif // JSONCPP_USING_FLAT_OBJECTS
+
 /** \brief Represents a <a HREF="http://www.json.org">JSON</a> value.
  *
  * This class is a discriminated union wrapper that can represents a:
@@ -819,7 +1054,14 @@ private:
   };
 
 public:
-  typedef std::map<CZString, Value> ObjectValues;
+#if JSONCPP_USING_FLAT_OBJECTS
+  typedef FlatMap<CZString, Value, ValueAllocator<std::pair<CZString, Value>>>
+      ObjectValues;
+#else
+  typedef std::map<CZString, Value, std::less<CZString>,
+                   ValueAllocator<std::pair<const CZString, Value>>>
+      ObjectValues;
+#endif
 #endif // ifndef JSONCPP_DOC_EXCLUDE_IMPLEMENTATION
 
 public:
@@ -1722,6 +1964,7 @@ private:
   String getLocationLineAndColumn(Location location) const;
   void addComment(Location begin, Location end, CommentPlacement placement);
   void skipCommentTokens(Token& token);
+  void readPendingComments();
 
   static bool containsNewLine(Location begin, Location end);
   static String normalizeEOL(Location begin, Location end);
@@ -1862,6 +2105,74 @@ public:
   static void strictMode(Json::Value* settings);
 };
 
+/** \brief A Value tree parsed in place, whose strings point into its own text.
+ *
+ * Keys and string values without escape sequences are not copied: the
+ * parser nul-terminates them inside the buffer, over their closing quote,
+ * and the Values reference them there. Strings with escapes are decoded into
+ * their own allocations as usual. The buffer lives as long as the document,
+ * so Values copied out of root() must not outlive it.
+ *
+ * \code
+ * Json::Document document;
+ * Json::String errs;
+ * if (document.parse(readWholeFile(), &errs))
+ *   use(document.root()["name"].asCString());
+ * \endcode
+ */
+class JSON_API Document {
+public:
+  /// Parse with the settings of 'builder' (see CharReaderBuilder).
+  explicit Document(CharReaderBuilder const& builder = CharReaderBuilder());
+  ~Document();
+
+  Document(Document const&) = delete;
+  Document& operator=(Document const&) = delete;
+
+  /** Parse text, which the document takes ownership of.
+   * \param errs [out] Formatted error messages, if not NULL.
+   * \return true if the text was valid.
+   */
+  bool parse(String text, String* errs);
+
+  /** Parse a writable buffer in place.
+   * The buffer is modified and must stay valid as long as 'owner' does,
+   * e.g. a copy-on-write file mapping released by the owner's deleter.
+   * \param errs [out] Formatted error messages, if not NULL.
+   * \return true if the text was valid.
+   */
+  bool parse(char* beginDoc, char* endDoc, std::shared_ptr<void> owner,
+             String* errs);
+
+  Value const& root() const { return root_; }
+  Value& root() { return root_; }
+
+private:
+  Value settings_;
+  std::shared_ptr<void> buffer_;
+  // Declared after buffer_, so the tree is destroyed before its strings
+  Value root_;
+};
+
+/** \brief Parse a document whose root is a large array on several threads.
+ *
+ * A quick scan finds where the root array's elements begin and end, then the
+ * elements are parsed in parallel straight into their slots of 'root'.
+ * Documents the scan can't split (small ones, other roots, comments, or the
+ * "allowDroppedNullPlaceholders" and "allowSingleQuotes" settings) and
+ * invalid documents are parsed on the calling thread instead, so the result,
+ * the values' offsets and the error messages are the same as with
+ * builder.newCharReader()->parse().
+ *
+ * \param threadCount Number of threads to use, 0 for one per core.
+ * \param errs [out] Formatted error messages, if not NULL.
+ * \return true if the document is valid.
+ */
+bool JSON_API parseArrayParallel(CharReaderBuilder const& builder,
+                                 char const* beginDoc, char const* endDoc,
+                                 unsigned int threadCount, Value* root,
+                                 String* errs);
+
 /** Consume entire stream and use its begin/end.
  * Someday we might have a real StreamReader, but for now this
  * is convenient.
@@ -1895,6 +2206,47 @@ bool JSON_API parseFromStream(CharReader::Factory const&, IStream&, Value* root,
  */
 JSON_API IStream& operator>>(IStream&, Value&);
 
+/** \brief Interface receiving the tokens of a document from parseEvents().
+ *
+ * Every callback returns true to continue parsing, or false to stop.
+ * The default implementations ignore the token and continue.
+ *
+ * String and key ranges are only valid for the duration of the callback.
+ * They point directly into the document when the string has no escape
+ * sequences, otherwise into a decode buffer that is reused.
+ */
+class JSON_API ParseEventHandler {
+public:
+  virtual ~ParseEventHandler();
+
+  virtual bool onNull();
+  virtual bool onBool(bool value);
+  virtual bool onInt(LargestInt value);
+  virtual bool onUInt(LargestUInt value);
+  virtual bool onDouble(double value);
+  virtual bool onString(char const* begin, char const* end);
+  virtual bool onObjectBegin();
+  virtual bool onKey(char const* begin, char const* end);
+  virtual bool onObjectEnd();
+  virtual bool onArrayBegin();
+  virtual bool onArrayEnd();
+};
+
+/** \brief Parse a document without building a Value tree.
+ *
+ * Tokens are passed to 'handler' in document order as they are read.
+ * Accepts the same documents as CharReaderBuilder's defaults (comments,
+ * a leading BOM and a stack limit of 1000), except that anything other
+ * than whitespace and comments after the root value is an error.
+ * Integers that fit a LargestInt are reported with onInt(), larger ones
+ * with onUInt(), and everything else with onDouble().
+ *
+ * \param errs [out] Formatted error messages, if not NULL.
+ * \return false if the document is invalid or a callback stopped parsing.
+ */
+bool JSON_API parseEvents(char const* beginDoc, char const* endDoc,
+                          ParseEventHandler& handler, String* errs);
+
 } // namespace Json
 
 #pragma pack(pop)
@@ -2065,6 +2417,88 @@ public:
   static void setDefaults(Json::Value* settings);
 };
 
+/** \brief Write a document straight into a buffer, without building a
+ * Value tree.
+ *
+ * The document is described in order, the same way ParseEventHandler
+ * receives it:
+ *   \code
+ *   Json::EventWriter writer("   ");
+ *   writer.objectBegin();
+ *   writer.key("start").value(70);
+ *   writer.key("colors").objectBegin();
+ *   writer.key("timer").value(9);
+ *   writer.objectEnd();
+ *   writer.objectEnd();
+ *   std::cout << writer.str();
+ *   \endcode
+ *
+ * The output matches StreamWriterBuilder with the same "indentation" and
+ * "commentStyle" "None", except that members keep the order they were
+ * written in and non-empty arrays always put one element per line. An empty
+ * indentation writes compact output without newlines.
+ *
+ * clear() empties the buffer but keeps its capacity, so one writer can
+ * produce many documents without reallocating.
+ */
+class JSON_API EventWriter {
+public:
+  explicit EventWriter(String indentation = "\t");
+
+  EventWriter& objectBegin();
+  EventWriter& objectEnd();
+  EventWriter& arrayBegin();
+  EventWriter& arrayEnd();
+
+  /// Write the key of the next object member, it must be followed by a value.
+  EventWriter& key(char const* begin, char const* end);
+  EventWriter& key(char const* key);
+  EventWriter& key(String const& key);
+
+  EventWriter& nullValue();
+  EventWriter& value(bool value);
+  EventWriter& value(Int value);
+  EventWriter& value(UInt value);
+#if defined(JSON_HAS_INT64)
+  EventWriter& value(Int64 value);
+  EventWriter& value(UInt64 value);
+#endif // if defined(JSON_HAS_INT64)
+  EventWriter& value(double value);
+  EventWriter& value(char const* begin, char const* end);
+  EventWriter& value(char const* value);
+  EventWriter& value(String const& value);
+
+  /// Start a new document, keeping the buffer's capacity.
+  void clear();
+
+  /// \return true once a whole root value has been written.
+  bool isComplete() const;
+
+  String const& str() const { return buffer_; }
+  char const* data() const { return buffer_.data(); }
+  size_t size() const { return buffer_.size(); }
+
+private:
+  struct Scope {
+    bool isObject;
+    bool hasMembers;
+    bool isBreakPending; // the opening bracket still needs its own line
+  };
+
+  void beginValue();
+  void writePendingBreak();
+  void beginContainer(bool isObject, char bracket);
+  void endContainer(bool isObject, char bracket);
+  void writeLineBreak(size_t depth);
+  void writeQuoted(char const* begin, char const* end);
+
+  String indentation_;
+  String lineBreaks_; // a newline and the indentation of the deepest level
+  String buffer_;
+  std::vector<Scope> scopes_;
+  bool isAfterKey_;
+};
+
 /** \brief Abstract class for writers.
  * \deprecated Use StreamWriter. (And really, this is an implementation detail.)
  */
@@ -105,6 +105,26 @@ license you like.
 #include <clocale>
 #endif
 
+// Vectorized scanning, define JSONCPP_NO_SIMD to only use the scalar loops.
+// SSE2 is part of every x64 CPU, AVX2 is used after checking the CPU at
+// runtime.
+#if !defined(JSONCPP_NO_SIMD) &&                                               \
+    (defined(__SSE2__) || defined(_M_X64) ||                                   \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define JSONCPP_SIMD_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#define JSONCPP_SIMD_AVX2 1
+#define JSONCPP_TARGET_AVX2
+#elif defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define JSONCPP_SIMD_AVX2 1
+#define JSONCPP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
 /* This header provides common string manipulation support, such as UTF-8,
  * portable conversion from/to string...
  *
@@ -152,24 +172,70 @@ static inline String codePointToUTF8(unsigned int cp) {
 
 enum {
   /// Constant that specify the size of the buffer that must be passed to
-  /// uintToString.
+  /// writeUInt() and writeInt().
   uintToStringBufferSize = 3 * sizeof(LargestUInt) + 1
 };
 
-// Defines a char buffer for use with uintToString().
+// Defines a char buffer for use with writeUInt() and writeInt().
 using UIntToStringBuffer = char[uintToStringBufferSize];
 
-/** Converts an unsigned integer to string.
+/// Number of decimal digits of value.
+static inline unsigned int countDecimalDigits(LargestUInt value) {
+  unsigned int digits = 1;
+  for (;;) {
+    if (value < 10)
+      return digits;
+    if (value < 100)
+      return digits + 1;
+    if (value < 1000)
+      return digits + 2;
+    if (value < 10000)
+      return digits + 3;
+    value /= 10000U;
+    digits += 4;
+  }
+}
+
+/** Writes the decimal digits of an unsigned integer, two at a time.
  * @param value Unsigned integer to convert to string
- * @param current Input/Output string buffer.
- *        Must have at least uintToStringBufferSize chars free.
+ * @param out Output buffer, must have at least uintToStringBufferSize chars.
+ * @return One past the last digit written. Nothing is nul-terminated.
+ */
+static inline char* writeUInt(LargestUInt value, char* out) {
+  static const char digitPairs[] =
+      "0001020304050607080910111213141516171819"
+      "2021222324252627282930313233343536373839"
+      "4041424344454647484950515253545556575859"
+      "6061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+  char* const end = out + countDecimalDigits(value);
+  char* current = end;
+  while (value >= 100) {
+    const auto pair = static_cast<unsigned int>(value % 100U) * 2U;
+    value /= 100U;
+    current -= 2;
+    current[0] = digitPairs[pair];
+    current[1] = digitPairs[pair + 1];
+  }
+  if (value >= 10) {
+    const auto pair = static_cast<unsigned int>(value) * 2U;
+    current[-2] = digitPairs[pair];
+    current[-1] = digitPairs[pair + 1];
+  } else {
+    current[-1] = static_cast<char>('0' + static_cast<unsigned int>(value));
+  }
+  return end;
+}
+
+/** Writes a signed integer, see writeUInt().
  */
-static inline void uintToString(LargestUInt value, char*& current) {
-  *--current = 0;
-  do {
-    *--current = static_cast<char>(value % 10U + static_cast<unsigned>('0'));
-    value /= 10;
-  } while (value != 0);
+static inline char* writeInt(LargestInt value, char* out) {
+  if (value < 0) {
+    *out++ = '-';
+    // negate as unsigned so minLargestInt doesn't overflow
+    return writeUInt(0U - static_cast<LargestUInt>(value), out);
+  }
+  return writeUInt(static_cast<LargestUInt>(value), out);
 }
 
 /** Change ',' to '.' everywhere in buffer.
@@ -219,6 +285,226 @@ Iter fixZerosInTheEnd(Iter begin, Iter end, unsigned int precision) {
   return end;
 }
 
+// Scanning helpers used by the readers. Each returns the first position in
+// [begin, end) that doesn't belong to the run it skips, or end. On x86 the
+// runs are scanned 16 (SSE2) or 32 (AVX2, when the CPU has it) bytes at a
+// time; the scalar loops handle tails and other targets.
+
+static inline bool isJsonWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline bool isJsonDigit(char c) { return c >= '0' && c <= '9'; }
+
+static const char* skipWhitespaceScalar(const char* begin, const char* end) {
+  while (begin != end && isJsonWhitespace(*begin))
+    ++begin;
+  return begin;
+}
+
+static const char* findQuoteOrBackslashScalar(const char* begin,
+                                              const char* end) {
+  while (begin != end && *begin != '"' && *begin != '\\')
+    ++begin;
+  return begin;
+}
+
+static const char* skipDigitsScalar(const char* begin, const char* end) {
+  while (begin != end && isJsonDigit(*begin))
+    ++begin;
+  return begin;
+}
+
+#if JSONCPP_SIMD_SSE2
+static inline unsigned int countTrailingZeros(unsigned int mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned int>(index);
+#else
+  return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+}
+
+// Bytes of the chunk that are whitespace, one bit per byte
+static inline unsigned int whitespaceMask(__m128i chunk) {
+  const __m128i spaces =
+      _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                   _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+  const __m128i newlines =
+      _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+                   _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+  return static_cast<unsigned int>(
+      _mm_movemask_epi8(_mm_or_si128(spaces, newlines)));
+}
+
+static inline unsigned int quoteOrBackslashMask(__m128i chunk) {
+  return static_cast<unsigned int>(_mm_movemask_epi8(
+      _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')),
+                   _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')))));
+}
+
+// Bytes >= 0x80 compare as negative, so they are never digits
+static inline unsigned int digitMask(__m128i chunk) {
+  return static_cast<unsigned int>(_mm_movemask_epi8(
+      _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('0' - 1)),
+                    _mm_cmplt_epi8(chunk, _mm_set1_epi8('9' + 1)))));
+}
+
+static const char* skipWhitespaceSse2(const char* begin, const char* end) {
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const unsigned int others = ~whitespaceMask(chunk) & 0xFFFFu;
+    if (others != 0)
+      return begin + countTrailingZeros(others);
+  }
+  return skipWhitespaceScalar(begin, end);
+}
+
+static const char* findQuoteOrBackslashSse2(const char* begin,
+                                            const char* end) {
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const unsigned int found = quoteOrBackslashMask(chunk);
+    if (found != 0)
+      return begin + countTrailingZeros(found);
+  }
+  return findQuoteOrBackslashScalar(begin, end);
+}
+
+static const char* skipDigitsSse2(const char* begin, const char* end) {
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const unsigned int others = ~digitMask(chunk) & 0xFFFFu;
+    if (others != 0)
+      return begin + countTrailingZeros(others);
+  }
+  return skipDigitsScalar(begin, end);
+}
+
+#if JSONCPP_SIMD_AVX2
+JSONCPP_TARGET_AVX2 static const char* skipWhitespaceAvx2(const char* begin,
+                                                          const char* end) {
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const __m256i spaces =
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+    const __m256i newlines =
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')),
+                        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+    const unsigned int others = ~static_cast<unsigned int>(
+        _mm256_movemask_epi8(_mm256_or_si256(spaces, newlines)));
+    if (others != 0)
+      return begin + countTrailingZeros(others);
+  }
+  return skipWhitespaceSse2(begin, end);
+}
+
+JSONCPP_TARGET_AVX2 static const char*
+findQuoteOrBackslashAvx2(const char* begin, const char* end) {
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const unsigned int found = static_cast<unsigned int>(_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')),
+                        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\')))));
+    if (found != 0)
+      return begin + countTrailingZeros(found);
+  }
+  return findQuoteOrBackslashSse2(begin, end);
+}
+
+JSONCPP_TARGET_AVX2 static const char* skipDigitsAvx2(const char* begin,
+                                                      const char* end) {
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const __m256i digits = _mm256_and_si256(
+        _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('0' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chunk));
+    const unsigned int others =
+        ~static_cast<unsigned int>(_mm256_movemask_epi8(digits));
+    if (others != 0)
+      return begin + countTrailingZeros(others);
+  }
+  return skipDigitsSse2(begin, end);
+}
+
+static bool cpuSupportsAvx2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  // The OS must save the AVX registers (OSXSAVE, AVX, XCR0 bits 1 and 2)
+  __cpuid(info, 1);
+  if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+    return false;
+  if ((_xgetbv(0) & 0x6) != 0x6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif // JSONCPP_SIMD_AVX2
+#endif // JSONCPP_SIMD_SSE2
+
+struct ScanFunctions {
+  const char* (*skipWhitespace)(const char*, const char*);
+  const char* (*findQuoteOrBackslash)(const char*, const char*);
+  const char* (*skipDigits)(const char*, const char*);
+};
+
+static ScanFunctions selectScanFunctions() {
+#if JSONCPP_SIMD_AVX2
+  if (cpuSupportsAvx2())
+    return {skipWhitespaceAvx2, findQuoteOrBackslashAvx2, skipDigitsAvx2};
+#endif
+#if JSONCPP_SIMD_SSE2
+  return {skipWhitespaceSse2, findQuoteOrBackslashSse2, skipDigitsSse2};
+#else
+  return {skipWhitespaceScalar, findQuoteOrBackslashScalar, skipDigitsScalar};
+#endif
+}
+
+static const ScanFunctions& scanFunctions() {
+  static const ScanFunctions functions = selectScanFunctions();
+  return functions;
+}
+
+// Most whitespace and digit runs are a character or two long, those are
+// handled inline without going through the selected function.
+
+static inline const char* skipWhitespace(const char* begin, const char* end) {
+  if (begin == end || !isJsonWhitespace(*begin))
+    return begin;
+  ++begin;
+  if (begin == end || !isJsonWhitespace(*begin))
+    return begin;
+  return scanFunctions().skipWhitespace(begin + 1, end);
+}
+
+static inline const char* findQuoteOrBackslash(const char* begin,
+                                               const char* end) {
+  return scanFunctions().findQuoteOrBackslash(begin, end);
+}
+
+static inline const char* skipDigits(const char* begin, const char* end) {
+  if (begin == end || !isJsonDigit(*begin))
+    return begin;
+  ++begin;
+  if (begin == end || !isJsonDigit(*begin))
+    return begin;
+  return scanFunctions().skipDigits(begin + 1, end);
+}
+
 } // namespace Json
 
 #endif // LIB_JSONCPP_JSON_TOOL_H_INCLUDED
@@ -249,6 +535,7 @@ Iter fixZerosInTheEnd(Iter begin, Iter end, unsigned int precision) {
 #include <json/value.h>
 #endif // if !defined(JSON_IS_AMALGAMATION)
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstring>
@@ -258,6 +545,7 @@ Iter fixZerosInTheEnd(Iter begin, Iter end, unsigned int precision) {
 #include <memory>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <utility>
 
 #include <cstdio>
@@ -473,6 +761,25 @@ void Reader::skipCommentTokens(Token& token) {
   }
 }
 
+// Reads the comments in front of the next token. A comment on the line of the
+// last value is then attached to it before a sibling is added, which may move
+// the last value when objects are flat. Later comments go before the next value
+// instead, since the last value can't be reached any more.
+void Reader::readPendingComments() {
+  for (;;) {
+    skipSpaces();
+    if (current_ == end_ || *current_ != '/')
+      break;
+    Location commentBegin = current_;
+    Token comment;
+    if (!readToken(comment) || comment.type_ != tokenComment) {
+      current_ = commentBegin;
+      break;
+    }
+  }
+  lastValueEnd_ = nullptr;
+}
+
 bool Reader::readToken(Token& token) {
   skipSpaces();
   token.start_ = current_;
@@ -710,6 +1017,10 @@ bool Reader::readObject(Token& token) {
       return addErrorAndRecover("Missing ':' after object member name", colon,
                                 tokenObjectEnd);
     }
+#if JSONCPP_USING_FLAT_OBJECTS
+    if (collectComments_)
+      readPendingComments();
+#endif
     Value& value = currentValue()[name];
     nodes_.push(&value);
     bool ok = readValue();
@@ -747,6 +1058,10 @@ bool Reader::readArray(Token& token) {
   }
   int index = 0;
   for (;;) {
+#if JSONCPP_USING_FLAT_OBJECTS
+    if (collectComments_)
+      readPendingComments();
+#endif
     Value& value = currentValue()[index++];
     nodes_.push(&value);
     bool ok = readValue();
@@ -1114,6 +1429,7 @@ public:
   bool rejectDupKeys_;
   bool allowSpecialFloats_;
   bool skipBom_;
+  bool zeroCopy_; // the document is writable and outlives the Values
   size_t stackLimit_;
 }; // OurFeatures
 
@@ -1137,6 +1453,10 @@ public:
   explicit OurReader(OurFeatures const& features);
   bool parse(const char* beginDoc, const char* endDoc, Value& root,
              bool collectComments = true);
+  // Reads one element of a larger document: [begin, end) must hold the value
+  // and nothing but whitespace. Offsets and errors are relative to beginDoc.
+  bool parseElement(const char* beginDoc, const char* begin, const char* end,
+                    Value& element);
   String getFormattedErrorMessages() const;
   std::vector<StructuredError> getStructuredErrors() const;
 
@@ -1197,6 +1517,8 @@ private:
   bool decodeNumber(Token& token, Value& decoded);
   bool decodeString(Token& token);
   bool decodeString(Token& token, String& decoded);
+  bool isBorrowable(Token& token) const;
+  const char* borrowString(Token& token);
   bool decodeDouble(Token& token);
   bool decodeDouble(Token& token, Value& decoded);
   bool decodeUnicodeCodePoint(Token& token, Location& current, Location end,
@@ -1215,6 +1537,7 @@ private:
   String getLocationLineAndColumn(Location location) const;
   void addComment(Location begin, Location end, CommentPlacement placement);
   void skipCommentTokens(Token& token);
+  void readPendingComments();
 
   static String normalizeEOL(Location begin, Location end);
   static bool containsNewLine(Location begin, Location end);
@@ -1291,6 +1614,26 @@ bool OurReader::parse(const char* beginDoc, const char* endDoc, Value& root,
   return successful;
 }
 
+bool OurReader::parseElement(const char* beginDoc, const char* begin,
+                             const char* end, Value& element) {
+  begin_ = beginDoc;
+  end_ = end;
+  collectComments_ = false;
+  current_ = begin;
+  lastValueEnd_ = nullptr;
+  lastValue_ = nullptr;
+  commentsBefore_.clear();
+  errors_.clear();
+  while (!nodes_.empty())
+    nodes_.pop();
+  nodes_.push(&element);
+
+  bool successful = readValue();
+  nodes_.pop();
+  skipSpaces();
+  return successful && current_ == end_;
+}
+
 bool OurReader::readValue() {
   //  To preserve the old behaviour we cast size_t to int.
   if (nodes_.size() > features_.stackLimit_)
@@ -1393,6 +1736,25 @@ void OurReader::skipCommentTokens(Token& token) {
   }
 }
 
+// Reads the comments in front of the next token. A comment on the line of the
+// last value is then attached to it before a sibling is added, which may move
+// the last value when objects are flat. Later comments go before the next value
+// instead, since the last value can't be reached any more.
+void OurReader::readPendingComments() {
+  for (;;) {
+    skipSpaces();
+    if (current_ == end_ || *current_ != '/')
+      break;
+    Location commentBegin = current_;
+    Token comment;
+    if (!readToken(comment) || comment.type_ != tokenComment) {
+      current_ = commentBegin;
+      break;
+    }
+  }
+  lastValueEnd_ = nullptr;
+}
+
 bool OurReader::readToken(Token& token) {
   skipSpaces();
   token.start_ = current_;
@@ -1504,15 +1866,7 @@ bool OurReader::readToken(Token& token) {
   return ok;
 }
 
-void OurReader::skipSpaces() {
-  while (current_ != end_) {
-    Char c = *current_;
-    if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
-      ++current_;
-    else
-      break;
-  }
-}
+void OurReader::skipSpaces() { current_ = skipWhitespace(current_, end_); }
 
 void OurReader::skipBom(bool skipBom) {
   // The default behavior is to skip BOM.
@@ -1637,36 +1991,31 @@ bool OurReader::readNumber(bool checkInf) {
     current_ = ++p;
     return false;
   }
-  char c = '0'; // stopgap for already consumed character
   // integral part
-  while (c >= '0' && c <= '9')
-    c = (current_ = p) < end_ ? *p++ : '\0';
+  p = skipDigits(p, end_);
   // fractional part
-  if (c == '.') {
-    c = (current_ = p) < end_ ? *p++ : '\0';
-    while (c >= '0' && c <= '9')
-      c = (current_ = p) < end_ ? *p++ : '\0';
-  }
+  if (p != end_ && *p == '.')
+    p = skipDigits(p + 1, end_);
   // exponential part
-  if (c == 'e' || c == 'E') {
-    c = (current_ = p) < end_ ? *p++ : '\0';
-    if (c == '+' || c == '-')
-      c = (current_ = p) < end_ ? *p++ : '\0';
-    while (c >= '0' && c <= '9')
-      c = (current_ = p) < end_ ? *p++ : '\0';
+  if (p != end_ && (*p == 'e' || *p == 'E')) {
+    ++p;
+    if (p != end_ && (*p == '+' || *p == '-'))
+      ++p;
+    p = skipDigits(p, end_);
   }
+  current_ = p;
   return true;
 }
 bool OurReader::readString() {
-  Char c = 0;
-  while (current_ != end_) {
-    c = getNextChar();
-    if (c == '\\')
-      getNextChar();
-    else if (c == '"')
-      break;
+  for (;;) {
+    current_ = findQuoteOrBackslash(current_, end_);
+    if (current_ == end_)
+      return false;
+    if (*current_++ == '"')
+      return true;
+    // skip the escaped character
+    getNextChar();
   }
-  return c == '"';
 }
 
 bool OurReader::readStringSingleQuote() {
@@ -1684,6 +2033,8 @@ bool OurReader::readStringSingleQuote() {
 bool OurReader::readObject(Token& token) {
   Token tokenName;
   String name;
+  const char* borrowedName = nullptr;
+  size_t nameLength = 0;
   Value init(objectValue);
   currentValue().swapPayload(init);
   currentValue().setOffsetStart(token.start_ - begin_);
@@ -1694,11 +2045,15 @@ bool OurReader::readObject(Token& token) {
     if (!initialTokenOk)
       break;
     if (tokenName.type_ == tokenObjectEnd &&
-        (name.empty() ||
+        (nameLength == 0 ||
          features_.allowTrailingCommas_)) // empty object or trailing comma
       return true;
     name.clear();
-    if (tokenName.type_ == tokenString) {
+    borrowedName = nullptr;
+    if (tokenName.type_ == tokenString && isBorrowable(tokenName)) {
+      nameLength = static_cast<size_t>(tokenName.end_ - tokenName.start_ - 2);
+      borrowedName = borrowString(tokenName);
+    } else if (tokenName.type_ == tokenString) {
       if (!decodeString(tokenName, name))
         return recoverFromError(tokenObjectEnd);
     } else if (tokenName.type_ == tokenNumber && features_.allowNumericKeys_) {
@@ -1709,10 +2064,17 @@ bool OurReader::readObject(Token& token) {
     } else {
       break;
     }
-    if (name.length() >= (1U << 30))
+    if (borrowedName == nullptr)
+      nameLength = name.length();
+    if (nameLength >= (1U << 30))
       throwRuntimeError("keylength >= 2^30");
-    if (features_.rejectDupKeys_ && currentValue().isMember(name)) {
-      String msg = "Duplicate key: '" + name + "'";
+    if (features_.rejectDupKeys_ &&
+        (borrowedName != nullptr
+             ? currentValue().isMember(borrowedName, borrowedName + nameLength)
+             : currentValue().isMember(name))) {
+      String msg = "Duplicate key: '" +
+                   (borrowedName != nullptr ? String(borrowedName) : name) +
+                   "'";
       return addErrorAndRecover(msg, tokenName, tokenObjectEnd);
     }
 
@@ -1721,7 +2083,13 @@ bool OurReader::readObject(Token& token) {
       return addErrorAndRecover("Missing ':' after object member name", colon,
                                 tokenObjectEnd);
     }
-    Value& value = currentValue()[name];
+#if JSONCPP_USING_FLAT_OBJECTS
+    if (collectComments_)
+      readPendingComments();
+#endif
+    Value& value = borrowedName != nullptr
+                       ? currentValue()[StaticString(borrowedName)]
+                       : currentValue()[name];
     nodes_.push(&value);
     bool ok = readValue();
     nodes_.pop();
@@ -1762,6 +2130,10 @@ bool OurReader::readArray(Token& token) {
       readToken(endArray);
       return true;
     }
+#if JSONCPP_USING_FLAT_OBJECTS
+    if (collectComments_)
+      readPendingComments();
+#endif
     Value& value = currentValue()[index++];
     nodes_.push(&value);
     bool ok = readValue();
@@ -1905,6 +2277,13 @@ bool OurReader::decodeDouble(Token& token, Value& decoded) {
 }
 
 bool OurReader::decodeString(Token& token) {
+  if (isBorrowable(token)) {
+    Value borrowed(StaticString(borrowString(token)));
+    currentValue().swapPayload(borrowed);
+    currentValue().setOffsetStart(token.start_ - begin_);
+    currentValue().setOffsetLimit(token.end_ - begin_);
+    return true;
+  }
   String decoded_string;
   if (!decodeString(token, decoded_string))
     return false;
@@ -1968,6 +2347,22 @@ bool OurReader::decodeString(Token& token, String& decoded) {
   return true;
 }
 
+// Strings with escapes need decoding, and embedded nul characters would cut
+// a nul-terminated string short, so only the others are borrowed.
+bool OurReader::isBorrowable(Token& token) const {
+  if (!features_.zeroCopy_)
+    return false;
+  const auto length = static_cast<size_t>(token.end_ - token.start_ - 2);
+  return memchr(token.start_ + 1, '\\', length) == nullptr &&
+         memchr(token.start_ + 1, '\0', length) == nullptr;
+}
+
+// Nul-terminates the string over its closing quote, which was already read.
+const char* OurReader::borrowString(Token& token) {
+  *const_cast<char*>(token.end_ - 1) = '\0';
+  return token.start_ + 1;
+}
+
 bool OurReader::decodeUnicodeCodePoint(Token& token, Location& current,
                                        Location end, unsigned int& unicode) {
 
@@ -2129,25 +2524,29 @@ public:
 
 CharReaderBuilder::CharReaderBuilder() { setDefaults(&settings_); }
 CharReaderBuilder::~CharReaderBuilder() = default;
-CharReader* CharReaderBuilder::newCharReader() const {
-  bool collectComments = settings_["collectComments"].asBool();
+static OurFeatures featuresFromSettings(Value const& settings) {
   OurFeatures features = OurFeatures::all();
-  features.allowComments_ = settings_["allowComments"].asBool();
-  features.allowTrailingCommas_ = settings_["allowTrailingCommas"].asBool();
-  features.strictRoot_ = settings_["strictRoot"].asBool();
+  features.allowComments_ = settings["allowComments"].asBool();
+  features.allowTrailingCommas_ = settings["allowTrailingCommas"].asBool();
+  features.strictRoot_ = settings["strictRoot"].asBool();
   features.allowDroppedNullPlaceholders_ =
-      settings_["allowDroppedNullPlaceholders"].asBool();
-  features.allowNumericKeys_ = settings_["allowNumericKeys"].asBool();
-  features.allowSingleQuotes_ = settings_["allowSingleQuotes"].asBool();
+      settings["allowDroppedNullPlaceholders"].asBool();
+  features.allowNumericKeys_ = settings["allowNumericKeys"].asBool();
+  features.allowSingleQuotes_ = settings["allowSingleQuotes"].asBool();
 
   // Stack limit is always a size_t, so we get this as an unsigned int
   // regardless of it we have 64-bit integer support enabled.
-  features.stackLimit_ = static_cast<size_t>(settings_["stackLimit"].asUInt());
-  features.failIfExtra_ = settings_["failIfExtra"].asBool();
-  features.rejectDupKeys_ = settings_["rejectDupKeys"].asBool();
-  features.allowSpecialFloats_ = settings_["allowSpecialFloats"].asBool();
-  features.skipBom_ = settings_["skipBom"].asBool();
-  return new OurCharReader(collectComments, features);
+  features.stackLimit_ = static_cast<size_t>(settings["stackLimit"].asUInt());
+  features.failIfExtra_ = settings["failIfExtra"].asBool();
+  features.rejectDupKeys_ = settings["rejectDupKeys"].asBool();
+  features.allowSpecialFloats_ = settings["allowSpecialFloats"].asBool();
+  features.skipBom_ = settings["skipBom"].asBool();
+  return features;
+}
+
+CharReader* CharReaderBuilder::newCharReader() const {
+  bool collectComments = settings_["collectComments"].asBool();
+  return new OurCharReader(collectComments, featuresFromSettings(settings_));
 }
 
 bool CharReaderBuilder::validate(Json::Value* invalid) const {
@@ -2174,44 +2573,731 @@ bool CharReaderBuilder::validate(Json::Value* invalid) const {
     else
       return false;
   }
-  return invalid ? invalid->empty() : true;
+  return invalid ? invalid->empty() : true;
+}
+
+Value& CharReaderBuilder::operator[](const String& key) {
+  return settings_[key];
+}
+// static
+void CharReaderBuilder::strictMode(Json::Value* settings) {
+  //! [CharReaderBuilderStrictMode]
+  (*settings)["allowComments"] = false;
+  (*settings)["allowTrailingCommas"] = false;
+  (*settings)["strictRoot"] = true;
+  (*settings)["allowDroppedNullPlaceholders"] = false;
+  (*settings)["allowNumericKeys"] = false;
+  (*settings)["allowSingleQuotes"] = false;
+  (*settings)["stackLimit"] = 1000;
+  (*settings)["failIfExtra"] = true;
+  (*settings)["rejectDupKeys"] = true;
+  (*settings)["allowSpecialFloats"] = false;
+  (*settings)["skipBom"] = true;
+  //! [CharReaderBuilderStrictMode]
+}
+// static
+void CharReaderBuilder::setDefaults(Json::Value* settings) {
+  //! [CharReaderBuilderDefaults]
+  (*settings)["collectComments"] = true;
+  (*settings)["allowComments"] = true;
+  (*settings)["allowTrailingCommas"] = true;
+  (*settings)["strictRoot"] = false;
+  (*settings)["allowDroppedNullPlaceholders"] = false;
+  (*settings)["allowNumericKeys"] = false;
+  (*settings)["allowSingleQuotes"] = false;
+  (*settings)["stackLimit"] = 1000;
+  (*settings)["failIfExtra"] = false;
+  (*settings)["rejectDupKeys"] = false;
+  (*settings)["allowSpecialFloats"] = false;
+  (*settings)["skipBom"] = true;
+  //! [CharReaderBuilderDefaults]
+}
+
+//////////////////////////////////
+// Document
+
+Document::Document(CharReaderBuilder const& builder)
+    : settings_(builder.settings_) {}
+
+Document::~Document() = default;
+
+bool Document::parse(String text, String* errs) {
+  auto owned = std::make_shared<String>(std::move(text));
+  char* begin = &(*owned)[0];
+  char* end = begin + owned->size();
+  return parse(begin, end, std::move(owned), errs);
+}
+
+bool Document::parse(char* beginDoc, char* endDoc, std::shared_ptr<void> owner,
+                     String* errs) {
+  // Release the previous tree before the buffer its strings point into
+  root_ = Value();
+  buffer_ = std::move(owner);
+
+  OurFeatures features = featuresFromSettings(settings_);
+  features.zeroCopy_ = true;
+  OurReader reader(features);
+  bool ok = reader.parse(beginDoc, endDoc, root_,
+                         settings_["collectComments"].asBool());
+  if (errs) {
+    *errs = reader.getFormattedErrorMessages();
+  }
+  return ok;
+}
+
+//////////////////////////////////
+// parseArrayParallel
+
+// Smaller documents are parsed on the calling thread, starting threads costs
+// more than it saves.
+static size_t const parallelParseThreshold = 64 * 1024;
+// Number of elements a thread takes at a time.
+static size_t const parallelParseChunk = 16;
+
+using ElementRange = std::pair<char const*, char const*>;
+
+// Finds the elements of a root array without parsing them, by tracking
+// strings and bracket depth. Returns false when the document has to be
+// parsed in one piece: a root that is not an array, comments, empty
+// elements, unbalanced brackets or anything after the array. Invalid
+// elements are left for the element parser to reject.
+static bool splitRootArray(char const* begin, char const* end,
+                           bool allowTrailingCommas,
+                           std::vector<ElementRange>& elements,
+                           char const*& arrayBegin, char const*& arrayEnd) {
+  char const* current = skipWhitespace(begin, end);
+  if (current == end || *current != '[')
+    return false;
+  arrayBegin = current++;
+  char const* elementBegin = current;
+  int depth = 0;
+  while (current != end) {
+    switch (*current) {
+    case '"':
+      for (++current;; current += 2) {
+        current = findQuoteOrBackslash(current, end);
+        if (current == end || (*current == '\\' && end - current < 2))
+          return false;
+        if (*current == '"')
+          break;
+      }
+      break;
+    case '[':
+    case '{':
+      ++depth;
+      break;
+    case '}':
+      if (depth == 0)
+        return false;
+      --depth;
+      break;
+    case ']':
+      if (depth > 0) {
+        --depth;
+        break;
+      }
+      if (skipWhitespace(elementBegin, current) != current) {
+        elements.emplace_back(elementBegin, current);
+      } else if (!elements.empty() && !allowTrailingCommas) {
+        return false;
+      }
+      arrayEnd = current + 1;
+      return skipWhitespace(arrayEnd, end) == end;
+    case ',':
+      if (depth > 0)
+        break;
+      if (skipWhitespace(elementBegin, current) == current)
+        return false;
+      elements.emplace_back(elementBegin, current);
+      elementBegin = current + 1;
+      break;
+    case '/':
+      return false;
+    default:
+      break;
+    }
+    ++current;
+  }
+  return false;
+}
+
+bool parseArrayParallel(CharReaderBuilder const& builder,
+                        char const* beginDoc, char const* endDoc,
+                        unsigned int threadCount, Value* root, String* errs) {
+  OurFeatures const features = featuresFromSettings(builder.settings_);
+  if (threadCount == 0)
+    threadCount = std::max(1U, std::thread::hardware_concurrency());
+
+  // Offsets are relative to the text after the byte order mark, like in
+  // OurReader::parse()
+  char const* begin = beginDoc;
+  if (features.skipBom_ && endDoc - beginDoc >= 3 &&
+      strncmp(beginDoc, "\xEF\xBB\xBF", 3) == 0)
+    begin += 3;
+
+  // Dropped null placeholders and single quotes change where elements end
+  std::vector<ElementRange> elements;
+  char const* arrayBegin = nullptr;
+  char const* arrayEnd = nullptr;
+  bool const isSplit =
+      threadCount > 1 &&
+      static_cast<size_t>(endDoc - beginDoc) >= parallelParseThreshold &&
+      !features.allowDroppedNullPlaceholders_ &&
+      !features.allowSingleQuotes_ && features.stackLimit_ > 1 &&
+      splitRootArray(begin, endDoc, features.allowTrailingCommas_, elements,
+                     arrayBegin, arrayEnd) &&
+      elements.size() > 1;
+
+  if (isSplit) {
+    Value result(arrayValue);
+    result.resize(static_cast<ArrayIndex>(elements.size()));
+    std::vector<Value*> slots(elements.size());
+    for (size_t i = 0; i < slots.size(); ++i)
+      slots[i] = &result[static_cast<ArrayIndex>(i)];
+
+    // The elements sit one level below the root
+    OurFeatures elementFeatures = features;
+    --elementFeatures.stackLimit_;
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    auto parseElements = [&]() {
+      OurReader reader(elementFeatures);
+#if JSON_USE_EXCEPTION
+      try {
+#endif
+        while (!failed) {
+          size_t const first = next.fetch_add(parallelParseChunk);
+          size_t const last = std::min(first + parallelParseChunk, slots.size());
+          if (first >= last)
+            break;
+          for (size_t i = first; i < last; ++i) {
+            if (!reader.parseElement(begin, elements[i].first,
+                                     elements[i].second, *slots[i])) {
+              failed = true;
+              break;
+            }
+          }
+        }
+#if JSON_USE_EXCEPTION
+      } catch (...) {
+        // Parsed again below, on the caller's thread
+        failed = true;
+      }
+#endif
+    };
+
+    threadCount = static_cast<unsigned int>(std::min<size_t>(
+        threadCount, (slots.size() + parallelParseChunk - 1) /
+                         parallelParseChunk));
+    std::vector<std::thread> threads;
+#if JSON_USE_EXCEPTION
+    try {
+#endif
+      for (unsigned int i = 1; i < threadCount; ++i)
+        threads.emplace_back(parseElements);
+#if JSON_USE_EXCEPTION
+    } catch (...) {
+      // Out of threads, stop the ones that started and parse in one piece
+      failed = true;
+    }
+#endif
+    if (!failed)
+      parseElements();
+    for (std::thread& thread : threads)
+      thread.join();
+
+    if (!failed) {
+      root->swapPayload(result);
+      root->setOffsetStart(arrayBegin - begin);
+      root->setOffsetLimit(arrayEnd - begin);
+      if (errs)
+        errs->clear();
+      return true;
+    }
+  }
+
+  // Parse in one piece, which also gives the errors their usual positions
+  OurCharReader reader(builder.settings_["collectComments"].asBool(),
+                       features);
+  return reader.parse(beginDoc, endDoc, root, errs);
+}
+
+//////////////////////////////////
+// ParseEventHandler
+
+ParseEventHandler::~ParseEventHandler() = default;
+bool ParseEventHandler::onNull() { return true; }
+bool ParseEventHandler::onBool(bool /*value*/) { return true; }
+bool ParseEventHandler::onInt(LargestInt /*value*/) { return true; }
+bool ParseEventHandler::onUInt(LargestUInt /*value*/) { return true; }
+bool ParseEventHandler::onDouble(double /*value*/) { return true; }
+bool ParseEventHandler::onString(char const* /*begin*/, char const* /*end*/) {
+  return true;
+}
+bool ParseEventHandler::onObjectBegin() { return true; }
+bool ParseEventHandler::onKey(char const* /*begin*/, char const* /*end*/) {
+  return true;
+}
+bool ParseEventHandler::onObjectEnd() { return true; }
+bool ParseEventHandler::onArrayBegin() { return true; }
+bool ParseEventHandler::onArrayEnd() { return true; }
+
+// Recursive descent reader that hands every token to a ParseEventHandler
+// instead of building Values. Stops at the first error.
+class OurEventReader {
+public:
+  using Char = char;
+  using Location = const Char*;
+
+  explicit OurEventReader(ParseEventHandler& handler) : handler_(handler) {}
+
+  bool parse(const char* beginDoc, const char* endDoc);
+  String getFormattedErrorMessages() const;
+
+private:
+  OurEventReader(OurEventReader const&);      // no impl
+  void operator=(OurEventReader const&);      // no impl
+
+  static constexpr unsigned int stackLimit_ = 1000;
+
+  bool readValue(unsigned int depth);
+  bool readObject(unsigned int depth);
+  bool readArray(unsigned int depth);
+  bool readString(Location& begin, Location& end);
+  bool readEscapedString(Location start, Location& begin, Location& end);
+  bool readUnicodeEscape(unsigned int& unicode);
+  bool readNumber();
+  bool readDouble(Location start);
+  bool readLiteral(const char* literal, size_t length);
+  bool skipSpaces();
+  bool addError(const char* message, Location location);
+  bool stopped();
+
+  ParseEventHandler& handler_;
+  Location begin_{};
+  Location end_{};
+  Location current_{};
+  Location errorLocation_{};
+  String errorMessage_;
+  String decoded_;
+};
+
+bool OurEventReader::parse(const char* beginDoc, const char* endDoc) {
+  begin_ = beginDoc;
+  end_ = endDoc;
+  current_ = begin_;
+  errorLocation_ = nullptr;
+  errorMessage_.clear();
+
+  // skip byte order mark if it exists
+  if (end_ - current_ >= 3 && strncmp(current_, "\xEF\xBB\xBF", 3) == 0)
+    current_ += 3;
+
+  if (!skipSpaces())
+    return false;
+  if (current_ == end_)
+    return addError("Syntax error: value, object or array expected.",
+                    current_);
+  if (!readValue(0))
+    return false;
+  if (!skipSpaces())
+    return false;
+  if (current_ != end_)
+    return addError("Extra non-whitespace after JSON value.", current_);
+  return true;
+}
+
+bool OurEventReader::readValue(unsigned int depth) {
+  if (depth > stackLimit_)
+    return addError("Exceeded stackLimit in readValue().", current_);
+  if (current_ == end_)
+    return addError("Syntax error: value, object or array expected.",
+                    current_);
+
+  switch (*current_) {
+  case '{':
+    return readObject(depth);
+  case '[':
+    return readArray(depth);
+  case '"': {
+    Location begin;
+    Location end;
+    if (!readString(begin, end))
+      return false;
+    return handler_.onString(begin, end) || stopped();
+  }
+  case 't':
+    return readLiteral("true", 4) && (handler_.onBool(true) || stopped());
+  case 'f':
+    return readLiteral("false", 5) && (handler_.onBool(false) || stopped());
+  case 'n':
+    return readLiteral("null", 4) && (handler_.onNull() || stopped());
+  case '-':
+  case '0':
+  case '1':
+  case '2':
+  case '3':
+  case '4':
+  case '5':
+  case '6':
+  case '7':
+  case '8':
+  case '9':
+    return readNumber();
+  default:
+    return addError("Syntax error: value, object or array expected.",
+                    current_);
+  }
+}
+
+bool OurEventReader::readObject(unsigned int depth) {
+  ++current_; // '{'
+  if (!handler_.onObjectBegin())
+    return stopped();
+
+  if (!skipSpaces())
+    return false;
+  if (current_ != end_ && *current_ == '}') {
+    ++current_;
+    return handler_.onObjectEnd() || stopped();
+  }
+
+  for (;;) {
+    if (current_ == end_ || *current_ != '"')
+      return addError("Missing '}' or object member name", current_);
+
+    Location begin;
+    Location end;
+    if (!readString(begin, end))
+      return false;
+    if (!handler_.onKey(begin, end))
+      return stopped();
+
+    if (!skipSpaces())
+      return false;
+    if (current_ == end_ || *current_ != ':')
+      return addError("Missing ':' after object member name", current_);
+    ++current_;
+
+    if (!skipSpaces())
+      return false;
+    if (!readValue(depth + 1))
+      return false;
+
+    if (!skipSpaces())
+      return false;
+    if (current_ != end_ && *current_ == ',') {
+      ++current_;
+      if (!skipSpaces())
+        return false;
+      // trailing comma
+      if (current_ != end_ && *current_ == '}') {
+        ++current_;
+        return handler_.onObjectEnd() || stopped();
+      }
+      continue;
+    }
+    if (current_ != end_ && *current_ == '}') {
+      ++current_;
+      return handler_.onObjectEnd() || stopped();
+    }
+    return addError("Missing ',' or '}' in object declaration", current_);
+  }
+}
+
+bool OurEventReader::readArray(unsigned int depth) {
+  ++current_; // '['
+  if (!handler_.onArrayBegin())
+    return stopped();
+
+  if (!skipSpaces())
+    return false;
+  if (current_ != end_ && *current_ == ']') {
+    ++current_;
+    return handler_.onArrayEnd() || stopped();
+  }
+
+  for (;;) {
+    if (!readValue(depth + 1))
+      return false;
+
+    if (!skipSpaces())
+      return false;
+    if (current_ != end_ && *current_ == ',') {
+      ++current_;
+      if (!skipSpaces())
+        return false;
+      // trailing comma
+      if (current_ != end_ && *current_ == ']') {
+        ++current_;
+        return handler_.onArrayEnd() || stopped();
+      }
+      continue;
+    }
+    if (current_ != end_ && *current_ == ']') {
+      ++current_;
+      return handler_.onArrayEnd() || stopped();
+    }
+    return addError("Missing ',' or ']' in array declaration", current_);
+  }
+}
+
+bool OurEventReader::readString(Location& begin, Location& end) {
+  const Location start = current_++; // '"'
+  const Location first = current_;
+
+  // Strings without escapes are handed out directly from the document
+  current_ = findQuoteOrBackslash(current_, end_);
+  if (current_ == end_)
+    return addError("Missing '\"' at the end of string", start);
+
+  if (*current_ == '"') {
+    begin = first;
+    end = current_++;
+    return true;
+  }
+  return readEscapedString(first, begin, end);
+}
+
+bool OurEventReader::readEscapedString(Location start, Location& begin,
+                                       Location& end) {
+  decoded_.assign(start, current_);
+
+  while (current_ != end_) {
+    Char c = *current_++;
+    if (c == '"') {
+      begin = decoded_.data();
+      end = begin + decoded_.size();
+      return true;
+    }
+    if (c != '\\') {
+      decoded_ += c;
+      continue;
+    }
+    if (current_ == end_)
+      break;
+    Char escape = *current_++;
+    switch (escape) {
+    case '"':
+      decoded_ += '"';
+      break;
+    case '/':
+      decoded_ += '/';
+      break;
+    case '\\':
+      decoded_ += '\\';
+      break;
+    case 'b':
+      decoded_ += '\b';
+      break;
+    case 'f':
+      decoded_ += '\f';
+      break;
+    case 'n':
+      decoded_ += '\n';
+      break;
+    case 'r':
+      decoded_ += '\r';
+      break;
+    case 't':
+      decoded_ += '\t';
+      break;
+    case 'u': {
+      unsigned int unicode;
+      if (!readUnicodeEscape(unicode))
+        return false;
+      if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+        // surrogate pairs
+        if (end_ - current_ < 2 || current_[0] != '\\' || current_[1] != 'u')
+          return addError("expecting another \\u token to begin the second "
+                          "half of a unicode surrogate pair",
+                          current_);
+        current_ += 2;
+        unsigned int surrogatePair;
+        if (!readUnicodeEscape(surrogatePair))
+          return false;
+        unicode = 0x10000 + ((unicode & 0x3FF) << 10) + (surrogatePair & 0x3FF);
+      }
+      decoded_ += codePointToUTF8(unicode);
+    } break;
+    default:
+      return addError("Bad escape sequence in string", current_ - 2);
+    }
+  }
+  return addError("Missing '\"' at the end of string", start - 1);
+}
+
+bool OurEventReader::readUnicodeEscape(unsigned int& unicode) {
+  if (end_ - current_ < 4)
+    return addError(
+        "Bad unicode escape sequence in string: four digits expected.",
+        current_);
+  unicode = 0;
+  for (int index = 0; index < 4; ++index) {
+    Char c = *current_++;
+    unicode *= 16;
+    if (c >= '0' && c <= '9')
+      unicode += static_cast<unsigned int>(c - '0');
+    else if (c >= 'a' && c <= 'f')
+      unicode += static_cast<unsigned int>(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      unicode += static_cast<unsigned int>(c - 'A' + 10);
+    else
+      return addError(
+          "Bad unicode escape sequence in string: hexadecimal digit expected.",
+          current_ - 1);
+  }
+  return true;
+}
+
+bool OurEventReader::readNumber() {
+  const Location start = current_;
+  const bool isNegative = *current_ == '-';
+  if (isNegative)
+    ++current_;
+
+  // Integral part, accumulated while it can't overflow
+  const Location digitsBegin = current_;
+  Value::LargestUInt value = 0;
+  bool overflow = false;
+  while (current_ != end_ && *current_ >= '0' && *current_ <= '9') {
+    const auto digit = static_cast<Value::LargestUInt>(*current_ - '0');
+    if (value > (Value::maxLargestUInt - digit) / 10)
+      overflow = true;
+    else
+      value = value * 10 + digit;
+    ++current_;
+  }
+  if (current_ == digitsBegin)
+    return addError("Syntax error: value, object or array expected.", start);
+
+  bool isInteger = true;
+  if (current_ != end_ && *current_ == '.') {
+    isInteger = false;
+    ++current_;
+    while (current_ != end_ && *current_ >= '0' && *current_ <= '9')
+      ++current_;
+  }
+  if (current_ != end_ && (*current_ == 'e' || *current_ == 'E')) {
+    isInteger = false;
+    ++current_;
+    if (current_ != end_ && (*current_ == '+' || *current_ == '-'))
+      ++current_;
+    while (current_ != end_ && *current_ >= '0' && *current_ <= '9')
+      ++current_;
+  }
+
+  if (!isInteger || overflow)
+    return readDouble(start);
+
+  if (isNegative) {
+    // -minLargestInt doesn't fit a LargestInt, compare as unsigned
+    if (value > Value::LargestUInt(Value::maxLargestInt) + 1)
+      return readDouble(start);
+    const auto last_digit = static_cast<Value::UInt>(value % 10);
+    return handler_.onInt(-Value::LargestInt(value / 10) * 10 - last_digit) ||
+           stopped();
+  }
+  if (value <= Value::LargestUInt(Value::maxLargestInt))
+    return handler_.onInt(Value::LargestInt(value)) || stopped();
+  return handler_.onUInt(value) || stopped();
+}
+
+bool OurEventReader::readDouble(Location start) {
+  double value = 0;
+  const String buffer(start, current_);
+  IStringStream is(buffer);
+  if (!(is >> value)) {
+    if (value == std::numeric_limits<double>::max())
+      value = std::numeric_limits<double>::infinity();
+    else if (value == std::numeric_limits<double>::lowest())
+      value = -std::numeric_limits<double>::infinity();
+    else if (!std::isinf(value))
+      return addError("Number is not valid.", start);
+  }
+  return handler_.onDouble(value) || stopped();
 }
 
-Value& CharReaderBuilder::operator[](const String& key) {
-  return settings_[key];
+bool OurEventReader::readLiteral(const char* literal, size_t length) {
+  if (static_cast<size_t>(end_ - current_) < length ||
+      strncmp(current_, literal, length) != 0)
+    return addError("Syntax error: value, object or array expected.",
+                    current_);
+  current_ += length;
+  return true;
 }
-// static
-void CharReaderBuilder::strictMode(Json::Value* settings) {
-  //! [CharReaderBuilderStrictMode]
-  (*settings)["allowComments"] = false;
-  (*settings)["allowTrailingCommas"] = false;
-  (*settings)["strictRoot"] = true;
-  (*settings)["allowDroppedNullPlaceholders"] = false;
-  (*settings)["allowNumericKeys"] = false;
-  (*settings)["allowSingleQuotes"] = false;
-  (*settings)["stackLimit"] = 1000;
-  (*settings)["failIfExtra"] = true;
-  (*settings)["rejectDupKeys"] = true;
-  (*settings)["allowSpecialFloats"] = false;
-  (*settings)["skipBom"] = true;
-  //! [CharReaderBuilderStrictMode]
+
+bool OurEventReader::skipSpaces() {
+  for (;;) {
+    current_ = skipWhitespace(current_, end_);
+    if (current_ == end_ || *current_ != '/')
+      return true;
+
+    const Location start = current_;
+    if (end_ - current_ < 2)
+      return addError("Syntax error: value, object or array expected.",
+                      start);
+    if (current_[1] == '/') {
+      current_ += 2;
+      while (current_ != end_ && *current_ != '\n' && *current_ != '\r')
+        ++current_;
+    } else if (current_[1] == '*') {
+      current_ += 2;
+      for (;;) {
+        if (end_ - current_ < 2) {
+          current_ = end_;
+          return addError("Unterminated comment.", start);
+        }
+        if (current_[0] == '*' && current_[1] == '/') {
+          current_ += 2;
+          break;
+        }
+        ++current_;
+      }
+    } else {
+      return addError("Syntax error: value, object or array expected.",
+                      start);
+    }
+  }
 }
-// static
-void CharReaderBuilder::setDefaults(Json::Value* settings) {
-  //! [CharReaderBuilderDefaults]
-  (*settings)["collectComments"] = true;
-  (*settings)["allowComments"] = true;
-  (*settings)["allowTrailingCommas"] = true;
-  (*settings)["strictRoot"] = false;
-  (*settings)["allowDroppedNullPlaceholders"] = false;
-  (*settings)["allowNumericKeys"] = false;
-  (*settings)["allowSingleQuotes"] = false;
-  (*settings)["stackLimit"] = 1000;
-  (*settings)["failIfExtra"] = false;
-  (*settings)["rejectDupKeys"] = false;
-  (*settings)["allowSpecialFloats"] = false;
-  (*settings)["skipBom"] = true;
-  //! [CharReaderBuilderDefaults]
+
+bool OurEventReader::addError(const char* message, Location location) {
+  // Only the first error is kept, parsing stops there
+  if (errorLocation_ == nullptr) {
+    errorLocation_ = location;
+    errorMessage_ = message;
+  }
+  return false;
+}
+
+bool OurEventReader::stopped() {
+  return addError("Parsing stopped by the handler.", current_);
+}
+
+String OurEventReader::getFormattedErrorMessages() const {
+  if (errorLocation_ == nullptr)
+    return String();
+
+  int line = 1;
+  Location lastLineStart = begin_;
+  for (Location current = begin_; current < errorLocation_;) {
+    Char c = *current++;
+    if (c == '\r') {
+      if (current != end_ && *current == '\n')
+        ++current;
+      lastLineStart = current;
+      ++line;
+    } else if (c == '\n') {
+      lastLineStart = current;
+      ++line;
+    }
+  }
+  const int column = int(errorLocation_ - lastLineStart) + 1;
+
+  char buffer[18 + 16 + 16 + 1];
+  jsoncpp_snprintf(buffer, sizeof(buffer), "Line %d, Column %d", line, column);
+  return "* " + String(buffer) + "\n  " + errorMessage_ + "\n";
 }
 
 //////////////////////////////////
@@ -2239,6 +3325,16 @@ IStream& operator>>(IStream& sin, Value& root) {
   return sin;
 }
 
+bool parseEvents(char const* beginDoc, char const* endDoc,
+                 ParseEventHandler& handler, String* errs) {
+  OurEventReader reader(handler);
+  bool ok = reader.parse(beginDoc, endDoc);
+  if (errs) {
+    *errs = reader.getFormattedErrorMessages();
+  }
+  return ok;
+}
+
 } // namespace Json
 
 // //////////////////////////////////////////////////////////////////////
@@ -2531,6 +3627,23 @@ static inline bool InRange(double d, T min, U max) {
 }
 #endif // if !defined(JSON_USE_INT64_DOUBLE_CONVERSION)
 
+// String payloads come from the current ValueArena when arenas are enabled.
+static inline void* allocateStringMemory(size_t size) {
+#if JSONCPP_USING_ARENA_MEMORY
+  return ValueArena::allocateValueMemory(size);
+#else
+  return malloc(size);
+#endif
+}
+
+static inline void releaseStringMemory(void* value) {
+#if JSONCPP_USING_ARENA_MEMORY
+  ValueArena::releaseValueMemory(value);
+#else
+  free(value);
+#endif
+}
+
 /** Duplicates the specified string value.
  * @param value Pointer to the string to duplicate. Must be Zero-terminated if
  *              length is "unknown".
@@ -2544,7 +3657,7 @@ static inline char* duplicateStringValue(const char* value, size_t length) {
   if (length >= static_cast<size_t>(Value::maxInt))
     length = Value::maxInt - 1;
 
-  auto newString = static_cast<char*>(malloc(length + 1));
+  auto newString = static_cast<char*>(allocateStringMemory(length + 1));
   if (newString == nullptr) {
     throwRuntimeError("in Json::Value::duplicateStringValue(): "
                       "Failed to allocate string value buffer");
@@ -2565,7 +3678,7 @@ static inline char* duplicateAndPrefixStringValue(const char* value,
                       "in Json::Value::duplicateAndPrefixStringValue(): "
                       "length too big for prefixing");
   size_t actualLength = sizeof(length) + length + 1;
-  auto newString = static_cast<char*>(malloc(actualLength));
+  auto newString = static_cast<char*>(allocateStringMemory(actualLength));
   if (newString == nullptr) {
     throwRuntimeError("in Json::Value::duplicateAndPrefixStringValue(): "
                       "Failed to allocate string value buffer");
@@ -2605,10 +3718,129 @@ static inline void releaseStringValue(char* value, unsigned length) {
   free(value);
 }
 #else  // !JSONCPP_USING_SECURE_MEMORY
-static inline void releasePrefixedStringValue(char* value) { free(value); }
-static inline void releaseStringValue(char* value, unsigned) { free(value); }
+static inline void releasePrefixedStringValue(char* value) {
+  releaseStringMemory(value);
+}
+static inline void releaseStringValue(char* value, unsigned) {
+  releaseStringMemory(value);
+}
 #endif // JSONCPP_USING_SECURE_MEMORY
 
+static inline Value::ObjectValues* newObjectValues() {
+#if JSONCPP_USING_ARENA_MEMORY
+  void* memory = ValueArena::allocateValueMemory(sizeof(Value::ObjectValues));
+  return new (memory) Value::ObjectValues();
+#else
+  return new Value::ObjectValues();
+#endif
+}
+
+static inline Value::ObjectValues*
+newObjectValues(const Value::ObjectValues& other) {
+#if JSONCPP_USING_ARENA_MEMORY
+  void* memory = ValueArena::allocateValueMemory(sizeof(Value::ObjectValues));
+  try {
+    return new (memory) Value::ObjectValues(other);
+  } catch (...) {
+    ValueArena::releaseValueMemory(memory);
+    throw;
+  }
+#else
+  return new Value::ObjectValues(other);
+#endif
+}
+
+static inline void deleteObjectValues(Value::ObjectValues* values) {
+#if JSONCPP_USING_ARENA_MEMORY
+  using ObjectValues = Value::ObjectValues;
+  values->~ObjectValues();
+  ValueArena::releaseValueMemory(values);
+#else
+  delete values;
+#endif
+}
+
+#if JSONCPP_USING_ARENA_MEMORY
+// ////////////////////////////////////////////////////////////////
+// ////////////////////////////////////////////////////////////////
+// ////////////////////////////////////////////////////////////////
+// class ValueArena
+// ////////////////////////////////////////////////////////////////
+// ////////////////////////////////////////////////////////////////
+// ////////////////////////////////////////////////////////////////
+
+// Every allocation is preceded by a header naming the arena that owns it,
+// nullptr for heap memory. The header keeps the payload maximally aligned.
+static constexpr size_t arenaAlignment = alignof(std::max_align_t);
+static constexpr size_t arenaHeaderSize =
+    (sizeof(ValueArena*) + arenaAlignment - 1) / arenaAlignment *
+    arenaAlignment;
+
+static ValueArena*& currentValueArena() {
+  static thread_local ValueArena* arena = nullptr;
+  return arena;
+}
+
+ValueArena::ValueArena(size_t blockSize) : blockSize_(blockSize) {}
+
+ValueArena::~ValueArena() {
+  while (head_ != nullptr) {
+    Block* previous = head_->previous_;
+    ::operator delete(head_);
+    head_ = previous;
+  }
+}
+
+void* ValueArena::allocate(size_t size) {
+  size = (size + arenaAlignment - 1) / arenaAlignment * arenaAlignment;
+
+  if (static_cast<size_t>(end_ - current_) < size) {
+    static constexpr size_t blockHeaderSize =
+        (sizeof(Block) + arenaAlignment - 1) / arenaAlignment * arenaAlignment;
+    const size_t payloadSize = size > blockSize_ ? size : blockSize_;
+
+    auto block =
+        static_cast<Block*>(::operator new(blockHeaderSize + payloadSize));
+    block->previous_ = head_;
+    head_ = block;
+    ++blockCount_;
+
+    current_ = reinterpret_cast<char*>(block) + blockHeaderSize;
+    end_ = current_ + payloadSize;
+  }
+
+  void* memory = current_;
+  current_ += size;
+  bytesAllocated_ += size;
+  return memory;
+}
+
+ValueArena::Scope::Scope(ValueArena& arena) : previous_(currentValueArena()) {
+  currentValueArena() = &arena;
+}
+
+ValueArena::Scope::~Scope() { currentValueArena() = previous_; }
+
+void* ValueArena::allocateValueMemory(size_t size) {
+  ValueArena* arena = currentValueArena();
+  char* memory =
+      static_cast<char*>(arena != nullptr
+                             ? arena->allocate(arenaHeaderSize + size)
+                             : ::operator new(arenaHeaderSize + size));
+  *reinterpret_cast<ValueArena**>(memory) = arena;
+  return memory + arenaHeaderSize;
+}
+
+void ValueArena::releaseValueMemory(void* p) {
+  if (p == nullptr)
+    return;
+  char* memory = static_cast<char*>(p) - arenaHeaderSize;
+  // Arena memory is only reclaimed when the whole arena is destroyed
+  if (*reinterpret_cast<ValueArena**>(memory) == nullptr)
+    ::operator delete(memory);
+}
+#endif // JSONCPP_USING_ARENA_MEMORY
+
 } // namespace Json
 
 // //////////////////////////////////////////////////////////////////
@@ -2705,16 +3937,16 @@ void Value::CZString::swap(CZString& other) {
   std::swap(index_, other.index_);
 }
 
+// Keys are only assigned when the members of flat objects move. The string
+// this key owned is released, and a copy owns a duplicate like the copy
+// constructor's.
 Value::CZString& Value::CZString::operator=(const CZString& other) {
-  cstr_ = other.cstr_;
-  index_ = other.index_;
+  CZString(other).swap(*this);
   return *this;
 }
 
 Value::CZString& Value::CZString::operator=(CZString&& other) noexcept {
-  cstr_ = other.cstr_;
-  index_ = other.index_;
-  other.cstr_ = nullptr;
+  CZString(std::move(other)).swap(*this);
   return *this;
 }
 
@@ -2789,7 +4021,7 @@ Value::Value(ValueType type) {
     break;
   case arrayValue:
   case objectValue:
-    value_.map_ = new ObjectValues();
+    value_.map_ = newObjectValues();
     break;
   case booleanValue:
     value_.bool_ = false;
@@ -3424,7 +4656,7 @@ void Value::dupPayload(const Value& other) {
     break;
   case arrayValue:
   case objectValue:
-    value_.map_ = new ObjectValues(*other.value_.map_);
+    value_.map_ = newObjectValues(*other.value_.map_);
     break;
   default:
     JSON_ASSERT_UNREACHABLE;
@@ -3445,7 +4677,7 @@ void Value::releasePayload() {
     break;
   case arrayValue:
   case objectValue:
-    delete value_.map_;
+    deleteObjectValues(value_.map_);
     break;
   default:
     JSON_ASSERT_UNREACHABLE;
@@ -3571,6 +4803,8 @@ bool Value::insert(ArrayIndex index, Value&& newValue) {
   if (index > length) {
     return false;
   }
+  // Grow first, so no element is referenced while the storage may move
+  append(Value());
   for (ArrayIndex i = length; i > index; i--) {
     (*this)[i] = std::move((*this)[i - 1]);
   }
@@ -4165,28 +5399,302 @@ using StreamWriterPtr = std::unique_ptr<StreamWriter>;
 using StreamWriterPtr = std::auto_ptr<StreamWriter>;
 #endif
 
+namespace {
+// Shortest round-trip formatting of doubles with the Grisu2 algorithm
+// (Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+// with Integers", PLDI 2010). The digits always read back as the same
+// double. They are the shortest such digits for all but a fraction of a
+// percent of values, which get a few digits more (never more than 17).
+// No locale or heap is involved.
+
+// A floating point number f * 2^e with a 64-bit significand.
+struct DiyFp {
+  DiyFp(uint64_t f, int e) : f_(f), e_(e) {}
+
+  explicit DiyFp(double value) {
+    uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(value), "double must be 64 bits");
+    memcpy(&bits, &value, sizeof(bits));
+    const int biasedExponent = static_cast<int>((bits >> 52) & 0x7FF);
+    const uint64_t significand = bits & ((uint64_t(1) << 52) - 1);
+    if (biasedExponent != 0) {
+      f_ = significand + hiddenBit;
+      e_ = biasedExponent - exponentBias;
+    } else {
+      f_ = significand;
+      e_ = 1 - exponentBias;
+    }
+  }
+
+  DiyFp operator-(const DiyFp& rhs) const { return DiyFp(f_ - rhs.f_, e_); }
+
+  // The upper 64 bits of the 128-bit product, rounded.
+  DiyFp operator*(const DiyFp& rhs) const {
+    const uint64_t mask32 = 0xFFFFFFFFu;
+    const uint64_t a = f_ >> 32;
+    const uint64_t b = f_ & mask32;
+    const uint64_t c = rhs.f_ >> 32;
+    const uint64_t d = rhs.f_ & mask32;
+    const uint64_t ac = a * c;
+    const uint64_t bc = b * c;
+    const uint64_t ad = a * d;
+    const uint64_t bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & mask32) + (bc & mask32);
+    tmp += uint64_t(1) << 31;
+    return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e_ + rhs.e_ + 64);
+  }
+
+  DiyFp normalize() const {
+    DiyFp result = *this;
+    while ((result.f_ & (uint64_t(1) << 63)) == 0) {
+      result.f_ <<= 1;
+      result.e_--;
+    }
+    return result;
+  }
+
+  // The boundaries halfway to the neighbouring doubles, with the same exponent
+  void normalizedBoundaries(DiyFp* minus, DiyFp* plus) const {
+    DiyFp upper = DiyFp((f_ << 1) + 1, e_ - 1).normalize();
+    // The lower neighbour is closer when the significand is a power of two
+    DiyFp lower = (f_ == hiddenBit) ? DiyFp((f_ << 2) - 1, e_ - 2)
+                                    : DiyFp((f_ << 1) - 1, e_ - 1);
+    lower.f_ <<= lower.e_ - upper.e_;
+    lower.e_ = upper.e_;
+    *plus = upper;
+    *minus = lower;
+  }
+
+  static constexpr uint64_t hiddenBit = uint64_t(1) << 52;
+  static constexpr int exponentBias = 0x3FF + 52;
+
+  uint64_t f_;
+  int e_;
+};
+
+// Normalized powers 10^k for k = -348, -340, ..., 340
+DiyFp getCachedPower(int e, int* k) {
+  static const uint64_t significands[] = {
+      UINT64_C(0xfa8fd5a0081c0288), UINT64_C(0xbaaee17fa23ebf76), UINT64_C(0x8b16fb203055ac76),
+      UINT64_C(0xcf42894a5dce35ea), UINT64_C(0x9a6bb0aa55653b2d), UINT64_C(0xe61acf033d1a45df),
+      UINT64_C(0xab70fe17c79ac6ca), UINT64_C(0xff77b1fcbebcdc4f), UINT64_C(0xbe5691ef416bd60c),
+      UINT64_C(0x8dd01fad907ffc3c), UINT64_C(0xd3515c2831559a83), UINT64_C(0x9d71ac8fada6c9b5),
+      UINT64_C(0xea9c227723ee8bcb), UINT64_C(0xaecc49914078536d), UINT64_C(0x823c12795db6ce57),
+      UINT64_C(0xc21094364dfb5637), UINT64_C(0x9096ea6f3848984f), UINT64_C(0xd77485cb25823ac7),
+      UINT64_C(0xa086cfcd97bf97f4), UINT64_C(0xef340a98172aace5), UINT64_C(0xb23867fb2a35b28e),
+      UINT64_C(0x84c8d4dfd2c63f3b), UINT64_C(0xc5dd44271ad3cdba), UINT64_C(0x936b9fcebb25c996),
+      UINT64_C(0xdbac6c247d62a584), UINT64_C(0xa3ab66580d5fdaf6), UINT64_C(0xf3e2f893dec3f126),
+      UINT64_C(0xb5b5ada8aaff80b8), UINT64_C(0x87625f056c7c4a8b), UINT64_C(0xc9bcff6034c13053),
+      UINT64_C(0x964e858c91ba2655), UINT64_C(0xdff9772470297ebd), UINT64_C(0xa6dfbd9fb8e5b88f),
+      UINT64_C(0xf8a95fcf88747d94), UINT64_C(0xb94470938fa89bcf), UINT64_C(0x8a08f0f8bf0f156b),
+      UINT64_C(0xcdb02555653131b6), UINT64_C(0x993fe2c6d07b7fac), UINT64_C(0xe45c10c42a2b3b06),
+      UINT64_C(0xaa242499697392d3), UINT64_C(0xfd87b5f28300ca0e), UINT64_C(0xbce5086492111aeb),
+      UINT64_C(0x8cbccc096f5088cc), UINT64_C(0xd1b71758e219652c), UINT64_C(0x9c40000000000000),
+      UINT64_C(0xe8d4a51000000000), UINT64_C(0xad78ebc5ac620000), UINT64_C(0x813f3978f8940984),
+      UINT64_C(0xc097ce7bc90715b3), UINT64_C(0x8f7e32ce7bea5c70), UINT64_C(0xd5d238a4abe98068),
+      UINT64_C(0x9f4f2726179a2245), UINT64_C(0xed63a231d4c4fb27), UINT64_C(0xb0de65388cc8ada8),
+      UINT64_C(0x83c7088e1aab65db), UINT64_C(0xc45d1df942711d9a), UINT64_C(0x924d692ca61be758),
+      UINT64_C(0xda01ee641a708dea), UINT64_C(0xa26da3999aef774a), UINT64_C(0xf209787bb47d6b85),
+      UINT64_C(0xb454e4a179dd1877), UINT64_C(0x865b86925b9bc5c2), UINT64_C(0xc83553c5c8965d3d),
+      UINT64_C(0x952ab45cfa97a0b3), UINT64_C(0xde469fbd99a05fe3), UINT64_C(0xa59bc234db398c25),
+      UINT64_C(0xf6c69a72a3989f5c), UINT64_C(0xb7dcbf5354e9bece), UINT64_C(0x88fcf317f22241e2),
+      UINT64_C(0xcc20ce9bd35c78a5), UINT64_C(0x98165af37b2153df), UINT64_C(0xe2a0b5dc971f303a),
+      UINT64_C(0xa8d9d1535ce3b396), UINT64_C(0xfb9b7cd9a4a7443c), UINT64_C(0xbb764c4ca7a44410),
+      UINT64_C(0x8bab8eefb6409c1a), UINT64_C(0xd01fef10a657842c), UINT64_C(0x9b10a4e5e9913129),
+      UINT64_C(0xe7109bfba19c0c9d), UINT64_C(0xac2820d9623bf429), UINT64_C(0x80444b5e7aa7cf85),
+      UINT64_C(0xbf21e44003acdd2d), UINT64_C(0x8e679c2f5e44ff8f), UINT64_C(0xd433179d9c8cb841),
+      UINT64_C(0x9e19db92b4e31ba9), UINT64_C(0xeb96bf6ebadf77d9), UINT64_C(0xaf87023b9bf0ee6b),
+  };
+  static const int16_t exponents[] = {
+      -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+      -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+      -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+      -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+      -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+      109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+      375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+      641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+      907, 933, 960, 986, 1013, 1039, 1066,
+  };
+
+  // Pick the power that brings the exponent of the product into [-60, -32]
+  const double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int ik = static_cast<int>(dk);
+  if (dk - ik > 0.0)
+    ik++;
+  const auto index = static_cast<unsigned int>((ik >> 3) + 1);
+  *k = -(-348 + static_cast<int>(index << 3));
+  return DiyFp(significands[index], exponents[index]);
+}
+
+const uint64_t powersOf10[] = {1u,
+                               10u,
+                               100u,
+                               1000u,
+                               10000u,
+                               100000u,
+                               1000000u,
+                               10000000u,
+                               100000000u,
+                               1000000000u,
+                               10000000000u,
+                               100000000000u,
+                               1000000000000u,
+                               10000000000000u,
+                               100000000000000u,
+                               1000000000000000u,
+                               10000000000000000u,
+                               100000000000000000u,
+                               1000000000000000000u,
+                               10000000000000000000u};
+
+// Move the last digit towards the exact value while it stays in range
+void grisuRound(char* buffer, int length, uint64_t delta, uint64_t rest,
+                uint64_t tenKappa, uint64_t distance) {
+  while (rest < distance && delta - rest >= tenKappa &&
+         (rest + tenKappa < distance ||
+          distance - rest > rest + tenKappa - distance)) {
+    buffer[length - 1]--;
+    rest += tenKappa;
+  }
+}
+
+void digitGen(const DiyFp& w, const DiyFp& upper, uint64_t delta,
+              char* buffer, int* length, int* k) {
+  const DiyFp one(uint64_t(1) << -upper.e_, upper.e_);
+  const DiyFp distance = upper - w;
+  auto p1 = static_cast<uint32_t>(upper.f_ >> -one.e_);
+  uint64_t p2 = upper.f_ & (one.f_ - 1);
+  auto kappa = static_cast<int>(countDecimalDigits(p1));
+  *length = 0;
+
+  // integral digits
+  while (kappa > 0) {
+    const auto divisor = static_cast<uint32_t>(powersOf10[kappa - 1]);
+    const uint32_t d = p1 / divisor;
+    p1 %= divisor;
+    if (d != 0 || *length != 0)
+      buffer[(*length)++] = static_cast<char>('0' + d);
+    kappa--;
+    const uint64_t rest = (static_cast<uint64_t>(p1) << -one.e_) + p2;
+    if (rest <= delta) {
+      *k += kappa;
+      grisuRound(buffer, *length, delta, rest,
+                 powersOf10[kappa] << -one.e_, distance.f_);
+      return;
+    }
+  }
+
+  // fractional digits
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    const auto d = static_cast<char>(p2 >> -one.e_);
+    if (d != 0 || *length != 0)
+      buffer[(*length)++] = static_cast<char>('0' + d);
+    p2 &= one.f_ - 1;
+    kappa--;
+    if (p2 < delta) {
+      *k += kappa;
+      const int index = -kappa;
+      grisuRound(buffer, *length, delta, p2, one.f_,
+                 distance.f_ * (index < 20 ? powersOf10[index] : 0));
+      return;
+    }
+  }
+}
+
+// Digits of a positive finite double: value = digits * 10^k
+void grisu2(double value, char* buffer, int* length, int* k) {
+  const DiyFp v(value);
+  DiyFp lower(0, 0);
+  DiyFp upper(0, 0);
+  v.normalizedBoundaries(&lower, &upper);
+
+  const DiyFp cachedPower = getCachedPower(upper.e_, k);
+  const DiyFp w = v.normalize() * cachedPower;
+  DiyFp scaledUpper = upper * cachedPower;
+  DiyFp scaledLower = lower * cachedPower;
+  scaledLower.f_++;
+  scaledUpper.f_--;
+  digitGen(w, scaledUpper, scaledUpper.f_ - scaledLower.f_, buffer, length, k);
+}
+
+/** Writes the shortest text that reads back as value, laid out like "%.17g":
+ * plain notation for decimal exponents in [-4, 17), scientific otherwise.
+ * @param value A finite double.
+ * @param out Output buffer, must have at least 32 chars.
+ * @return One past the last char written. Nothing is nul-terminated.
+ */
+char* writeShortestDouble(double value, char* out) {
+  if (std::signbit(value)) {
+    *out++ = '-';
+    value = -value;
+  }
+  if (value == 0.0) {
+    *out++ = '0';
+    return out;
+  }
+
+  char digits[18];
+  int length;
+  int k;
+  grisu2(value, digits, &length, &k);
+
+  // decimal exponent of the first digit
+  const int exponent = length + k - 1;
+
+  if (exponent >= -4 && exponent < 17) {
+    if (exponent < 0) {
+      // 0.000ddd
+      *out++ = '0';
+      *out++ = '.';
+      for (int i = -1; i > exponent; --i)
+        *out++ = '0';
+      memcpy(out, digits, static_cast<size_t>(length));
+      return out + length;
+    }
+    if (k >= 0) {
+      // ddd000
+      memcpy(out, digits, static_cast<size_t>(length));
+      out += length;
+      for (int i = 0; i < k; ++i)
+        *out++ = '0';
+      return out;
+    }
+    // ddd.ddd
+    memcpy(out, digits, static_cast<size_t>(exponent + 1));
+    out += exponent + 1;
+    *out++ = '.';
+    memcpy(out, digits + exponent + 1,
+           static_cast<size_t>(length - exponent - 1));
+    return out + length - exponent - 1;
+  }
+
+  // d.ddde+XX
+  *out++ = digits[0];
+  if (length > 1) {
+    *out++ = '.';
+    memcpy(out, digits + 1, static_cast<size_t>(length - 1));
+    out += length - 1;
+  }
+  *out++ = 'e';
+  *out++ = exponent < 0 ? '-' : '+';
+  const int absExponent = exponent < 0 ? -exponent : exponent;
+  if (absExponent < 10)
+    *out++ = '0';
+  return writeUInt(static_cast<LargestUInt>(absExponent), out);
+}
+} // namespace
+
 String valueToString(LargestInt value) {
   UIntToStringBuffer buffer;
-  char* current = buffer + sizeof(buffer);
-  if (value == Value::minLargestInt) {
-    uintToString(LargestUInt(Value::maxLargestInt) + 1, current);
-    *--current = '-';
-  } else if (value < 0) {
-    uintToString(LargestUInt(-value), current);
-    *--current = '-';
-  } else {
-    uintToString(LargestUInt(value), current);
-  }
-  assert(current >= buffer);
-  return current;
+  return String(buffer, writeInt(value, buffer));
 }
 
 String valueToString(LargestUInt value) {
   UIntToStringBuffer buffer;
-  char* current = buffer + sizeof(buffer);
-  uintToString(value, current);
-  assert(current >= buffer);
-  return current;
+  return String(buffer, writeUInt(value, buffer));
 }
 
 #if defined(JSON_HAS_INT64)
@@ -4210,6 +5718,21 @@ String valueToString(double value, bool useSpecialFloats,
                [isnan(value) ? 0 : (value < 0) ? 1 : 2];
   }
 
+  // Full precision only asks for a round trip, which the shortest digits give
+  if (precisionType == PrecisionType::significantDigits &&
+      precision >= Value::defaultRealPrecision) {
+    char shortest[32];
+    char* end = writeShortestDouble(value, shortest);
+    // try to ensure we preserve the fact that this was given to us as a
+    // double on input
+    if (std::find(shortest, end, '.') == end &&
+        std::find(shortest, end, 'e') == end) {
+      *end++ = '.';
+      *end++ = '0';
+    }
+    return String(shortest, end);
+  }
+
   String buffer(size_t(36), '\0');
   while (true) {
     int len = jsoncpp_snprintf(
@@ -4458,12 +5981,14 @@ void FastWriter::writeValue(const Value& value) {
     if (!dropNullPlaceholders_)
       document_ += "null";
     break;
-  case intValue:
-    document_ += valueToString(value.asLargestInt());
-    break;
-  case uintValue:
-    document_ += valueToString(value.asLargestUInt());
-    break;
+  case intValue: {
+    UIntToStringBuffer buffer;
+    document_.append(buffer, writeInt(value.asLargestInt(), buffer));
+  } break;
+  case uintValue: {
+    UIntToStringBuffer buffer;
+    document_.append(buffer, writeUInt(value.asLargestUInt(), buffer));
+  } break;
   case realValue:
     document_ += valueToString(value.asDouble());
     break;
@@ -4962,6 +6487,7 @@ private:
   void writeArrayValue(Value const& value);
   bool isMultilineArray(Value const& value);
   void pushValue(String const& value);
+  void pushValue(char const* begin, char const* end);
   void writeIndent();
   void writeWithIndent(String const& value);
   void indent();
@@ -5017,12 +6543,14 @@ void BuiltStyledStreamWriter::writeValue(Value const& value) {
   case nullValue:
     pushValue(nullSymbol_);
     break;
-  case intValue:
-    pushValue(valueToString(value.asLargestInt()));
-    break;
-  case uintValue:
-    pushValue(valueToString(value.asLargestUInt()));
-    break;
+  case intValue: {
+    UIntToStringBuffer buffer;
+    pushValue(buffer, writeInt(value.asLargestInt(), buffer));
+  } break;
+  case uintValue: {
+    UIntToStringBuffer buffer;
+    pushValue(buffer, writeUInt(value.asLargestUInt(), buffer));
+  } break;
   case realValue:
     pushValue(valueToString(value.asDouble(), useSpecialFloats_, precision_,
                             precisionType_));
@@ -5159,6 +6687,13 @@ void BuiltStyledStreamWriter::pushValue(String const& value) {
     *sout_ << value;
 }
 
+void BuiltStyledStreamWriter::pushValue(char const* begin, char const* end) {
+  if (addChildValues_)
+    childValues_.emplace_back(begin, end);
+  else
+    sout_->write(begin, end - begin);
+}
+
 void BuiltStyledStreamWriter::writeIndent() {
   // blep intended this to look at the so-far-written string
   // to determine whether we are already indented, but
@@ -5316,6 +6851,218 @@ void StreamWriterBuilder::setDefaults(Json::Value* settings) {
   //! [StreamWriterBuilderDefaults]
 }
 
+// Class EventWriter
+// //////////////////////////////////////////////////////////////////
+
+EventWriter::EventWriter(String indentation)
+    : indentation_(std::move(indentation)), lineBreaks_("\n"),
+      isAfterKey_(false) {}
+
+void EventWriter::clear() {
+  buffer_.clear();
+  scopes_.clear();
+  isAfterKey_ = false;
+}
+
+bool EventWriter::isComplete() const {
+  return scopes_.empty() && !buffer_.empty();
+}
+
+void EventWriter::writeLineBreak(size_t depth) {
+  if (indentation_.empty())
+    return;
+  // The indentation of every level is a prefix of the deepest one, so it is
+  // built once per new depth instead of once per line.
+  size_t const length = 1 + depth * indentation_.size();
+  while (lineBreaks_.size() < length)
+    lineBreaks_ += indentation_;
+  buffer_.append(lineBreaks_.data(), length);
+}
+
+void EventWriter::writeQuoted(char const* begin, char const* end) {
+  size_t const length = static_cast<size_t>(end - begin);
+  if (doesAnyCharRequireEscaping(begin, length)) {
+    buffer_ += valueToQuotedStringN(begin, length);
+    return;
+  }
+  buffer_ += '"';
+  buffer_.append(begin, length);
+  buffer_ += '"';
+}
+
+void EventWriter::writePendingBreak() {
+  Scope& scope = scopes_.back();
+  if (!scope.isBreakPending)
+    return;
+  // The first member, move the opening bracket to its own line
+  char const bracket = buffer_.back();
+  buffer_.pop_back();
+  writeLineBreak(scopes_.size() - 1);
+  buffer_ += bracket;
+  scope.isBreakPending = false;
+}
+
+void EventWriter::beginValue() {
+  if (scopes_.empty()) {
+    JSON_ASSERT_MESSAGE(buffer_.empty(),
+                        "EventWriter: the document already has a root value");
+    return;
+  }
+  Scope& scope = scopes_.back();
+  if (scope.isObject) {
+    JSON_ASSERT_MESSAGE(isAfterKey_,
+                        "EventWriter: object members need a key");
+    isAfterKey_ = false;
+    return;
+  }
+  writePendingBreak();
+  if (scope.hasMembers)
+    buffer_ += ',';
+  scope.hasMembers = true;
+  writeLineBreak(scopes_.size());
+}
+
+void EventWriter::beginContainer(bool isObject, char bracket) {
+  // A container that is an object member only gets its own line when it has
+  // members, like "key" : {} or "key" : \n {...} in the styled writers.
+  bool const isMember =
+      !scopes_.empty() && scopes_.back().isObject && isAfterKey_;
+  beginValue();
+  buffer_ += bracket;
+  scopes_.push_back(Scope{isObject, false, isMember});
+}
+
+void EventWriter::endContainer(bool isObject, char bracket) {
+  JSON_ASSERT_MESSAGE(!scopes_.empty() && scopes_.back().isObject == isObject,
+                      "EventWriter: mismatched end of object or array");
+  JSON_ASSERT_MESSAGE(!isAfterKey_, "EventWriter: key without a value");
+  bool const hasMembers = scopes_.back().hasMembers;
+  scopes_.pop_back();
+  if (hasMembers)
+    writeLineBreak(scopes_.size());
+  buffer_ += bracket;
+}
+
+EventWriter& EventWriter::objectBegin() {
+  beginContainer(true, '{');
+  return *this;
+}
+
+EventWriter& EventWriter::objectEnd() {
+  endContainer(true, '}');
+  return *this;
+}
+
+EventWriter& EventWriter::arrayBegin() {
+  beginContainer(false, '[');
+  return *this;
+}
+
+EventWriter& EventWriter::arrayEnd() {
+  endContainer(false, ']');
+  return *this;
+}
+
+EventWriter& EventWriter::key(char const* begin, char const* end) {
+  JSON_ASSERT_MESSAGE(!scopes_.empty() && scopes_.back().isObject &&
+                          !isAfterKey_,
+                      "EventWriter: key outside of an object");
+  writePendingBreak();
+  Scope& scope = scopes_.back();
+  if (scope.hasMembers)
+    buffer_ += ',';
+  scope.hasMembers = true;
+  writeLineBreak(scopes_.size());
+  writeQuoted(begin, end);
+  if (indentation_.empty())
+    buffer_ += ':';
+  else
+    buffer_ += " : ";
+  isAfterKey_ = true;
+  return *this;
+}
+
+EventWriter& EventWriter::key(char const* key) {
+  return this->key(key, key + strlen(key));
+}
+
+EventWriter& EventWriter::key(String const& key) {
+  return this->key(key.data(), key.data() + key.length());
+}
+
+EventWriter& EventWriter::nullValue() {
+  beginValue();
+  buffer_ += "null";
+  return *this;
+}
+
+EventWriter& EventWriter::value(bool value) {
+  beginValue();
+  buffer_ += value ? "true" : "false";
+  return *this;
+}
+
+EventWriter& EventWriter::value(Int value) {
+  beginValue();
+  char digits[24];
+  buffer_.append(digits, writeInt(value, digits));
+  return *this;
+}
+
+EventWriter& EventWriter::value(UInt value) {
+  beginValue();
+  char digits[24];
+  buffer_.append(digits, writeUInt(value, digits));
+  return *this;
+}
+
+#if defined(JSON_HAS_INT64)
+
+EventWriter& EventWriter::value(Int64 value) {
+  beginValue();
+  char digits[24];
+  buffer_.append(digits, writeInt(value, digits));
+  return *this;
+}
+
+EventWriter& EventWriter::value(UInt64 value) {
+  beginValue();
+  char digits[24];
+  buffer_.append(digits, writeUInt(value, digits));
+  return *this;
+}
+
+#endif // if defined(JSON_HAS_INT64)
+
+EventWriter& EventWriter::value(double value) {
+  beginValue();
+  if (!isfinite(value)) {
+    buffer_ += isnan(value) ? "null" : (value < 0) ? "-1e+9999" : "1e+9999";
+    return *this;
+  }
+  char digits[32];
+  char* end = writeShortestDouble(value, digits);
+  buffer_.append(digits, end);
+  // Keep it a real number when it is read back
+  if (std::find(digits, end, '.') == end && std::find(digits, end, 'e') == end)
+    buffer_ += ".0";
+  return *this;
+}
+
+EventWriter& EventWriter::value(char const* begin, char const* end) {
+  beginValue();
+  writeQuoted(begin, end);
+  return *this;
+}
+
+EventWriter& EventWriter::value(char const* value) {
+  return this->value(value, value + strlen(value));
+}
+
+EventWriter& EventWriter::value(String const& value) {
+  return this->value(value.data(), value.data() + value.length());
+}
+
 String writeString(StreamWriter::Factory const& factory, Value const& root) {
   OStringStream sout;
   StreamWriterPtr const writer(factory.newStreamWriter());
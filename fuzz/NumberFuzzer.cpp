@@ -0,0 +1,97 @@
+// libFuzzer harness over the number formatting of the bundled jsoncpp's writer.
+// The input is read as 8 byte doubles and integers. Every finite double has to read back through strtod as
+// the same bits, in at most 17 significant digits, and every integer has to print like std::to_string.
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "json/json.h"
+
+namespace
+{
+	void checkDouble(const double value)
+	{
+		if (!std::isfinite(value)) return;
+
+		const std::string text = Json::valueToString(value);
+
+		char* end = nullptr;
+		const double reread = std::strtod(text.c_str(), &end);
+		if (end != text.c_str() + text.size() || std::memcmp(&reread, &value, sizeof(value)) != 0) {
+			std::abort();
+		}
+
+		// Significant digits before the exponent, without the leading zeros and the zeros of the ".0" suffix
+		std::string digits;
+		for (const char c : text)
+		{
+			if (c == 'e' || c == 'E') break;
+			if (c < '0' || c > '9' || (c == '0' && digits.empty())) continue;
+			digits += c;
+		}
+		while (!digits.empty() && digits.back() == '0') {
+			digits.pop_back();
+		}
+		if (digits.size() > 17) {
+			std::abort();
+		}
+	}
+
+	void checkIntegers(const uint64_t bits)
+	{
+		const Json::LargestUInt unsignedValue = (Json::LargestUInt)bits;
+		Json::LargestInt signedValue;
+		std::memcpy(&signedValue, &bits, sizeof(signedValue));
+
+		if (Json::valueToString(unsignedValue) != std::to_string(unsignedValue)
+			|| Json::valueToString(signedValue) != std::to_string(signedValue)) {
+			std::abort();
+		}
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	Json::Value numbers(Json::arrayValue);
+
+	for (; size >= 8; data += 8, size -= 8)
+	{
+		uint64_t bits;
+		std::memcpy(&bits, data, sizeof(bits));
+
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+
+		checkDouble(value);
+		checkIntegers(bits);
+		if (std::isfinite(value)) {
+			numbers.append(value);
+		}
+	}
+
+	// The writer formats them the same way inside a document
+	Json::StreamWriterBuilder writerBuilder;
+	writerBuilder["indentation"] = "";
+	const std::string written = Json::writeString(writerBuilder, numbers);
+
+	Json::CharReaderBuilder builder;
+	const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+	Json::Value reread;
+	if (!pReader->parse(written.data(), written.data() + written.size(), &reread, nullptr) || reread.size() != numbers.size()) {
+		std::abort();
+	}
+	for (Json::ArrayIndex i = 0; i < numbers.size(); i++)
+	{
+		const double expected = numbers[i].asDouble();
+		const double actual = reread[i].asDouble();
+		if (std::memcmp(&expected, &actual, sizeof(expected)) != 0) {
+			std::abort();
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,61 @@
+// libFuzzer harness over Json::CharReader::parse of the bundled jsoncpp.
+// The first byte of the input picks the reader's features, the rest is the document.
+// Every document that parses has to be written and parsed back again.
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "json/json.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	if (size < 1) return 0;
+
+	const uint8_t features = data[0];
+	const char* const begin = (const char*)data + 1;
+	const char* const end = (const char*)data + size;
+
+	Json::CharReaderBuilder builder;
+	builder.settings_["failIfExtra"] = (features & 1) != 0;
+	builder.settings_["allowComments"] = (features & 2) != 0;
+	builder.settings_["strictRoot"] = (features & 4) != 0;
+	builder.settings_["allowDroppedNullPlaceholders"] = (features & 8) != 0;
+	builder.settings_["allowNumericKeys"] = (features & 16) != 0;
+	builder.settings_["allowSingleQuotes"] = (features & 32) != 0;
+	builder.settings_["rejectDupKeys"] = (features & 64) != 0;
+	builder.settings_["allowSpecialFloats"] = (features & 128) != 0;
+	builder.settings_["collectComments"] = (features & 2) != 0;
+	builder.settings_["stackLimit"] = 100;
+
+	const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+	Json::Value root;
+	Json::String errors;
+
+	try
+	{
+		if (!pReader->parse(begin, end, &root, &errors)) return 0;
+	}
+	catch (const Json::Exception&)
+	{
+		// Documents nested past the stack limit throw
+		return 0;
+	}
+
+	// What the writer makes of a parsed document, the default reader has to take back
+	Json::StreamWriterBuilder writerBuilder;
+	writerBuilder["useSpecialFloats"] = true;
+	const std::string written = Json::writeString(writerBuilder, root);
+
+	Json::CharReaderBuilder defaultBuilder;
+	defaultBuilder.settings_["allowSpecialFloats"] = true;
+	defaultBuilder.settings_["stackLimit"] = 1000;
+	const std::unique_ptr<Json::CharReader> pDefaultReader(defaultBuilder.newCharReader());
+	Json::Value reread;
+	if (!pDefaultReader->parse(written.data(), written.data() + written.size(), &reread, &errors)) {
+		std::abort();
+	}
+
+	return 0;
+}
@@ -0,0 +1,145 @@
+// Runs a libFuzzer harness without libFuzzer, for compilers that don't have it.
+//
+//   reader_fuzzer [-runs=N] [-seed=S] <file or directory>...
+//
+// Every input file is run as it is, then N inputs mutated from them with a fixed seed.
+// It doesn't learn from coverage like libFuzzer does, it only keeps the corpus and a sanitized build exercised.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace
+{
+	typedef std::vector<uint8_t> Input;
+
+	bool isDirectory(const std::string& path)
+	{
+		struct stat status;
+		return stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+	}
+
+	void readInputs(const std::string& path, std::vector<Input>& inputs)
+	{
+		if (!isDirectory(path))
+		{
+			std::ifstream file(path, std::ios::binary);
+			inputs.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			return;
+		}
+
+		DIR* const pDirectory = opendir(path.c_str());
+		if (pDirectory == nullptr) return;
+
+		while (const dirent* pEntry = readdir(pDirectory))
+		{
+			if (pEntry->d_name[0] != '.') {
+				readInputs(path + '/' + pEntry->d_name, inputs);
+			}
+		}
+		closedir(pDirectory);
+	}
+
+	// Small xorshift generator, the same mutations for the same seed on every platform
+	class Random
+	{
+	private:
+		uint64_t state_;
+
+	public:
+		explicit Random(const uint64_t seed) : state_(seed != 0 ? seed : 1) {}
+
+		uint64_t next()
+		{
+			state_ ^= state_ << 13;
+			state_ ^= state_ >> 7;
+			state_ ^= state_ << 17;
+			return state_;
+		}
+
+		size_t below(const size_t bound) { return bound != 0 ? (size_t)(next() % bound) : 0; }
+	};
+
+	Input mutate(const std::vector<Input>& corpus, Random& random)
+	{
+		static const char tokens[] = "{}[]:,\"\\/*-+.eE0123456789tfnul \n";
+
+		Input input = corpus[random.below(corpus.size())];
+		const size_t mutationCount = 1 + random.below(8);
+
+		for (size_t i = 0; i < mutationCount; i++)
+		{
+			const size_t position = random.below(input.size() + 1);
+
+			switch (random.below(5))
+			{
+			case 0: // flip a bit
+				if (!input.empty()) input[random.below(input.size())] ^= (uint8_t)(1 << random.below(8));
+				break;
+			case 1: // insert a json token character
+				input.insert(input.begin() + position, (uint8_t)tokens[random.below(sizeof(tokens) - 1)]);
+				break;
+			case 2: // erase a range
+				if (position < input.size()) input.erase(input.begin() + position, input.begin() + std::min(input.size(), position + 1 + random.below(8)));
+				break;
+			case 3: // duplicate a range, which nests brackets deeper
+			{
+				const size_t length = std::min(input.size() - std::min(position, input.size()), 1 + random.below(16));
+				const Input range(input.begin() + position, input.begin() + position + length);
+				input.insert(input.begin() + position, range.begin(), range.end());
+			}
+				break;
+			default: // splice in part of another input
+			{
+				const Input& other = corpus[random.below(corpus.size())];
+				const size_t start = random.below(other.size());
+				const size_t length = std::min(other.size() - start, random.below(32));
+				input.insert(input.begin() + position, other.begin() + start, other.begin() + start + length);
+			}
+				break;
+			}
+		}
+
+		return input;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	long runs = 0;
+	uint64_t seed = 1;
+	std::vector<Input> corpus;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strncmp(argv[i], "-runs=", 6) == 0) runs = std::atol(argv[i] + 6);
+		else if (std::strncmp(argv[i], "-seed=", 6) == 0) seed = std::strtoull(argv[i] + 6, nullptr, 10);
+		else readInputs(argv[i], corpus);
+	}
+
+	if (corpus.empty()) corpus.emplace_back();
+
+	for (const Input& input : corpus) {
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	Random random(seed);
+	for (long run = 0; run < runs; run++)
+	{
+		const Input input = mutate(corpus, random);
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	std::printf("Ran %zu corpus inputs and %ld mutated ones\n", corpus.size(), runs);
+	return 0;
+}
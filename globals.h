@@ -1,7 +1,10 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <Windows.h>
 
+#include "InputCodes.h"
+
 // HWND Control IDs
 constexpr byte CID_OK = 100;
 constexpr byte CID_CANCEL = 101;
@@ -16,14 +19,20 @@ constexpr byte CID_CON_START = 113;
 constexpr byte CID_CON_TIMER1 = 114;
 constexpr byte CID_CON_TIMER2 = 115;
 constexpr byte CID_CON_START_NO_RESET = 117;
+constexpr byte CID_LATENCY = 118;
 constexpr byte MENU_QUIT = 1;
 constexpr byte MENU_SETTINGS = 0;
+constexpr byte OPTION_TRANSPARENT = 3;
+constexpr byte OPTION_CLICKTHROUGH = 4;
+
+// Hotkey actions, the ids they're registered under in the ActionRegistry
 constexpr byte KEY_START = 0;
-constexpr byte KEY_START_NO_RESET = 5;
 constexpr byte KEY_TIMER1 = 1;
 constexpr byte KEY_TIMER2 = 2;
-constexpr byte OPTION_TRANSPARENT = 3;
-constexpr byte OPTION_CLICKTHROUGH = 4;
+constexpr byte KEY_START_NO_RESET = 5;
+constexpr byte KEY_NEXT_PROFILE = 6;
+constexpr byte KEY_UNDO = 7;
+constexpr byte KEY_REDO = 8;
 
 // HWND Color Control IDs
 constexpr byte CID_TIMER_COLOR = 108;
@@ -32,24 +41,6 @@ constexpr byte CID_LAST_SECONDS_COLOR = 110;
 constexpr byte CID_BACKGROUND_COLOR = 111;
 constexpr byte CID_COLOR_PREVIEW = 25;
 
-// Controller input Buttons
-constexpr USHORT CONTROLLER_UP = 5000;
-constexpr USHORT CONTROLLER_DOWN = 5001;
-constexpr USHORT CONTROLLER_RIGHT = 5002;
-constexpr USHORT CONTROLLER_LEFT = 5003;
-constexpr USHORT CONTROLLER_START = 5004;
-constexpr USHORT CONTROLLER_BACK = 5005;
-constexpr USHORT CONTROLLER_LEFT_THUMB = 5006;
-constexpr USHORT CONTROLLER_RIGHT_THUMB = 5007;
-constexpr USHORT CONTROLLER_LEFT_SHOULDER = 5008;
-constexpr USHORT CONTROLLER_RIGHT_SHOULDER = 5009;
-constexpr USHORT CONTROLLER_A = 5010;
-constexpr USHORT CONTROLLER_B = 5011;
-constexpr USHORT CONTROLLER_X = 5012;
-constexpr USHORT CONTROLLER_Y = 5013;
-constexpr USHORT CONTROLLER_LEFT_TRIGGER = 5014;
-constexpr USHORT CONTROLLER_RIGHT_TRIGGER = 5015;
-
 // Playstation controller input buttons
 constexpr USHORT PS_CONTROLLER_START = 16;
 constexpr USHORT PS_CONTROLLER_BACK = 32;
@@ -74,39 +65,65 @@ constexpr byte IDB_CONTROLLER = 111;
 
 // Custom HWND messages
 constexpr int REFRESH_BRUSHES(WM_APP + 1);
-constexpr int HOTKEY_HIT(WM_APP + 2);
+constexpr int INPUT_EVENTS(WM_APP + 2);
 constexpr int CONTROLLER_INPUT(WM_APP + 3);
+constexpr int SETTINGS_CHANGED(WM_APP + 4);
 
 // Configuration File Names
 #define SETTINGS_FILE_NAME "Settings.json"
+#define LATENCY_FILE_NAME "Latency.csv"
 
 // Structs
-struct ColorsStruct // With default values
+struct ColorsStruct // Default values and valid ranges are listed in SettingsSchema.h
 {
-	int timerColor = 9;
-	int selectedTimerColor = 6;
-	int lastSecondsColor = 1;
-	int backgroundColor = 20;
+	int timerColor;
+	int selectedTimerColor;
+	int lastSecondsColor;
+	int backgroundColor;
+
+	ColorsStruct(); // Initializes the default values
 };
 
-struct SettingsStruct // With default values
+struct BindingStruct // An extra hotkey of the bindings array, on top of the fixed hotkey settings
 {
-	int startKey = 70;
-	int timer1Key = 112;
-	int timer2Key = 113;
-	int startNoResetKey = 72;
-	int conStartKey = CONTROLLER_A;
-	int conTimer1Key = CONTROLLER_LEFT;
-	int conTimer2Key = CONTROLLER_RIGHT;
-	int conStartNoResetKey = CONTROLLER_B;
-	bool optionStartOnChange = false;
-	bool optionTransparent = false;
-	bool optionClickThrough = false;
+	std::string action; // the name the action is registered under
+	int keyCode; // a keyboard hotkey or a controller button
+
+	bool operator==(const BindingStruct& other) const { return action == other.action && keyCode == other.keyCode; }
+	bool operator!=(const BindingStruct& other) const { return !(*this == other); }
+};
+
+struct ProfileStruct // A named set of bindings, that take over their hotkeys while the profile is active
+{
+	std::string name;
+	std::vector<BindingStruct> bindings;
+
+	bool operator==(const ProfileStruct& other) const { return name == other.name && bindings == other.bindings; }
+	bool operator!=(const ProfileStruct& other) const { return !(*this == other); }
+};
+
+struct SettingsStruct // Default values and valid ranges are listed in SettingsSchema.h
+{
+	int startKey;
+	int timer1Key;
+	int timer2Key;
+	int startNoResetKey;
+	int conStartKey;
+	int conTimer1Key;
+	int conTimer2Key;
+	int conStartNoResetKey;
+	int debounceTime;
+	bool optionStartOnChange;
+	bool optionTransparent;
+	bool optionClickThrough;
 	ColorsStruct colors;
+	std::vector<BindingStruct> bindings; // any number of hotkeys per action, empty by default
+	std::vector<ProfileStruct> profiles; // switched between with the nextProfile action, empty by default
+
+	SettingsStruct(); // Initializes the default values
 };
 
 // Variables
 extern HINSTANCE hInstanceGlobal;
 extern HBRUSH hBrushes[25];
-extern SettingsStruct appSettings;
 extern HWND hwndMainWindow;
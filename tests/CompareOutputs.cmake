@@ -0,0 +1,16 @@
+# Runs two programs and fails unless they print the same.
+#
+#   cmake -DFIRST=<program> -DSECOND=<program> -DOUTPUT_DIR=<directory> -P CompareOutputs.cmake
+foreach(program FIRST SECOND)
+	get_filename_component(name ${${program}} NAME)
+	set(${program}_OUTPUT ${OUTPUT_DIR}/${name}.out)
+	execute_process(COMMAND ${${program}} OUTPUT_FILE ${${program}_OUTPUT} RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "${${program}} failed: ${result}")
+	endif()
+endforeach()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${FIRST_OUTPUT} ${SECOND_OUTPUT} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "${FIRST_OUTPUT} and ${SECOND_OUTPUT} differ")
+endif()
@@ -0,0 +1,212 @@
+// Recorded key streams played back through the input path: auto-repeats, bounces and chords
+// must queue exactly the actions that were meant, once each
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AppClock.h"
+#include "HotkeyManager.h"
+#include "InputQueue.h"
+#include "ReplayInputBackend.h"
+
+namespace
+{
+	char mainWindow; // only compared against nullptr, messages go to the stand-in PostMessage
+
+	// keyEventCallback of Program.cpp, without the recorder
+	void handleKeyEvent(const KeyEvent& event)
+	{
+		if (event.code >= CONTROLLER_UP)
+		{
+			if (event.isDown && HotkeyManager::controllerDown(event.code, event.time)) {
+				InputQueue::pushController((WORD)event.code, event.time);
+			}
+			return;
+		}
+
+		if (event.isDown) {
+			HotkeyManager::keyDown(event.code, event.time);
+		}
+		else {
+			HotkeyManager::keyUp(event.code);
+		}
+	}
+
+	class HotkeyReplayTest : public testing::Test
+	{
+	protected:
+		// Every test plays from it's own file, ctest runs them as separate processes side by side
+		std::string fileName_;
+
+		void SetUp() override
+		{
+			fileName_ = std::string("hotkey_replay_") + testing::UnitTest::GetInstance()->current_test_info()->name() + ".txt";
+
+			// Every test replays far from the last one's presses, so they can't count as bounces of them
+			static uint32_t startTime = 0;
+			AppClock::setVirtualTime(startTime += 1000000);
+
+			bind(30);
+			hwndMainWindow = reinterpret_cast<HWND>(&mainWindow);
+		}
+
+		void TearDown() override
+		{
+			hwndMainWindow = nullptr;
+			std::remove(fileName_.c_str());
+		}
+
+		static void bind(const int debounceTime)
+		{
+			HotkeyManager::setHotkeysMap({
+				{ VK_F1, KEY_TIMER1 },
+				{ HOTKEY_CTRL | VK_F2, KEY_TIMER2 },
+				{ VK_F3, KEY_START },
+				{ VK_F3, KEY_UNDO },
+			}, debounceTime);
+		}
+
+		/**
+		@brief Play a recording through a ReplayInputBackend, as fast as it goes, and drain what it queued.
+
+		@param recording The recording as text, one "<time> <code> <1 for down, 0 for up>" event per line.
+
+		@return The queued hotkey actions and controller buttons, in the order they were queued.
+		*/
+		std::vector<int> replay(const std::string& recording)
+		{
+			std::ofstream(fileName_, std::ios::trunc) << recording;
+
+			std::vector<KeyEvent> events;
+			EXPECT_TRUE(ReplayInputBackend::parse(recording.data(), recording.data() + recording.size(), events));
+
+			std::atomic<size_t> handledCount(0);
+			ReplayInputBackend backend(fileName_, false);
+			backend.setInputCallback([&](const KeyEvent& event)
+				{
+					handleKeyEvent(event);
+					handledCount++;
+				});
+
+			EXPECT_TRUE(backend.start());
+
+			// A few events take microseconds, the deadline only keeps a broken replay from hanging the test
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while (handledCount.load() < events.size() && std::chrono::steady_clock::now() < deadline) {
+				std::this_thread::yield();
+			}
+			backend.stop();
+			EXPECT_EQ(handledCount.load(), events.size()) << "the replay didn't report every event in time";
+
+			std::vector<int> codes;
+			InputQueue::beginDrain();
+			InputEvent event;
+			bool isHotkey;
+			while (InputQueue::pop(event, isHotkey)) {
+				codes.push_back(event.code);
+			}
+
+			return codes;
+		}
+	};
+}
+
+TEST_F(HotkeyReplayTest, HeldKeyFiresOnce)
+{
+	std::string recording = "0 112 1\n";
+	for (int time = 500; time < 1500; time += 33) {
+		recording += std::to_string(time) + " 112 1\n";
+	}
+	recording += "1510 112 0\n";
+
+	EXPECT_EQ(replay(recording), std::vector<int>({ KEY_TIMER1 }));
+}
+
+TEST_F(HotkeyReplayTest, HeldKeyFiresAgainAfterMissedRelease)
+{
+	// The release went to the lock screen, the next down is a new press
+	EXPECT_EQ(replay(
+		"0 112 1\n"
+		"500 112 1\n"
+		"3000 112 1\n"
+		"3500 112 1\n"
+		"3600 112 0\n"),
+		std::vector<int>({ KEY_TIMER1, KEY_TIMER1 }));
+}
+
+TEST_F(HotkeyReplayTest, BouncingKeyFiresOnce)
+{
+	const std::string recording =
+		"0 112 1\n"
+		"8 112 0\n"
+		"15 112 1\n"
+		"40 112 0\n"
+		"200 112 1\n"
+		"260 112 0\n";
+
+	EXPECT_EQ(replay(recording), std::vector<int>({ KEY_TIMER1, KEY_TIMER1 }));
+
+	bind(0);
+	EXPECT_EQ(replay(recording), std::vector<int>({ KEY_TIMER1, KEY_TIMER1, KEY_TIMER1 }));
+}
+
+TEST_F(HotkeyReplayTest, BouncingControllerButtonFiresOnce)
+{
+	EXPECT_EQ(replay(
+		"0 5010 1\n"
+		"5 5010 0\n"
+		"12 5010 1\n"
+		"20 5010 0\n"
+		"100 5010 1\n"
+		"101 5011 1\n"
+		"130 5010 0\n"),
+		std::vector<int>({ CONTROLLER_A, CONTROLLER_A, CONTROLLER_B }));
+}
+
+TEST_F(HotkeyReplayTest, ChordsFireOnlyTheirAction)
+{
+	EXPECT_EQ(replay(
+		"0 162 1\n"
+		"500 162 1\n"
+		"530 162 1\n"
+		"540 113 1\n"
+		"560 113 1\n"
+		"600 113 0\n"
+		"650 112 1\n"
+		"700 112 0\n"
+		"710 162 0\n"
+		"1000 113 1\n"
+		"1050 113 0\n"),
+		std::vector<int>({ KEY_TIMER2, KEY_TIMER1 }));
+}
+
+TEST_F(HotkeyReplayTest, KeyWithSeveralActionsFiresEachOnce)
+{
+	EXPECT_EQ(replay(
+		"0 114 1\n"
+		"500 114 1\n"
+		"533 114 1\n"
+		"540 114 0\n"),
+		std::vector<int>({ KEY_START, KEY_UNDO }));
+}
+
+TEST_F(HotkeyReplayTest, UnboundKeysFireNothing)
+{
+	EXPECT_EQ(replay(
+		"0 32 1\n"
+		"500 32 1\n"
+		"510 32 0\n"
+		"520 65 1\n"
+		"530 65 0\n"
+		"540 1 1\n"
+		"550 1 0\n"
+		"560 113 1\n"
+		"570 113 0\n"),
+		std::vector<int>());
+}
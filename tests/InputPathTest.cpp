@@ -0,0 +1,245 @@
+// The path from a key reaching the hook to the action being queued can't allocate or wait on a lock,
+// Windows skips hook procedures that take longer than LowLevelHooksTimeout
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "HotkeyManager.h"
+#include "InputQueue.h"
+#include "LatencyMonitor.h"
+
+namespace
+{
+	// What the watched thread did while a HookPathWatch was open on it
+	thread_local bool isWatching = false;
+	thread_local int allocationCount = 0;
+	thread_local int lockCount = 0;
+
+	void* allocate(const std::size_t size)
+	{
+		if (isWatching) allocationCount++;
+		return std::malloc(size != 0 ? size : 1);
+	}
+
+	// Counts what the code run in it's scope allocates and locks, on this thread only
+	class HookPathWatch
+	{
+	public:
+		HookPathWatch()
+		{
+			allocationCount = 0;
+			lockCount = 0;
+			isWatching = true;
+		}
+
+		~HookPathWatch()
+		{
+			isWatching = false;
+		}
+
+		int allocations() const { return allocationCount; }
+		int locks() const { return lockCount; }
+
+		// Prevent copying, the counters are per thread
+
+		HookPathWatch(const HookPathWatch& other) = delete;
+
+		HookPathWatch& operator=(const HookPathWatch& other) = delete;
+	};
+}
+
+void* operator new(const std::size_t size)
+{
+	void* const p = allocate(size);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+void* operator new[](const std::size_t size) { return operator new(size); }
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// Stand in for the C library's, so the tests see every std::mutex and std::condition_variable that could wait
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+	if (isWatching) lockCount++;
+
+	using Lock = int (*)(pthread_mutex_t*);
+	static Lock next = nullptr;
+	if (next == nullptr) next = (Lock)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+	return next(mutex);
+}
+
+extern "C" int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex) noexcept
+{
+	if (isWatching) lockCount++;
+
+	using Wait = int (*)(pthread_cond_t*, pthread_mutex_t*);
+	static Wait next = nullptr;
+	if (next == nullptr) next = (Wait)dlvsym(RTLD_NEXT, "pthread_cond_wait", "GLIBC_2.3.2");
+	return next(condition, mutex);
+}
+
+namespace
+{
+	char mainWindow; // only compared against nullptr, messages go to the stand-in PostMessage
+
+	class InputPathTest : public testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			HotkeyManager::setHotkeysMap({
+				{ VK_F1, KEY_TIMER1 },
+				{ HOTKEY_CTRL | VK_F2, KEY_TIMER2 },
+				{ VK_F3, KEY_START },
+				{ VK_F3, KEY_UNDO },
+				{ CONTROLLER_A, KEY_START },
+			}, 30);
+			hwndMainWindow = reinterpret_cast<HWND>(&mainWindow);
+			drain();
+		}
+
+		void TearDown() override
+		{
+			drain();
+			hwndMainWindow = nullptr;
+			LatencyMonitor::setEnabled(false);
+		}
+
+		// Empty the queue like the main window does, returning the hotkey actions and controller buttons in the order they were queued
+		static std::vector<int> drain()
+		{
+			std::vector<int> codes;
+
+			InputQueue::beginDrain();
+			InputEvent event;
+			bool isHotkey;
+			while (InputQueue::pop(event, isHotkey)) {
+				codes.push_back(event.code);
+			}
+
+			return codes;
+		}
+
+		// Presses and releases, auto-repeats, chords, unbound keys and bounces
+		static void typeKeys()
+		{
+			DWORD time = 1000;
+			for (int i = 0; i < 20; i++)
+			{
+				HotkeyManager::keyDown(VK_F1, time);
+				HotkeyManager::keyDown(VK_F1, time + 500);
+				HotkeyManager::keyUp(VK_F1);
+
+				HotkeyManager::keyDown(VK_LCONTROL, time + 510);
+				HotkeyManager::keyDown(VK_F2, time + 520);
+				HotkeyManager::keyUp(VK_F2);
+				HotkeyManager::keyUp(VK_LCONTROL);
+
+				HotkeyManager::keyDown(VK_F3, time + 530);
+				HotkeyManager::keyUp(VK_F3);
+				HotkeyManager::keyDown(VK_F3, time + 535);
+				HotkeyManager::keyUp(VK_F3);
+
+				HotkeyManager::keyDown(VK_SPACE, time + 540);
+				HotkeyManager::keyUp(VK_SPACE);
+				HotkeyManager::keyDown(0x1FF, time + 540);
+
+				// What the input backend does with a controller press
+				for (const int button : { CONTROLLER_A, CONTROLLER_B, CONTROLLER_A })
+				{
+					if (HotkeyManager::controllerDown(button, time + 550)) {
+						InputQueue::pushController((WORD)button, time + 550);
+					}
+				}
+
+				time += 1000;
+			}
+		}
+	};
+}
+
+TEST_F(InputPathTest, WatchSeesAllocationsAndLocks)
+{
+	std::mutex mutex;
+	const HookPathWatch watch;
+
+	{
+		const std::lock_guard<std::mutex> lock(mutex);
+		const std::unique_ptr<int> pValue(new int(1));
+	}
+
+	EXPECT_EQ(watch.allocations(), 1);
+	EXPECT_EQ(watch.locks(), 1);
+}
+
+TEST_F(InputPathTest, HookPathNeverAllocatesOrLocks)
+{
+	for (const bool isMonitored : { false, true })
+	{
+		LatencyMonitor::setEnabled(isMonitored);
+
+		int allocations;
+		int locks;
+		{
+			const HookPathWatch watch;
+			typeKeys();
+			allocations = watch.allocations();
+			locks = watch.locks();
+		}
+
+		EXPECT_EQ(allocations, 0) << "monitored: " << isMonitored;
+		EXPECT_EQ(locks, 0) << "monitored: " << isMonitored;
+
+		// The inputs did go all the way to the queue: four actions and two buttons a round
+		EXPECT_EQ(drain().size(), 20u * 6u) << "monitored: " << isMonitored;
+	}
+}
+
+TEST_F(InputPathTest, FullQueueDropsWithoutWaiting)
+{
+	int allocations;
+	int locks;
+	{
+		const HookPathWatch watch;
+		for (DWORD time = 0; time < 1000 * 1000; time += 1000)
+		{
+			HotkeyManager::keyDown(VK_F1, time);
+			HotkeyManager::keyUp(VK_F1);
+		}
+		allocations = watch.allocations();
+		locks = watch.locks();
+	}
+
+	EXPECT_EQ(allocations, 0);
+	EXPECT_EQ(locks, 0);
+	EXPECT_LT(drain().size(), 1000u);
+}
+
+TEST_F(InputPathTest, QueuingPostsOneWakeUpPerDrain)
+{
+	const int postedBefore = postedMessageCount();
+
+	HotkeyManager::keyDown(VK_F1, 1000);
+	HotkeyManager::keyUp(VK_F1);
+	HotkeyManager::keyDown(VK_F1, 2000);
+	HotkeyManager::keyUp(VK_F1);
+	EXPECT_EQ(postedMessageCount() - postedBefore, 1);
+
+	EXPECT_EQ(drain(), std::vector<int>({ KEY_TIMER1, KEY_TIMER1 }));
+
+	HotkeyManager::keyDown(VK_F1, 3000);
+	HotkeyManager::keyUp(VK_F1);
+	EXPECT_EQ(postedMessageCount() - postedBefore, 2);
+}
@@ -0,0 +1,239 @@
+// The input recorder's file format: what a recording reads back as, and the cut off or corrupt files it must refuse
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "InputCodes.h"
+#include "InputRecorder.h"
+
+namespace
+{
+	constexpr size_t recordSize = 8;
+	constexpr size_t endRecordSize = recordSize + 16;
+
+	const char settings[] = "{\"timer1Key\" : 65}";
+
+	std::string readFile(const std::string& fileName)
+	{
+		const std::ifstream file(fileName, std::ios::binary);
+		std::ostringstream contents;
+		contents << file.rdbuf();
+		return contents.str();
+	}
+
+	bool read(const std::string& contents, Recording& recording)
+	{
+		return InputRecorder::read(contents.data(), contents.data() + contents.size(), recording);
+	}
+
+	void expectEvents(const std::vector<KeyEvent>& expected, const std::vector<KeyEvent>& actual)
+	{
+		ASSERT_EQ(expected.size(), actual.size());
+		for (size_t i = 0; i < expected.size(); i++)
+		{
+			EXPECT_EQ(expected[i].code, actual[i].code) << i;
+			EXPECT_EQ(expected[i].isDown, actual[i].isDown) << i;
+			EXPECT_EQ(expected[i].time, actual[i].time) << i;
+		}
+	}
+
+	class InputRecorderTest : public testing::Test
+	{
+	protected:
+		// Every test records into it's own file, ctest runs them as separate processes side by side
+		std::string fileName_;
+		RecordingEnd end_ = {};
+
+		void SetUp() override
+		{
+			fileName_ = std::string("input_recorder_") + testing::UnitTest::GetInstance()->current_test_info()->name() + ".bin";
+
+			end_.time = 5000;
+			end_.timer1Time = 123456;
+			end_.timer2Time = -1;
+			end_.timer1State = 2;
+			end_.timer2State = 0;
+			end_.activeTimer = 2;
+			end_.droppedCount = 99; // filled in by the recorder
+		}
+
+		void TearDown() override
+		{
+			std::remove(fileName_.c_str());
+		}
+
+		/**
+		@brief Record events into the test's file and read it back.
+
+		@return The file's contents.
+		*/
+		std::string record(const std::vector<KeyEvent>& events)
+		{
+			EXPECT_TRUE(InputRecorder::start(fileName_, settings));
+			for (const KeyEvent& event : events) {
+				InputRecorder::record(event);
+			}
+			InputRecorder::stop(end_);
+
+			return readFile(fileName_);
+		}
+	};
+}
+
+TEST_F(InputRecorderTest, RecordingReadsBack)
+{
+	const std::vector<KeyEvent> events = {
+		{ 'A', true, 100 },
+		{ 'A', false, 180 },
+		{ CONTROLLER_START, true, 200 },
+		{ CONTROLLER_START, false, 260 },
+		{ CONTROLLER_RIGHT_SHOULDER, true, 300 }
+	};
+
+	const std::string contents = record(events);
+	EXPECT_FALSE(InputRecorder::isRecording());
+	EXPECT_TRUE(InputRecorder::isRecordingFile(contents.data(), contents.data() + contents.size()));
+
+	Recording recording;
+	ASSERT_TRUE(read(contents, recording));
+	EXPECT_EQ(settings, recording.settings);
+	expectEvents(events, recording.events);
+
+	ASSERT_TRUE(recording.hasEnd);
+	EXPECT_EQ(end_.time, recording.end.time);
+	EXPECT_EQ(end_.timer1Time, recording.end.timer1Time);
+	EXPECT_EQ(end_.timer2Time, recording.end.timer2Time);
+	EXPECT_EQ(end_.timer1State, recording.end.timer1State);
+	EXPECT_EQ(end_.timer2State, recording.end.timer2State);
+	EXPECT_EQ(end_.activeTimer, recording.end.activeTimer);
+	EXPECT_EQ(0u, recording.end.droppedCount);
+}
+
+// Keys and controller buttons go through different rings, the file has them back in the order of their time stamps.
+// Recorded right after starting, well before the writer's first flush, so both rings hold every event when they're merged.
+TEST_F(InputRecorderTest, RingsAreMergedByTime)
+{
+	const std::vector<KeyEvent> keys = {
+		{ 'A', true, 10 },
+		{ 'A', false, 30 },
+		{ 'B', true, 50 },
+		{ 'B', false, 70 }
+	};
+	const std::vector<KeyEvent> buttons = {
+		{ CONTROLLER_UP, true, 20 },
+		{ CONTROLLER_UP, false, 40 },
+		{ CONTROLLER_DOWN, true, 50 }, // a tie goes to the key
+		{ CONTROLLER_DOWN, false, 80 }
+	};
+
+	std::vector<KeyEvent> events = keys;
+	events.insert(events.end(), buttons.begin(), buttons.end());
+
+	Recording recording;
+	ASSERT_TRUE(read(record(events), recording));
+	expectEvents({ keys[0], buttons[0], keys[1], buttons[1], keys[2], buttons[2], keys[3], buttons[3] }, recording.events);
+}
+
+TEST_F(InputRecorderTest, RecordingOnlyWhileStarted)
+{
+	InputRecorder::record({ 'A', true, 1 });
+	InputRecorder::stop(end_); // nothing to stop
+
+	const std::string contents = record({ { 'B', true, 2 } });
+	InputRecorder::record({ 'C', true, 3 });
+
+	Recording recording;
+	ASSERT_TRUE(read(contents, recording));
+	expectEvents({ { 'B', true, 2 } }, recording.events);
+}
+
+// The app didn't get to stop the recording, every whole event is still there
+TEST_F(InputRecorderTest, CutOffAfterAnEventReadsWithoutAnEnd)
+{
+	const std::string contents = record({ { 'A', true, 10 }, { 'A', false, 20 } });
+
+	Recording recording;
+	ASSERT_TRUE(read(contents.substr(0, contents.size() - endRecordSize), recording));
+	EXPECT_FALSE(recording.hasEnd);
+	expectEvents({ { 'A', true, 10 }, { 'A', false, 20 } }, recording.events);
+
+	ASSERT_TRUE(read(contents.substr(0, contents.size() - endRecordSize - 2 * recordSize), recording));
+	EXPECT_EQ(settings, recording.settings);
+	EXPECT_TRUE(recording.events.empty());
+}
+
+TEST_F(InputRecorderTest, CutOffFilesAreRefused)
+{
+	const std::string contents = record({ { 'A', true, 10 }, { 'A', false, 20 } });
+	const size_t headerSize = contents.size() - endRecordSize - 2 * recordSize;
+
+	// Inside the last event, right after the end record's kind, before the end record's payload and inside it
+	for (const size_t cut : { endRecordSize + 3, endRecordSize - 1, endRecordSize - recordSize, (size_t)1 })
+	{
+		Recording recording;
+		EXPECT_FALSE(read(contents.substr(0, contents.size() - cut), recording)) << cut;
+		EXPECT_TRUE(recording.events.empty()) << cut;
+		EXPECT_FALSE(recording.hasEnd) << cut;
+	}
+
+	// Inside the settings and inside the header
+	Recording recording;
+	EXPECT_FALSE(read(contents.substr(0, headerSize - 1), recording));
+	EXPECT_FALSE(read(contents.substr(0, 12), recording));
+}
+
+TEST_F(InputRecorderTest, BadEndRecordsAreRefused)
+{
+	const std::string contents = record({ { 'A', true, 10 } });
+	const size_t endOffset = contents.size() - endRecordSize;
+
+	Recording recording;
+
+	// Not a kind of record
+	std::string badKind = contents;
+	badKind[endOffset + 7] = 7;
+	EXPECT_FALSE(read(badKind, recording));
+
+	// Anything after the end record
+	EXPECT_FALSE(read(contents + std::string(recordSize, '\0'), recording));
+
+	// An end record in the middle of the events
+	std::string endFirst = contents.substr(0, endOffset - recordSize) + contents.substr(endOffset) + contents.substr(endOffset - recordSize, recordSize);
+	EXPECT_FALSE(read(endFirst, recording));
+
+	// An event without a key
+	std::string noCode = contents;
+	noCode[endOffset - recordSize + 4] = 0;
+	EXPECT_FALSE(read(noCode, recording));
+
+	EXPECT_TRUE(read(contents, recording));
+	EXPECT_TRUE(recording.hasEnd);
+}
+
+TEST_F(InputRecorderTest, OtherFilesAreRefused)
+{
+	const std::string contents = record({});
+
+	Recording recording;
+	ASSERT_TRUE(read(contents, recording));
+	EXPECT_TRUE(recording.events.empty());
+	EXPECT_TRUE(recording.hasEnd);
+
+	const std::string text = "# time code down\n100 65 1\n";
+	EXPECT_FALSE(InputRecorder::isRecordingFile(text.data(), text.data() + text.size()));
+	EXPECT_FALSE(read(text, recording));
+
+	// A version this build doesn't know
+	std::string newerVersion = contents;
+	newerVersion[8] = (char)(InputRecorder::version + 1);
+	EXPECT_FALSE(read(newerVersion, recording));
+
+	// Settings longer than the file
+	std::string longSettings = contents;
+	longSettings[12 + 3] = 0x7F;
+	EXPECT_FALSE(read(longSettings, recording));
+}
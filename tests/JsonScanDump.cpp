@@ -0,0 +1,205 @@
+// Prints how the json readers handle a fixed set of generated and mutated documents.
+// Built with and without JSONCPP_NO_SIMD; the json_scan_differential test checks that both print the same,
+// so the vectorized scanning accepts, rejects and positions everything like the scalar loops.
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "json/json.h"
+
+namespace
+{
+	const int DOCUMENT_COUNT = 3000;
+
+	// Small linear congruential generator, the same numbers on every platform
+	class Random
+	{
+	private:
+		uint32_t state_;
+
+	public:
+		explicit Random(const uint32_t seed) : state_(seed) {}
+
+		uint32_t next(const uint32_t bound)
+		{
+			state_ = state_ * 1664525u + 1013904223u;
+			return (state_ >> 8) % bound;
+		}
+	};
+
+	// Runs that are longer than one or two vectors, so the scans cross chunk boundaries at every offset
+	void appendWhitespace(std::string& text, Random& random)
+	{
+		const char spaces[] = { ' ', '\t', '\r', '\n' };
+		const uint32_t length = random.next(4) == 0 ? random.next(80) : random.next(3);
+		for (uint32_t i = 0; i < length; i++) {
+			text += spaces[random.next(4)];
+		}
+	}
+
+	void appendString(std::string& text, Random& random)
+	{
+		const char* const escapes[] = { "\\\"", "\\\\", "\\n", "\\/", "\\u00e9", "\\ud83d\\ude00" };
+		const uint32_t length = random.next(90);
+
+		text += '"';
+		for (uint32_t i = 0; i < length; i++)
+		{
+			const uint32_t kind = random.next(40);
+			if (kind == 0) {
+				text += escapes[random.next(6)];
+			}
+			else if (kind == 1) {
+				text += (char)(0x80 + random.next(0x80));
+			}
+			else {
+				text += (char)('a' + random.next(26));
+			}
+		}
+		text += '"';
+	}
+
+	void appendNumber(std::string& text, Random& random)
+	{
+		if (random.next(3) == 0) text += '-';
+		const uint32_t digits = 1 + (random.next(4) == 0 ? random.next(40) : random.next(6));
+		for (uint32_t i = 0; i < digits; i++) {
+			text += (char)('0' + random.next(10));
+		}
+		if (random.next(2) == 0)
+		{
+			text += '.';
+			const uint32_t fraction = 1 + random.next(34);
+			for (uint32_t i = 0; i < fraction; i++) {
+				text += (char)('0' + random.next(10));
+			}
+		}
+		if (random.next(4) == 0) {
+			text += "e" + std::to_string((int)random.next(40) - 20);
+		}
+	}
+
+	void appendValue(std::string& text, Random& random, const int depth)
+	{
+		appendWhitespace(text, random);
+		const uint32_t kind = depth < 4 ? random.next(7) : random.next(4);
+		switch (kind)
+		{
+		case 0: appendString(text, random); break;
+		case 1: appendNumber(text, random); break;
+		case 2: text += random.next(2) == 0 ? "true" : "null"; break;
+		case 3: text += "/* comment */ false"; break;
+		case 4:
+		case 5:
+		{
+			const uint32_t count = random.next(8);
+			text += '[';
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (i != 0) text += ',';
+				appendValue(text, random, depth + 1);
+			}
+			appendWhitespace(text, random);
+			text += ']';
+			break;
+		}
+		default:
+		{
+			const uint32_t count = random.next(8);
+			text += '{';
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (i != 0) text += ',';
+				appendWhitespace(text, random);
+				appendString(text, random);
+				appendWhitespace(text, random);
+				text += ':';
+				appendValue(text, random, depth + 1);
+			}
+			appendWhitespace(text, random);
+			text += '}';
+			break;
+		}
+		}
+		appendWhitespace(text, random);
+	}
+
+	// Most documents get a few bytes overwritten with ones the scans look for, or get cut short
+	void mutate(std::string& text, Random& random)
+	{
+		const char interesting[] = { '"', '\\', ' ', '\n', '0', '9', '.', 'e', '/', '{', ']', ',', '\x80', '\xff', '\0' };
+
+		const uint32_t changes = random.next(4);
+		for (uint32_t i = 0; i < changes && !text.empty(); i++) {
+			text[random.next((uint32_t)text.size())] = interesting[random.next(sizeof(interesting))];
+		}
+		if (random.next(5) == 0 && !text.empty()) {
+			text.resize(random.next((uint32_t)text.size()));
+		}
+	}
+
+	// Records every token of the event reader
+	class TraceHandler : public Json::ParseEventHandler
+	{
+	public:
+		std::string trace;
+
+		bool onNull() override { trace += "n "; return true; }
+		bool onBool(bool value) override { trace += value ? "t " : "f "; return true; }
+		bool onInt(Json::LargestInt value) override { trace += "i" + std::to_string(value) + ' '; return true; }
+		bool onUInt(Json::LargestUInt value) override { trace += "u" + std::to_string(value) + ' '; return true; }
+		bool onDouble(double value) override { trace += "d" + Json::valueToString(value) + ' '; return true; }
+		bool onString(const char* begin, const char* end) override { trace += "s" + std::string(begin, end) + ' '; return true; }
+		bool onObjectBegin() override { trace += "{ "; return true; }
+		bool onKey(const char* begin, const char* end) override { trace += "k" + std::string(begin, end) + ' '; return true; }
+		bool onObjectEnd() override { trace += "} "; return true; }
+		bool onArrayBegin() override { trace += "[ "; return true; }
+		bool onArrayEnd() override { trace += "] "; return true; }
+	};
+
+	void dumpParse(const std::string& text, const Json::CharReaderBuilder& builder, std::ostream& out)
+	{
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		Json::Value root;
+		Json::String errors;
+		const bool isValid = pReader->parse(text.data(), text.data() + text.size(), &root, &errors);
+
+		out << (isValid ? "valid " : "invalid ") << root.getOffsetStart() << '-' << root.getOffsetLimit() << '\n' << errors;
+		if (isValid)
+		{
+			Json::StreamWriterBuilder writerBuilder;
+			writerBuilder["indentation"] = "";
+			out << Json::writeString(writerBuilder, root) << '\n';
+		}
+	}
+}
+
+int main()
+{
+	Json::CharReaderBuilder defaultBuilder;
+	Json::CharReaderBuilder strictBuilder;
+	Json::CharReaderBuilder::strictMode(&strictBuilder.settings_);
+
+	Random random(0x51D);
+	for (int i = 0; i < DOCUMENT_COUNT; i++)
+	{
+		std::string text;
+		appendValue(text, random, 0);
+		if (random.next(4) != 0) {
+			mutate(text, random);
+		}
+
+		std::cout << "document " << i << '\n';
+		dumpParse(text, defaultBuilder, std::cout);
+		dumpParse(text, strictBuilder, std::cout);
+
+		TraceHandler handler;
+		Json::String errors;
+		const bool isValid = Json::parseEvents(text.data(), text.data() + text.size(), handler, &errors);
+		std::cout << (isValid ? "events valid\n" : "events invalid\n") << errors << handler.trace << '\n';
+	}
+
+	return 0;
+}
@@ -0,0 +1,266 @@
+// Json::Value behavior that has to be the same with every storage option, built once per option
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "json/json.h"
+
+namespace
+{
+	Json::Value parse(const std::string& text)
+	{
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		Json::Value root;
+		Json::String errors;
+		EXPECT_TRUE(pReader->parse(text.data(), text.data() + text.size(), &root, &errors)) << errors;
+		return root;
+	}
+
+	// Wether a string lies inside the text, which only the strings a document borrows do
+	bool isInside(const char* pString, const std::string& text)
+	{
+		return pString >= text.data() && pString < text.data() + text.size();
+	}
+
+	class JsonDocumentTest : public testing::Test
+	{
+	protected:
+#if JSONCPP_USING_ARENA_MEMORY
+		// Declared before the documents of the tests, so it outlives their values
+		Json::ValueArena arena_;
+#endif
+
+		// Parse the text in place, it has to outlive the document
+		bool parseInPlace(Json::Document& document, std::string& text, Json::String* pErrors = nullptr)
+		{
+#if JSONCPP_USING_ARENA_MEMORY
+			const Json::ValueArena::Scope scope(arena_);
+#endif
+			return document.parse(&text[0], &text[0] + text.size(), nullptr, pErrors);
+		}
+	};
+}
+
+// Inserting used to shift the elements up through a reference that growing the array left dangling
+TEST(JsonValueTest, InsertAtFrontAfterAppends)
+{
+	Json::Value array(Json::arrayValue);
+	for (int i = 1; i <= 4; i++) {
+		array.append(i);
+	}
+
+	ASSERT_TRUE(array.insert(0, Json::Value(0)));
+
+	ASSERT_EQ(5u, array.size());
+	for (Json::ArrayIndex i = 0; i < array.size(); i++) {
+		EXPECT_EQ((int)i, array[i].asInt());
+	}
+}
+
+TEST(JsonValueTest, InsertEverywhereWhileGrowing)
+{
+	Json::Value array(Json::arrayValue);
+	std::string expected;
+
+	// Every growth of the storage happens at a different position
+	for (int i = 0; i < 64; i++)
+	{
+		const Json::ArrayIndex index = (Json::ArrayIndex)(i * 7 % (i + 1));
+		ASSERT_TRUE(array.insert(index, Json::Value(std::string(1, (char)('A' + i % 26)))));
+		expected.insert(index, 1, (char)('A' + i % 26));
+	}
+
+	std::string actual;
+	for (const Json::Value& value : array) {
+		actual += value.asString();
+	}
+	EXPECT_EQ(expected, actual);
+}
+
+TEST(JsonValueTest, InsertPastTheEndFails)
+{
+	Json::Value array(Json::arrayValue);
+	array.append(1);
+
+	EXPECT_FALSE(array.insert(2, Json::Value(2)));
+	EXPECT_EQ(1u, array.size());
+}
+
+TEST(JsonValueTest, InsertCopyOfOwnElement)
+{
+	Json::Value array(Json::arrayValue);
+	for (int i = 0; i < 4; i++) {
+		array.append(std::string(32, (char)('a' + i)));
+	}
+
+	// The const reference overload copies the element before the array grows
+	ASSERT_TRUE(array.insert(0, array[3]));
+
+	EXPECT_EQ(std::string(32, 'd'), array[0].asString());
+	EXPECT_EQ(std::string(32, 'd'), array[4].asString());
+}
+
+// The readers attach a comment to the value before it, which adding the next sibling may move
+TEST(JsonValueTest, CommentsAfterSiblingsAreKept)
+{
+	const Json::Value root = parse(
+		"{\"b\" : 1, \"a\" : /* after b */ 2, \"0\" : // after a\n 3,"
+		" \"list\" : [1, // after 1\n 2, /* after 2 */ 3, 4, 5, 6, 7, 8, 9]}");
+
+	EXPECT_EQ("/* after b */", root["b"].getComment(Json::commentAfterOnSameLine));
+	EXPECT_EQ("// after a", root["a"].getComment(Json::commentAfterOnSameLine));
+	EXPECT_EQ("// after 1", root["list"][0].getComment(Json::commentAfterOnSameLine));
+	EXPECT_EQ("/* after 2 */", root["list"][1].getComment(Json::commentAfterOnSameLine));
+	EXPECT_EQ(9u, root["list"].size());
+}
+
+// A comment that opens a nested value used to be attached through a pointer to the sibling before
+// it, after adding the nested value had moved that sibling
+TEST(JsonValueTest, CommentsInsideNestedValuesAreKept)
+{
+	const Json::Value root = parse(
+		"{\"a\" : 1, \"b\" : {/* in b */ \"c\" : 2}, \"list\" : [1, [/* in list */ 2], 3, 4, 5]}");
+
+	EXPECT_EQ(2, root["b"]["c"].asInt());
+	EXPECT_EQ(5u, root["list"].size());
+	EXPECT_EQ(2, root["list"][1][0].asInt());
+
+	const std::string written = root.toStyledString();
+	EXPECT_NE(std::string::npos, written.find("/* in b */"));
+	EXPECT_NE(std::string::npos, written.find("/* in list */"));
+}
+
+TEST(JsonValueTest, MembersStayInKeyOrder)
+{
+	Json::Value object;
+	object["c"] = 3;
+	object["a"] = 1;
+	object["b"] = 2;
+
+	const Json::Value::Members names = object.getMemberNames();
+	ASSERT_EQ(3u, names.size());
+	EXPECT_EQ("a", names[0]);
+	EXPECT_EQ("b", names[1]);
+	EXPECT_EQ("c", names[2]);
+
+	Json::Value removed;
+	EXPECT_TRUE(object.removeMember("b", &removed));
+	EXPECT_EQ(2, removed.asInt());
+	EXPECT_FALSE(object.isMember("b"));
+	EXPECT_EQ(3, object["c"].asInt());
+}
+
+// A document has to build the same tree as the reader, whichever strings it borrows
+TEST_F(JsonDocumentTest, SameTreeAsCharReader)
+{
+	const std::string source =
+		"{\"name\" : \"timer\", \"empty\" : \"\", \"escaped\" : \"tab\\there \\\"quoted\\\" \\u00e9\",\n"
+		" \"key \\n with escape\" : [1, -2, 3.5, true, false, null, \"a\", \"\\/\"],\n"
+		" \"nested\" : {\"b\" : {\"c\" : [\"deep\", {}]}, \"a\" : []}, \"name2\" : 18446744073709551615}";
+
+	std::string text = source;
+	Json::Document document;
+	Json::String errors;
+	ASSERT_TRUE(parseInPlace(document, text, &errors)) << errors;
+
+	const Json::Value expected = parse(source);
+	EXPECT_EQ(expected, document.root());
+	EXPECT_EQ(expected.toStyledString(), document.root().toStyledString());
+}
+
+TEST_F(JsonDocumentTest, SameErrorsAsCharReader)
+{
+	const std::string source = "{\"a\" : [1, 2,, 3]}";
+
+	Json::CharReaderBuilder builder;
+	const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+	Json::Value root;
+	Json::String expected;
+	ASSERT_FALSE(pReader->parse(source.data(), source.data() + source.size(), &root, &expected));
+
+	std::string text = source;
+	Json::Document document;
+	Json::String errors;
+	EXPECT_FALSE(parseInPlace(document, text, &errors));
+	EXPECT_EQ(expected, errors);
+}
+
+// Plain keys and values point into the text, terminated over their closing quote
+TEST_F(JsonDocumentTest, PlainStringsAreBorrowed)
+{
+	std::string text = "{\"name\" : \"timer\", \"list\" : [\"a\", \"bc\"]}";
+	Json::Document document;
+	ASSERT_TRUE(parseInPlace(document, text));
+
+	const Json::Value& root = document.root();
+	EXPECT_TRUE(isInside(root["name"].asCString(), text));
+	EXPECT_STREQ("timer", root["name"].asCString());
+	EXPECT_TRUE(isInside(root["list"][1].asCString(), text));
+	EXPECT_STREQ("bc", root["list"][1].asCString());
+
+	for (Json::Value::const_iterator it = root.begin(); it != root.end(); ++it)
+	{
+		const char* pEnd = nullptr;
+		EXPECT_TRUE(isInside(it.memberName(&pEnd), text)) << it.name();
+	}
+
+	EXPECT_EQ(std::string("{\"name\0 : \"timer\0", 17), text.substr(0, 17));
+}
+
+// Escapes have to be decoded, and a nul character would end a borrowed string early
+TEST_F(JsonDocumentTest, EscapedAndNulStringsAreCopied)
+{
+	const char json[] = "{\"tab\\tkey\" : \"a\\nb\", \"nul\" : \"c\0d\", \"u\" : \"\\u00e9\"}";
+	const std::string source(json, sizeof(json) - 1);
+	std::string text = source;
+	Json::Document document;
+	Json::String errors;
+	ASSERT_TRUE(parseInPlace(document, text, &errors)) << errors;
+
+	const Json::Value& root = document.root();
+	EXPECT_EQ(parse(source), root);
+
+	EXPECT_FALSE(isInside(root["tab\tkey"].asCString(), text));
+	EXPECT_EQ("a\nb", root["tab\tkey"].asString());
+
+	const char* pBegin = nullptr;
+	const char* pEnd = nullptr;
+	ASSERT_TRUE(root["nul"].getString(&pBegin, &pEnd));
+	EXPECT_FALSE(isInside(pBegin, text));
+	EXPECT_EQ(std::string("c\0d", 3), std::string(pBegin, pEnd));
+
+	EXPECT_FALSE(isInside(root["u"].asCString(), text));
+	EXPECT_EQ("\xc3\xa9", root["u"].asString());
+
+	for (Json::Value::const_iterator it = root.begin(); it != root.end(); ++it)
+	{
+		const char* pKeyEnd = nullptr;
+		const char* pKey = it.memberName(&pKeyEnd);
+		EXPECT_EQ(it.name() != "tab\tkey", isInside(pKey, text)) << it.name();
+	}
+}
+
+// The text overload keeps it's own copy, the source can go away
+TEST_F(JsonDocumentTest, OwnedTextOutlivesTheSource)
+{
+	Json::Document document;
+	{
+		std::string source = "{\"name\" : \"timer\", \"list\" : [\"a\"]}";
+#if JSONCPP_USING_ARENA_MEMORY
+		const Json::ValueArena::Scope scope(arena_);
+#endif
+		ASSERT_TRUE(document.parse(Json::String(source.data(), source.size()), nullptr));
+		source.assign(source.size(), 'x');
+	}
+
+	EXPECT_EQ("timer", document.root()["name"].asString());
+	EXPECT_EQ("a", document.root()["list"][0].asString());
+
+	// Parsing again replaces the tree and the text it points into
+	std::string text = "[\"second\"]";
+	ASSERT_TRUE(parseInPlace(document, text));
+	EXPECT_EQ(parse("[\"second\"]"), document.root());
+}
@@ -0,0 +1,140 @@
+// The latency histograms' buckets and percentiles, and what the monitor exports
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "LatencyMonitor.h"
+
+namespace
+{
+	// QueryPerformanceCounter ticks of a number of microseconds
+	LONGLONG ticksOf(const uint64_t microseconds)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		return (LONGLONG)(microseconds * (uint64_t)frequency.QuadPart / 1000000);
+	}
+
+	std::string readFile(const std::string& fileName)
+	{
+		const std::ifstream file(fileName, std::ios::binary);
+		std::ostringstream contents;
+		contents << file.rdbuf();
+		return contents.str();
+	}
+
+	class LatencyMonitorTest : public testing::Test
+	{
+	protected:
+		void TearDown() override
+		{
+			LatencyMonitor::setEnabled(false);
+		}
+	};
+}
+
+TEST(LatencyHistogramTest, DurationsGoInTheirBucket)
+{
+	const uint64_t durations[] = { 0, 1, 2, 3, 5, 1023, 1024, 1000000, 1ull << 30, UINT64_MAX / 1000000 };
+	for (const uint64_t microseconds : durations)
+	{
+		LatencyHistogram histogram;
+		histogram.record(microseconds);
+
+		int filledCount = 0;
+		for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; i++)
+		{
+			if (histogram.bucket(i) == 0) continue;
+
+			filledCount++;
+			EXPECT_GE(microseconds, LatencyHistogram::bucketLowerBound(i)) << microseconds;
+			if (i != LatencyHistogram::BUCKET_COUNT - 1) {
+				EXPECT_LT(microseconds, LatencyHistogram::bucketUpperBound(i)) << microseconds;
+			}
+		}
+		EXPECT_EQ(filledCount, 1) << microseconds;
+	}
+}
+
+TEST(LatencyHistogramTest, BucketsCoverEveryDuration)
+{
+	EXPECT_EQ(LatencyHistogram::bucketLowerBound(0), 0u);
+	for (int i = 1; i < LatencyHistogram::BUCKET_COUNT; i++) {
+		EXPECT_EQ(LatencyHistogram::bucketLowerBound(i), LatencyHistogram::bucketUpperBound(i - 1));
+	}
+	EXPECT_EQ(LatencyHistogram::bucketUpperBound(LatencyHistogram::BUCKET_COUNT - 1), UINT64_MAX);
+}
+
+TEST(LatencyHistogramTest, PercentilesAreBucketUpperBounds)
+{
+	LatencyHistogram histogram;
+	EXPECT_EQ(histogram.percentile(0.99), 0u);
+
+	for (int i = 0; i < 90; i++) {
+		histogram.record(5);
+	}
+	for (int i = 0; i < 10; i++) {
+		histogram.record(1000);
+	}
+
+	EXPECT_EQ(histogram.count(), 100u);
+	EXPECT_EQ(histogram.totalMicroseconds(), 90u * 5u + 10u * 1000u);
+	EXPECT_EQ(histogram.maxMicroseconds(), 1000u);
+	EXPECT_EQ(histogram.percentile(0.5), 8u);
+	EXPECT_EQ(histogram.percentile(0.9), 8u);
+	EXPECT_EQ(histogram.percentile(0.99), 1024u);
+
+	// Past the last bucket's lower end only the maximum is known
+	histogram.record(1ull << 40);
+	EXPECT_EQ(histogram.percentile(1.0), 1ull << 40);
+
+	histogram.reset();
+	EXPECT_EQ(histogram.count(), 0u);
+	EXPECT_EQ(histogram.maxMicroseconds(), 0u);
+	EXPECT_EQ(histogram.percentile(0.5), 0u);
+}
+
+TEST_F(LatencyMonitorTest, DisabledMonitorRecordsNothing)
+{
+	LatencyMonitor::setEnabled(false);
+	{
+		const LatencyScope latencyScope(LATENCY_KEYBOARD_HOOK);
+	}
+	LatencyMonitor::record(LATENCY_MOUSE_HOOK, LatencyMonitor::now() - ticksOf(100));
+
+	ASSERT_TRUE(LatencyMonitor::exportCsv("latency_disabled.csv"));
+	EXPECT_EQ(readFile("latency_disabled.csv"), "probe,lower_us,upper_us,count\n");
+}
+
+TEST_F(LatencyMonitorTest, CsvHasARowPerNonEmptyBucket)
+{
+	LatencyMonitor::setEnabled(true);
+	LatencyMonitor::record(LATENCY_HOTKEY_LOOKUP, LatencyMonitor::now() - ticksOf(3000));
+	LatencyMonitor::record(LATENCY_HOTKEY_LOOKUP, LatencyMonitor::now() - ticksOf(3000));
+	LatencyMonitor::record(LATENCY_END_TO_END, LatencyMonitor::now() - ticksOf(150));
+	LatencyMonitor::record(LATENCY_END_TO_END, LatencyMonitor::now() - ticksOf(4000ull * 1000000));
+
+	ASSERT_TRUE(LatencyMonitor::exportCsv("latency.csv"));
+	EXPECT_EQ(readFile("latency.csv"),
+		"probe,lower_us,upper_us,count\n"
+		"hotkey_lookup,2048,4096,2\n"
+		"end_to_end,128,256,1\n"
+		"end_to_end,1073741824,,1\n");
+
+	EXPECT_NE(LatencyMonitor::summary().find(L"Hotkey lookup: 2 events"), std::wstring::npos);
+	EXPECT_NE(LatencyMonitor::summary().find(L"Keyboard hook: no events"), std::wstring::npos);
+}
+
+TEST_F(LatencyMonitorTest, EnablingStartsOver)
+{
+	LatencyMonitor::setEnabled(true);
+	LatencyMonitor::record(LATENCY_MOUSE_HOOK, LatencyMonitor::now() - ticksOf(10));
+	LatencyMonitor::setEnabled(false);
+	LatencyMonitor::setEnabled(true);
+
+	ASSERT_TRUE(LatencyMonitor::exportCsv("latency_restarted.csv"));
+	EXPECT_EQ(readFile("latency_restarted.csv"), "probe,lower_us,upper_us,count\n");
+}
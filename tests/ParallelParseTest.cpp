@@ -0,0 +1,124 @@
+// Json::parseArrayParallel has to give the same results, offsets and errors as one reader
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include <atomic>
+#include <cerrno>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "json/json.h"
+
+namespace
+{
+	std::atomic<bool> failThreadStarts(false);
+	std::atomic<int> failedThreadStarts(0);
+}
+
+// Stands in for the C library's, so the tests can run out of threads
+extern "C" int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*start)(void*), void* arg) noexcept
+{
+	if (failThreadStarts.load()) {
+		failedThreadStarts++;
+		return EAGAIN;
+	}
+
+	using Create = int (*)(pthread_t*, const pthread_attr_t*, void* (*)(void*), void*);
+	static const Create next = (Create)dlsym(RTLD_NEXT, "pthread_create");
+	return next(thread, attr, start, arg);
+}
+
+namespace
+{
+	// A history array well above the size the parallel parse splits at
+	std::string makeHistory(const int count)
+	{
+		std::string text = "[";
+		for (int i = 0; i < count; i++)
+		{
+			if (i != 0) text += ",\n";
+			text += "{\"id\": " + std::to_string(i) + ", \"name\": \"Player " + std::to_string(i * 7919 % 1000)
+				+ "\", \"time\": " + std::to_string(i * 1.25) + ", \"tags\": [\"killer\", null, true]}";
+		}
+		return text + "]";
+	}
+
+	struct ParseResult
+	{
+		bool isValid;
+		Json::Value root;
+		Json::String errors;
+	};
+
+	ParseResult parseOnce(const std::string& text)
+	{
+		Json::CharReaderBuilder builder;
+		const std::unique_ptr<Json::CharReader> pReader(builder.newCharReader());
+
+		ParseResult result;
+		result.isValid = pReader->parse(text.data(), text.data() + text.size(), &result.root, &result.errors);
+		return result;
+	}
+
+	ParseResult parseParallel(const std::string& text, const unsigned int threadCount)
+	{
+		Json::CharReaderBuilder builder;
+
+		ParseResult result;
+		result.isValid = Json::parseArrayParallel(builder, text.data(), text.data() + text.size(), threadCount, &result.root, &result.errors);
+		return result;
+	}
+
+	void expectSameResult(const ParseResult& expected, const ParseResult& actual)
+	{
+		EXPECT_EQ(expected.isValid, actual.isValid);
+		EXPECT_EQ(expected.errors, actual.errors);
+		EXPECT_TRUE(expected.root == actual.root);
+		EXPECT_EQ(expected.root.getOffsetStart(), actual.root.getOffsetStart());
+		EXPECT_EQ(expected.root.getOffsetLimit(), actual.root.getOffsetLimit());
+	}
+}
+
+TEST(ParallelParseTest, ParsesLikeOneReader)
+{
+	const std::string text = makeHistory(5000);
+	const ParseResult expected = parseOnce(text);
+	ASSERT_TRUE(expected.isValid);
+
+	for (const unsigned int threadCount : { 1u, 2u, 3u, 8u })
+	{
+		SCOPED_TRACE(threadCount);
+		const ParseResult actual = parseParallel(text, threadCount);
+		expectSameResult(expected, actual);
+
+		// The elements' offsets point into the whole document too
+		EXPECT_EQ(expected.root[4321]["name"].getOffsetStart(), actual.root[4321]["name"].getOffsetStart());
+	}
+}
+
+TEST(ParallelParseTest, ErrorsLikeOneReader)
+{
+	std::string text = makeHistory(5000);
+	text.replace(text.find("\"id\": 3000"), 10, "\"id\": 3000x");
+
+	const ParseResult expected = parseOnce(text);
+	ASSERT_FALSE(expected.isValid);
+
+	expectSameResult(expected, parseParallel(text, 4));
+}
+
+TEST(ParallelParseTest, ParsesOnOneThreadWhenThreadsCannotStart)
+{
+	const std::string text = makeHistory(5000);
+	const ParseResult expected = parseOnce(text);
+
+	failedThreadStarts = 0;
+	failThreadStarts = true;
+	const ParseResult actual = parseParallel(text, 4);
+	failThreadStarts = false;
+
+	EXPECT_GT(failedThreadStarts.load(), 0);
+	expectSameResult(expected, actual);
+}
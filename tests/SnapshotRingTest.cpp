@@ -0,0 +1,210 @@
+// The undo history of the timers: the order snapshots come back in, what a full ring forgets, and that it never allocates
+#include <cstdlib>
+#include <new>
+
+#include <gtest/gtest.h>
+
+#include "SnapshotRing.h"
+
+namespace
+{
+	// Allocations made on this thread while an AllocationWatch was open on it
+	thread_local bool isWatching = false;
+	thread_local int allocationCount = 0;
+
+	void* allocate(const std::size_t size)
+	{
+		if (isWatching) allocationCount++;
+		return std::malloc(size != 0 ? size : 1);
+	}
+
+	// Counts what the code run in it's scope allocates, on this thread only
+	class AllocationWatch
+	{
+	public:
+		AllocationWatch()
+		{
+			allocationCount = 0;
+			isWatching = true;
+		}
+
+		~AllocationWatch()
+		{
+			isWatching = false;
+		}
+
+		int allocations() const { return allocationCount; }
+
+		// Prevent copying, the counter is per thread
+
+		AllocationWatch(const AllocationWatch& other) = delete;
+
+		AllocationWatch& operator=(const AllocationWatch& other) = delete;
+	};
+
+	// The size of the timers' snapshots
+	struct Snapshot
+	{
+		int timer1[4];
+		int timer2[4];
+		int activeTimer;
+	};
+}
+
+void* operator new(const std::size_t size)
+{
+	void* const p = allocate(size);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+void* operator new[](const std::size_t size) { return operator new(size); }
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+TEST(SnapshotRingTest, EmptyRingHasNothingToUndoOrRedo)
+{
+	SnapshotRing<int, 4> ring;
+	int state = 7;
+
+	EXPECT_FALSE(ring.undo(state));
+	EXPECT_FALSE(ring.redo(state));
+	EXPECT_EQ(7, state);
+}
+
+TEST(SnapshotRingTest, UndoAndRedoInOrder)
+{
+	SnapshotRing<int, 8> ring;
+
+	// Every change pushes the state from before it
+	int state = 0;
+	for (int i = 1; i <= 3; i++)
+	{
+		ring.push(state);
+		state = i;
+	}
+
+	for (int expected = 2; expected >= 0; expected--)
+	{
+		ASSERT_TRUE(ring.undo(state));
+		EXPECT_EQ(expected, state);
+	}
+	EXPECT_FALSE(ring.undo(state));
+	EXPECT_EQ(0, state);
+
+	for (int expected = 1; expected <= 3; expected++)
+	{
+		ASSERT_TRUE(ring.redo(state));
+		EXPECT_EQ(expected, state);
+	}
+	EXPECT_FALSE(ring.redo(state));
+	EXPECT_EQ(3, state);
+
+	// Going back and forth over the same snapshot
+	ASSERT_TRUE(ring.undo(state));
+	ASSERT_TRUE(ring.redo(state));
+	ASSERT_TRUE(ring.undo(state));
+	EXPECT_EQ(2, state);
+}
+
+// Once the ring is full a push forgets the oldest snapshot, only the last N can be undone
+TEST(SnapshotRingTest, WrappingOverwritesTheOldest)
+{
+	SnapshotRing<int, 4> ring;
+
+	int state = 0;
+	for (int i = 1; i <= 10; i++)
+	{
+		ring.push(state);
+		state = i;
+	}
+
+	for (int expected = 9; expected >= 6; expected--)
+	{
+		ASSERT_TRUE(ring.undo(state));
+		EXPECT_EQ(expected, state);
+	}
+	EXPECT_FALSE(ring.undo(state));
+
+	// All of it can be redone again
+	for (int expected = 7; expected <= 10; expected++)
+	{
+		ASSERT_TRUE(ring.redo(state));
+		EXPECT_EQ(expected, state);
+	}
+	EXPECT_FALSE(ring.redo(state));
+}
+
+TEST(SnapshotRingTest, SingleSnapshot)
+{
+	SnapshotRing<int, 1> ring;
+
+	int state = 1;
+	ring.push(state);
+	state = 2;
+	ring.push(state);
+	state = 3;
+
+	ASSERT_TRUE(ring.undo(state));
+	EXPECT_EQ(2, state);
+	EXPECT_FALSE(ring.undo(state));
+
+	ASSERT_TRUE(ring.redo(state));
+	EXPECT_EQ(3, state);
+}
+
+// A change after an undo starts a new branch, what was undone can't be redone anymore
+TEST(SnapshotRingTest, PushClearsRedo)
+{
+	SnapshotRing<int, 4> ring;
+
+	int state = 0;
+	for (int i = 1; i <= 3; i++)
+	{
+		ring.push(state);
+		state = i;
+	}
+
+	ASSERT_TRUE(ring.undo(state));
+	ASSERT_TRUE(ring.undo(state));
+	EXPECT_EQ(1, state);
+
+	ring.push(state);
+	state = 10;
+	EXPECT_FALSE(ring.redo(state));
+	EXPECT_EQ(10, state);
+
+	// The undo history before the branch is still there
+	ASSERT_TRUE(ring.undo(state));
+	EXPECT_EQ(1, state);
+	ASSERT_TRUE(ring.undo(state));
+	EXPECT_EQ(0, state);
+	EXPECT_FALSE(ring.undo(state));
+}
+
+// Undo and redo run on the main window's thread for every key press, the history is kept in place
+TEST(SnapshotRingTest, NeverAllocates)
+{
+	Snapshot state = {};
+	int allocations;
+	{
+		const AllocationWatch watch;
+		SnapshotRing<Snapshot, 32> ring;
+
+		for (int i = 0; i < 100; i++)
+		{
+			ring.push(state);
+			state.activeTimer = i;
+		}
+		while (ring.undo(state)) {}
+		while (ring.redo(state)) {}
+
+		allocations = watch.allocations();
+	}
+
+	EXPECT_EQ(0, allocations);
+	EXPECT_EQ(99, state.activeTimer);
+}
@@ -0,0 +1,27 @@
+# The app's sources that don't need a window, built against the stand-ins in this directory.
+# Included by the tests and the benchmarks, after a jsoncpp library target exists.
+#
+#   add_app_core(<name> <jsoncpp library>)
+set(APP_CORE_DIR ${CMAKE_CURRENT_LIST_DIR})
+get_filename_component(APP_SOURCE_DIR ${APP_CORE_DIR}/../.. ABSOLUTE)
+
+function(add_app_core name jsoncpp)
+	add_library(${name} STATIC
+		${APP_SOURCE_DIR}/ActionRegistry.cpp
+		${APP_SOURCE_DIR}/AppClock.cpp
+		${APP_SOURCE_DIR}/EvdevInputBackend.cpp
+		${APP_SOURCE_DIR}/HotkeyManager.cpp
+		${APP_SOURCE_DIR}/InputRecorder.cpp
+		${APP_SOURCE_DIR}/InputQueue.cpp
+		${APP_SOURCE_DIR}/LatencyMonitor.cpp
+		${APP_SOURCE_DIR}/MappedFile.cpp
+		${APP_SOURCE_DIR}/ReplayInputBackend.cpp
+		${APP_SOURCE_DIR}/SettingsCache.cpp
+		${APP_SOURCE_DIR}/SettingsPersistence.cpp
+		${APP_SOURCE_DIR}/SettingsSink.cpp
+		${APP_SOURCE_DIR}/SettingsUtils.cpp
+		${APP_CORE_DIR}/AppGlobals.cpp)
+	# The stand-ins come first, the sources include Windows.h and Globals.h by those names
+	target_include_directories(${name} PUBLIC ${APP_CORE_DIR} ${APP_SOURCE_DIR})
+	target_link_libraries(${name} PUBLIC ${jsoncpp})
+endfunction()
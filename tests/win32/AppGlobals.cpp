@@ -0,0 +1,4 @@
+// The globals Program.cpp defines for the rest of the app. Without a window, the input path queues nothing.
+#include "Globals.h"
+
+HWND hwndMainWindow = nullptr;
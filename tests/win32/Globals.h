@@ -0,0 +1,3 @@
+#pragma once
+// The sources include the globals as Globals.h, which only finds globals.h on case insensitive file systems
+#include "../../globals.h"
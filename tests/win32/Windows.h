@@ -0,0 +1,104 @@
+#pragma once
+// The little of the Win32 API the app's portable sources use, so the tests and benchmarks can build them on other systems.
+// Window functions do nothing but count the messages posted, the performance counter runs on std::chrono::steady_clock.
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+typedef unsigned char byte;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned short USHORT;
+typedef unsigned short UINT16;
+typedef unsigned int UINT;
+typedef uint32_t DWORD;
+typedef int BOOL;
+typedef int32_t LONG;
+typedef int64_t LONGLONG;
+typedef uintptr_t WPARAM;
+typedef intptr_t LPARAM;
+typedef intptr_t LRESULT;
+typedef DWORD COLORREF;
+
+struct HWND__;
+typedef HWND__* HWND;
+struct HINSTANCE__;
+typedef HINSTANCE__* HINSTANCE;
+struct HBRUSH__;
+typedef HBRUSH__* HBRUSH;
+
+union LARGE_INTEGER
+{
+	struct
+	{
+		DWORD LowPart;
+		LONG HighPart;
+	};
+	LONGLONG QuadPart;
+};
+
+#define TRUE 1
+#define FALSE 0
+
+constexpr UINT WM_APP = 0x8000;
+constexpr DWORD LWA_COLORKEY = 0x1;
+constexpr DWORD LWA_ALPHA = 0x2;
+constexpr int GWL_EXSTYLE = -20;
+constexpr LONG WS_EX_TRANSPARENT = 0x20;
+
+// The virtual keys the hotkeys use by name
+constexpr int VK_LBUTTON = 0x01;
+constexpr int VK_RBUTTON = 0x02;
+constexpr int VK_SHIFT = 0x10;
+constexpr int VK_CONTROL = 0x11;
+constexpr int VK_MENU = 0x12;
+constexpr int VK_SPACE = 0x20;
+constexpr int VK_LWIN = 0x5B;
+constexpr int VK_RWIN = 0x5C;
+constexpr int VK_F1 = 0x70;
+constexpr int VK_F2 = 0x71;
+constexpr int VK_F3 = 0x72;
+constexpr int VK_F4 = 0x73;
+constexpr int VK_LSHIFT = 0xA0;
+constexpr int VK_RSHIFT = 0xA1;
+constexpr int VK_LCONTROL = 0xA2;
+constexpr int VK_RCONTROL = 0xA3;
+constexpr int VK_LMENU = 0xA4;
+constexpr int VK_RMENU = 0xA5;
+
+/**
+@return The number of messages posted or sent since the process started, to any window.
+*/
+inline std::atomic<int>& postedMessageCount()
+{
+	static std::atomic<int> count(0);
+	return count;
+}
+
+inline BOOL PostMessage(HWND, UINT, WPARAM, LPARAM)
+{
+	postedMessageCount()++;
+	return TRUE;
+}
+
+inline LRESULT SendMessage(HWND, UINT, WPARAM, LPARAM)
+{
+	postedMessageCount()++;
+	return 0;
+}
+
+inline BOOL SetLayeredWindowAttributes(HWND, COLORREF, BYTE, DWORD) { return TRUE; }
+inline LONG GetWindowLong(HWND, int) { return 0; }
+inline LONG SetWindowLong(HWND, int, LONG) { return 0; }
+
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* pFrequency)
+{
+	pFrequency->QuadPart = 1000000000;
+	return TRUE;
+}
+
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* pCounter)
+{
+	pCounter->QuadPart = (LONGLONG)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	return TRUE;
+}